@@ -100,22 +100,25 @@ std::string bible_import (Webserver_Request& webserver_request)
   if (webserver_request.post_count("upload")) {
     bool success {false};
     std::string filename{};
-    std::string data{};
-    const auto upload = [&success, &bible, &book, &chapter, &filename, &data]() {
+    std::optional<size_t> data{};
+    const auto upload = [&webserver_request, &success, &bible, &book, &chapter, &filename, &data]() {
       const std::string datafile = filter_url_tempfile() + filename;
-      filter_url_file_put_contents (datafile, data);
-      tasks_logic_queue (tasks::enums::task::import_bible, { datafile, bible, std::to_string (book), std::to_string (chapter) });
-      success = true;
+      if (webserver_request.post_save (data.value(), datafile)) {
+        tasks_logic_queue (tasks::enums::task::import_bible, { datafile, bible, std::to_string (book), std::to_string (chapter) });
+        success = true;
+      }
     };
-    for (const auto& [key, value] : webserver_request.post) {
+    // Walk the POSTed data by index, so that each file name pairs up with its data.
+    for (size_t i {0}; i < webserver_request.post.size(); i++) {
+      const auto& [key, value] = webserver_request.post.at(i);
       if (key == "data")
-        data = value;
+        data = i;
       if (key == "filename")
         filename = value;
-      if (!filename.empty() and !data.empty()) {
+      if (!filename.empty() and data) {
         upload();
         filename.clear();
-        data.clear();
+        data.reset();
       }
     }
     if (success) {
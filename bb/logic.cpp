@@ -283,10 +283,12 @@ void bible_logic::log_change(const std::string& bible,
 
     body.push_back("Changes:");
 
+    const filter::usfm::ChapterVerses existing_verses(existing_usfm);
+    const filter::usfm::ChapterVerses new_verses(usfm);
     for (const auto verse : verses)
     {
-        const std::string existing_verse_usfm = filter::usfm::get_verse_text(existing_usfm, verse);
-        const std::string verse_usfm = filter::usfm::get_verse_text(usfm, verse);
+        const std::string existing_verse_usfm = existing_verses.get_verse_text(verse);
+        const std::string verse_usfm = new_verses.get_verse_text(verse);
         if (existing_verse_usfm != verse_usfm)
         {
             Filter_Text filter_text_old = Filter_Text(bible);
@@ -449,10 +451,12 @@ void bible_logic::merge_irregularity_mail(const std::vector<std::string>& users,
         // Go through all verses available in the USFM,
         // and make a record for each verse,
         // where the USFM differs between the change that the user made and the result that was saved.
+        const filter::usfm::ChapterVerses change_verses(conflict.change);
+        const filter::usfm::ChapterVerses result_verses(conflict.result);
         for (const auto verse : filter::usfm::get_verse_numbers(conflict.result))
         {
-            const std::string change = filter::usfm::get_verse_text(conflict.change, verse);
-            const std::string result = filter::usfm::get_verse_text(conflict.result, verse);
+            const std::string change = change_verses.get_verse_text(verse);
+            const std::string result = result_verses.get_verse_text(verse);
             // When there's no change in the verse, skip it.
             if (change == result) continue;
             // Record the difference.
@@ -588,14 +592,17 @@ void bible_logic::client_receive_merge_mail(const std::string& bible, int book,
     // and make a record for each verse,
     // where the USFM differs between client and server.
     const std::vector<int> verses = filter::usfm::get_verse_numbers(client_old);
+    const filter::usfm::ChapterVerses client_old_verses(client_old);
+    const filter::usfm::ChapterVerses client_new_verses(client_new);
+    const filter::usfm::ChapterVerses server_verses(server);
     for (const auto verse : verses)
     {
-        const std::string client_old_verse = filter::usfm::get_verse_text(client_old, verse);
-        const std::string client_new_verse = filter::usfm::get_verse_text(client_new, verse);
+        const std::string client_old_verse = client_old_verses.get_verse_text(verse);
+        const std::string client_new_verse = client_new_verses.get_verse_text(verse);
         // When there's no change in the verse as sent by the client, skip further checks.
         if (client_old_verse == client_new_verse) continue;
         // Check whether the client's change made it to the server.
-        const std::string server_verse = filter::usfm::get_verse_text(server, verse);
+        const std::string server_verse = server_verses.get_verse_text(verse);
         if (client_new_verse == server_verse) continue;
         // Record the difference.
         client_diff.push_back(client_new_verse);
@@ -739,10 +746,12 @@ void bible_logic::client_no_write_access_mail(const std::string& bible, int book
     // and make a record for each verse,
     // where the USFM differs between client and server.
     const std::vector<int> verses = filter::usfm::get_verse_numbers(oldusfm);
+    const filter::usfm::ChapterVerses client_old_verses(oldusfm);
+    const filter::usfm::ChapterVerses client_new_verses(newusfm);
     for (const auto verse : verses)
     {
-        const std::string client_old_verse = filter::usfm::get_verse_text(oldusfm, verse);
-        const std::string client_new_verse = filter::usfm::get_verse_text(newusfm, verse);
+        const std::string client_old_verse = client_old_verses.get_verse_text(verse);
+        const std::string client_new_verse = client_new_verses.get_verse_text(verse);
         // When there's no change in the verse as sent by the client, skip further checks.
         if (client_old_verse == client_new_verse) continue;
         // Record the difference.
@@ -811,10 +820,12 @@ void bible_logic::recent_save_email(const std::string& bible,
     // and make a record for each verse,
     // where the USFM differs between the old and the new USFM.
     const std::vector<int> verses = filter::usfm::get_verse_numbers(new_usfm);
+    const filter::usfm::ChapterVerses old_chapter_verses(old_usfm);
+    const filter::usfm::ChapterVerses new_chapter_verses(new_usfm);
     for (const auto verse : verses)
     {
-        const std::string old_verse = filter::usfm::get_verse_text(old_usfm, verse);
-        const std::string new_verse = filter::usfm::get_verse_text(new_usfm, verse);
+        const std::string old_verse = old_chapter_verses.get_verse_text(verse);
+        const std::string new_verse = new_chapter_verses.get_verse_text(verse);
         // When there's no change in the verse, skip further checks.
         if (old_verse == new_verse) continue;
         // Record the difference.
@@ -936,11 +947,14 @@ void bible_logic::optional_merge_irregularity_email(const std::string& bible, in
     // Go through all verses available in the USFM,
     // and check the differences for each verse.
     const std::vector<int> verses = filter::usfm::get_verse_numbers(merged_usfm);
+    const filter::usfm::ChapterVerses ancestor_verses(ancestor_usfm);
+    const filter::usfm::ChapterVerses edited_verses(edited_usfm);
+    const filter::usfm::ChapterVerses merged_verses(merged_usfm);
     for (const auto verse : verses)
     {
-        const std::string ancestor_verse_usfm = filter::usfm::get_verse_text(ancestor_usfm, verse);
-        const std::string edited_verse_usfm = filter::usfm::get_verse_text(edited_usfm, verse);
-        const std::string merged_verse_usfm = filter::usfm::get_verse_text(merged_usfm, verse);
+        const std::string ancestor_verse_usfm = ancestor_verses.get_verse_text(verse);
+        const std::string edited_verse_usfm = edited_verses.get_verse_text(verse);
+        const std::string merged_verse_usfm = merged_verses.get_verse_text(verse);
         // There's going to be a check to find out that all the changes the user made,
         // are available among the changes resulting from the merge.
         // If all the changes are there, all is good.
@@ -119,6 +119,7 @@ std::string bible_manage (Webserver_Request& webserver_request)
           const std::string origin_folder = database::bibles::bible_folder (origin);
           const std::string destination_folder = database::bibles::bible_folder (destination);
           filter_url_dir_cp (origin_folder, destination_folder);
+          database::bibles::clear_index ();
           // Copy the Bible search index.
           search_logic_copy_bible (origin, destination);
           // Feedback.
@@ -46,87 +46,268 @@
 #include <database/bibles.h>
 
 
+namespace {
+
+
+// A verse rendered for display and for comparison.
+struct rendered_verse {
+  std::string html {};
+  std::string text {};
+};
+
+
+// The renderings and diffs made during one run of the change notifications.
+// A change made by a user shows up in the user's own changes and in the team changes,
+// and it goes out to several recipients, yet it gets rendered and compared only once.
+// The users are processed in parallel, so access is guarded.
+// When the cache holds more than its capacity, it starts afresh.
+class render_cache final {
+public:
+  rendered_verse render (const std::string& bible, const std::string& usfm);
+  std::string diff (const std::string& old_text, const std::string& new_text);
+private:
+  static constexpr size_t capacity {64 * 1024 * 1024};
+  void make_room (size_t bytes);
+  std::mutex m_mutex {};
+  std::map <std::pair <std::string, std::string>, rendered_verse> m_verses {};
+  std::map <std::pair <std::string, std::string>, std::string> m_diffs {};
+  size_t m_bytes {0};
+};
+
+
+// Makes room for an entry of $bytes, by emptying the cache if it would grow beyond its capacity.
+// The caller should hold the mutex.
+void render_cache::make_room (const size_t bytes)
+{
+  if (m_bytes + bytes > capacity) {
+    m_verses.clear ();
+    m_diffs.clear ();
+    m_bytes = 0;
+  }
+  m_bytes += bytes;
+}
+
+
+rendered_verse render_cache::render (const std::string& bible, const std::string& usfm)
+{
+  {
+    std::lock_guard lock (m_mutex);
+    if (const auto iter = m_verses.find ({bible, usfm}); iter != m_verses.end ())
+      return iter->second;
+  }
+  // Render without holding the lock, so other users get processed meanwhile.
+  const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
+  Filter_Text filter_text = Filter_Text (bible);
+  filter_text.html_text_standard = new HtmlText ("");
+  filter_text.text_text = new Text_Text ();
+  filter_text.add_usfm_code (usfm);
+  filter_text.run (stylesheet);
+  rendered_verse rendered {filter_text.html_text_standard->get_inner_html (), filter_text.text_text->get ()};
+  std::lock_guard lock (m_mutex);
+  make_room (bible.size () + usfm.size () + rendered.html.size () + rendered.text.size ());
+  m_verses.emplace (std::pair (bible, usfm), rendered);
+  return rendered;
+}
+
+
+std::string render_cache::diff (const std::string& old_text, const std::string& new_text)
+{
+  {
+    std::lock_guard lock (m_mutex);
+    if (const auto iter = m_diffs.find ({old_text, new_text}); iter != m_diffs.end ())
+      return iter->second;
+  }
+  std::string modification = filter_diff_diff (old_text, new_text);
+  std::lock_guard lock (m_mutex);
+  make_room (old_text.size () + new_text.size () + modification.size ());
+  m_diffs.emplace (std::pair (old_text, new_text), modification);
+  return modification;
+}
+
+
+// A verse changed by a user.
+struct verse_change {
+  int book {0};
+  int chapter {0};
+  int verse {0};
+  std::string old_html {};
+  std::string modification {};
+  std::string new_html {};
+};
+
+
+// The changes a user made in one Bible.
+struct bible_digest {
+  std::string bible {};
+  std::string email {};
+  std::vector <verse_change> changes {};
+};
+
+
+// The changes a user made, ready to be recorded and mailed.
+struct user_digest {
+  std::vector <bible_digest> bibles {};
+  int change_count {0};
+  float time_total {0.0f};
+  int time_count {0};
+};
+
+
+// Two revisions of a chapter to compare, as read from the database.
+struct chapter_revisions {
+  int book {0};
+  int chapter {0};
+  std::string old_usfm {};
+  std::string new_usfm {};
+  int timestamp {0};
+};
+
+
+// The chapters a user changed in one Bible.
+struct bible_revisions {
+  std::string bible {};
+  std::vector <chapter_revisions> chapters {};
+};
+
+
+}
+
+
 // Helper function.
-// $user: The user whose changes are being processed.
-// $recipients: The users who opted for receiving online notifications of any contributor.
-static void changes_process_identifiers (Webserver_Request& webserver_request,
-                                         const std::string& user,
-                                         const std::vector <std::string>& recipients,
-                                         const std::string& bible,
-                                         int book, int chapter,
-                                         const std::map<std::string, std::vector<std::string>>& bibles_per_user,
-                                         int oldId, int newId,
-                                         std::string& email,
-                                         int& change_count, float& time_total, int& time_count)
+// $user: The user whose changes are being read.
+// It reads the two revisions of the chapter to compare.
+static void changes_read_identifiers (const std::string& user,
+                                      const std::string& bible,
+                                      int book, int chapter,
+                                      int oldId, int newId,
+                                      bible_revisions& revisions)
 {
   if (oldId != 0) {
-    const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
     database::modifications::text_bundle old_chapter_text = database::modifications::getUserChapter (user, bible, book, chapter, oldId);
-    const std::string old_chapter_usfm = old_chapter_text.oldtext;
     database::modifications::text_bundle new_chapter_text = database::modifications::getUserChapter (user, bible, book, chapter, newId);
-    const std::string new_chapter_usfm = new_chapter_text.newtext;
-    const std::vector <int> old_verse_numbers = filter::usfm::get_verse_numbers (old_chapter_usfm);
-    const std::vector <int> new_verse_numbers = filter::usfm::get_verse_numbers (new_chapter_usfm);
-    std::vector <int> verses = old_verse_numbers;
-    verses.insert (verses.end (), new_verse_numbers.begin (), new_verse_numbers.end ());
-    verses = filter::string::array_unique (verses);
-    std::sort (verses.begin(), verses.end());
-    for (const auto verse : verses) {
-      const std::string old_verse_usfm = filter::usfm::get_verse_text (old_chapter_usfm, verse);
-      const std::string new_verse_usfm = filter::usfm::get_verse_text (new_chapter_usfm, verse);
-      if (old_verse_usfm != new_verse_usfm) {
-        Filter_Text filter_text_old = Filter_Text (bible);
-        Filter_Text filter_text_new = Filter_Text (bible);
-        filter_text_old.html_text_standard = new HtmlText (translate("Bible"));
-        filter_text_new.html_text_standard = new HtmlText (translate("Bible"));
-        filter_text_old.text_text = new Text_Text ();
-        filter_text_new.text_text = new Text_Text ();
-        filter_text_old.add_usfm_code (old_verse_usfm);
-        filter_text_new.add_usfm_code (new_verse_usfm);
-        filter_text_old.run (stylesheet);
-        filter_text_new.run (stylesheet);
-        const std::string old_html = filter_text_old.html_text_standard->get_inner_html ();
-        const std::string new_html = filter_text_new.html_text_standard->get_inner_html ();
-        const std::string old_text = filter_text_old.text_text->get ();
-        const std::string new_text = filter_text_new.text_text->get ();
-        if (old_text != new_text) {
-          // Enter new lines in the email body.
-          // This avoids this error: 501 Syntax error - line too long.
-          // See https://www.rfc-editor.org/rfc/rfc5322#section-2.1.1
-          const std::string modification = filter_diff_diff (old_text, new_text);
-          email += "<div>\n";
-          email += filter_passage_display (book, chapter, std::to_string (verse));
-          email += "\n";
-          email += modification;
-          email += "\n</div>\n";
-          if (webserver_request.database_config_user()->get_user_user_changes_notifications_online (user)) {
-            database::modifications::recordNotification ({user}, changes_personal_category (), bible, book, chapter, verse, old_html, modification, new_html);
+    const int timestamp = database::modifications::getUserTimestamp (user, bible, book, chapter, newId);
+    revisions.chapters.push_back ({book, chapter, std::move (old_chapter_text.oldtext), std::move (new_chapter_text.newtext), timestamp});
+  }
+}
+
+
+// Reads the revisions of the chapters changed by the user.
+// This reads the database and writes to the journal, so it runs on one thread.
+static std::vector <bible_revisions> changes_read_user (const std::string& user)
+{
+  std::vector <bible_revisions> user_revisions {};
+  
+  // Go through the Bibles changed by the user.
+  const std::vector <std::string> bibles = database::modifications::getUserBibles (user);
+  for (const auto& bible : bibles) {
+    
+    bible_revisions& revisions = user_revisions.emplace_back ();
+    revisions.bible = bible;
+    
+    // Go through the books in that Bible.
+    const std::vector <int> books = database::modifications::getUserBooks (user, bible);
+    for (auto book : books) {
+      
+      // Go through the chapters in that book.
+      const std::vector <int> chapters = database::modifications::getUserChapters (user, bible, book);
+      for (auto chapter : chapters) {
+        
+        database::logs::log ("Change notifications: User " + user + " - Bible " + bible + " " + filter_passage_display (book, chapter, ""), roles::translator);
+        
+        // Get the sets of identifiers for that chapter, and set some variables.
+        const std::vector <database::modifications::id_bundle> IdSets = database::modifications::getUserIdentifiers (user, bible, book, chapter);
+        int reference_new_id {0};
+        int new_id {0};
+        int last_new_id {0};
+        bool restart = true;
+        
+        // Go through the sets of identifiers.
+        for (const auto & id_set : IdSets) {
+          
+          int oldId {id_set.oldid};
+          new_id = id_set.newid;
+          
+          if (restart) {
+            changes_read_identifiers (user, bible, book, chapter, reference_new_id, new_id, revisions);
+            reference_new_id = new_id;
+            last_new_id = new_id;
+            restart = false;
+            continue;
           }
-          // Go over all the receipients to record the change for them.
-          for (const auto& recipient : recipients) {
-            // The author of this change does not get a notification for it.
-            if (recipient == user) continue;
-            // The recipient may have set which Bibles to get the change notifications for.
-            // This is stored like this:
-            // container [user] = list of bibles.
-            bool receive {true};
-            try {
-              const std::vector <std::string>& bibles = bibles_per_user.at(recipient);
-              receive = filter::string::in_array(bible, bibles);
-            } catch (...) {}
-            if (!receive) continue;
-            // Store the notification.
-            database::modifications::recordNotification ({recipient}, user, bible, book, chapter, verse, old_html, modification, new_html);
+          
+          if (oldId == last_new_id) {
+            last_new_id = new_id;
+          } else {
+            restart = true;
           }
         }
-        // Statistics: Count another change made by this user.
-        change_count++;
-        const int timestamp = database::modifications::getUserTimestamp (user, bible, book, chapter, newId);
-        time_total += static_cast<float>(timestamp);
-        time_count++;
+        
+        // Process the last set of identifiers.
+        changes_read_identifiers (user, bible, book, chapter, reference_new_id, new_id, revisions);
       }
     }
   }
+  
+  return user_revisions;
+}
+
+
+// Renders the changes between two revisions of a chapter.
+static void changes_process_revisions (render_cache& cache,
+                                       const std::string& bible,
+                                       const chapter_revisions& revisions,
+                                       bible_digest& digest, user_digest& totals)
+{
+  const int book {revisions.book};
+  const int chapter {revisions.chapter};
+  const std::vector <int> old_verse_numbers = filter::usfm::get_verse_numbers (revisions.old_usfm);
+  const std::vector <int> new_verse_numbers = filter::usfm::get_verse_numbers (revisions.new_usfm);
+  std::vector <int> verses = old_verse_numbers;
+  verses.insert (verses.end (), new_verse_numbers.begin (), new_verse_numbers.end ());
+  verses = filter::string::array_unique (verses);
+  std::sort (verses.begin(), verses.end());
+  const filter::usfm::ChapterVerses old_chapter_verses (revisions.old_usfm);
+  const filter::usfm::ChapterVerses new_chapter_verses (revisions.new_usfm);
+  for (const auto verse : verses) {
+    const std::string old_verse_usfm = old_chapter_verses.get_verse_text (verse);
+    const std::string new_verse_usfm = new_chapter_verses.get_verse_text (verse);
+    if (old_verse_usfm != new_verse_usfm) {
+      const rendered_verse old_verse = cache.render (bible, old_verse_usfm);
+      const rendered_verse new_verse = cache.render (bible, new_verse_usfm);
+      if (old_verse.text != new_verse.text) {
+        // Enter new lines in the email body.
+        // This avoids this error: 501 Syntax error - line too long.
+        // See https://www.rfc-editor.org/rfc/rfc5322#section-2.1.1
+        const std::string modification = cache.diff (old_verse.text, new_verse.text);
+        digest.email += "<div>\n";
+        digest.email += filter_passage_display (book, chapter, std::to_string (verse));
+        digest.email += "\n";
+        digest.email += modification;
+        digest.email += "\n</div>\n";
+        digest.changes.push_back ({book, chapter, verse, old_verse.html, modification, new_verse.html});
+      }
+      // Statistics: Count another change made by this user.
+      totals.change_count++;
+      totals.time_total += static_cast<float>(revisions.timestamp);
+      totals.time_count++;
+    }
+  }
+}
+
+
+// Renders the changes made by the user.
+// This does not depend on who receives them, and it does not access the databases,
+// so it runs for all users in parallel.
+static user_digest changes_digest_user (render_cache& cache, const std::vector <bible_revisions>& user_revisions)
+{
+  user_digest digest {};
+  for (const auto& revisions : user_revisions) {
+    bible_digest& bible_changes = digest.bibles.emplace_back ();
+    bible_changes.bible = revisions.bible;
+    for (const auto& chapter : revisions.chapters)
+      changes_process_revisions (cache, revisions.bible, chapter, bible_changes, digest);
+  }
+  return digest;
 }
 
 
@@ -199,67 +380,66 @@ void changes_modifications ()
   // At the same time, produce change statistics per user.
 
   std::vector <std::string> users = database::modifications::getUserUsernames ();
-  for (const auto& user : users) {
 
-    // Total changes made by this user.
-    int change_count {0};
-    
-    // Go through the Bibles changed by the current user.
-    std::vector <std::string> bibles = database::modifications::getUserBibles (user);
-    for (const auto& bible : bibles) {
-      
-      // Body of the email to be sent.
-      std::string email = "<p>" + translate("You have entered the changes below in a Bible editor.") + " " + translate ("You may check if it made its way into the Bible text.") + "</p>";
-      size_t empty_email_length = email.length ();
+  // Read the changes of the users from the database, then render them in parallel.
+  // The renderings and diffs are shared with the team changes further down.
+  render_cache cache {};
+  std::vector <std::vector <bible_revisions>> user_revisions {};
+  for (const auto& user : users)
+    user_revisions.push_back (changes_read_user (user));
+  std::vector <user_digest> user_digests (users.size ());
+  {
+    std::atomic <size_t> next_user {0};
+    const auto digest_users = [&] () {
+      for (size_t u = next_user++; u < users.size (); u = next_user++) {
+        user_digests [u] = changes_digest_user (cache, user_revisions [u]);
+      }
+    };
+    const size_t thread_count = std::min (static_cast<size_t>(std::max (std::thread::hardware_concurrency (), 1u)), users.size ());
+    std::vector <std::thread> threads {};
+    for (size_t t = 0; t < thread_count; t++) {
+      threads.emplace_back (digest_users);
+    }
+    std::ranges::for_each (threads, [](std::thread& thread) { thread.join (); });
+  }
+
+  // Record the notifications and send the emails one user after the other,
+  // so the notifications keep their order.
+  for (size_t u = 0; u < users.size (); u++) {
+    const std::string& user = users [u];
+    const user_digest& digest = user_digests [u];
+
+    const bool online = webserver_request.database_config_user()->get_user_user_changes_notifications_online (user);
+    for (const auto& bible_changes : digest.bibles) {
+      const std::string& bible = bible_changes.bible;
       
-      // Go through the books in that Bible.
-      const std::vector <int> books = database::modifications::getUserBooks (user, bible);
-      for (auto book : books) {
-        
-        // Go through the chapters in that book.
-        const std::vector <int> chapters = database::modifications::getUserChapters (user, bible, book);
-        for (auto chapter : chapters) {
-
-          database::logs::log ("Change notifications: User " + user + " - Bible " + bible + " " + filter_passage_display (book, chapter, ""), roles::translator);
-
-          // Get the sets of identifiers for that chapter, and set some variables.
-          const std::vector <database::modifications::id_bundle> IdSets = database::modifications::getUserIdentifiers (user, bible, book, chapter);
-          int reference_new_id {0};
-          int new_id {0};
-          int last_new_id {0};
-          bool restart = true;
-          
-          // Go through the sets of identifiers.
-          for (const auto & id_set : IdSets) {
-            
-            int oldId {id_set.oldid};
-            new_id = id_set.newid;
-            
-            if (restart) {
-              changes_process_identifiers (webserver_request, user, recipients_named_contributors, bible, book, chapter, notification_bibles_per_user, reference_new_id, new_id, email, change_count, modification_time_total, modification_time_count);
-              reference_new_id = new_id;
-              last_new_id = new_id;
-              restart = false;
-              continue;
-            }
-            
-            if (oldId == last_new_id) {
-              last_new_id = new_id;
-            } else {
-              restart = true;
-            }
-          }
-          
-          // Process the last set of identifiers.
-          changes_process_identifiers (webserver_request, user, recipients_named_contributors, bible, book, chapter, notification_bibles_per_user, reference_new_id, new_id, email, change_count, modification_time_total, modification_time_count);
-          
+      for (const auto& change : bible_changes.changes) {
+        if (online) {
+          database::modifications::recordNotification ({user}, changes_personal_category (), bible, change.book, change.chapter, change.verse, change.old_html, change.modification, change.new_html);
+        }
+        // Go over all the receipients to record the change for them.
+        for (const auto& recipient : recipients_named_contributors) {
+          // The author of this change does not get a notification for it.
+          if (recipient == user) continue;
+          // The recipient may have set which Bibles to get the change notifications for.
+          // This is stored like this:
+          // container [user] = list of bibles.
+          bool receive {true};
+          try {
+            const std::vector <std::string>& bibles = notification_bibles_per_user.at(recipient);
+            receive = filter::string::in_array(bible, bibles);
+          } catch (...) {}
+          if (!receive) continue;
+          // Store the notification.
+          database::modifications::recordNotification ({recipient}, user, bible, change.book, change.chapter, change.verse, change.old_html, change.modification, change.new_html);
         }
       }
 
       // Check whether there's any email to be sent.
-      if (email.length () != empty_email_length) {
+      if (!bible_changes.email.empty ()) {
         // Send the user email with the user's personal changes if the user opted to receive it.
         if (webserver_request.database_config_user()->get_user_user_changes_notification (user)) {
+          const std::string email = "<p>" + translate("You have entered the changes below in a Bible editor.") + " " + translate ("You may check if it made its way into the Bible text.") + "</p>" + bible_changes.email;
           const std::string subject = translate("Changes you entered in") + " " + bible;
           if (!client_logic_client_enabled ()) email::schedule (user, subject, email);
         }
@@ -267,7 +447,9 @@ void changes_modifications ()
     }
     
     // Store change statistics for this user.
-    user_change_statistics [user] = change_count;
+    user_change_statistics [user] = digest.change_count;
+    modification_time_total += digest.time_total;
+    modification_time_count += digest.time_count;
 
     // Clear the user's changes in the database.
     database::modifications::clearUserUser (user);
@@ -285,9 +467,6 @@ void changes_modifications ()
   for (const auto & bible : bibles) {
     
     
-    const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
-    
-    
     std::vector <std::string> changeNotificationUsers;
     std::vector <std::string> all_users = webserver_request.database_users ()->get_users ();
     for (const auto& user : all_users) {
@@ -359,9 +538,11 @@ void changes_modifications ()
         verses.insert (verses.end (), new_verse_numbers.begin (), new_verse_numbers.end ());
         verses = filter::string::array_unique (verses);
         std::sort (verses.begin (), verses.end());
+        const filter::usfm::ChapterVerses old_chapter_verses (old_chapter_usfm);
+        const filter::usfm::ChapterVerses new_chapter_verses (new_chapter_usfm);
         for (auto verse : verses) {
-          const std::string old_verse_usfm = filter::usfm::get_verse_text (old_chapter_usfm, verse);
-          const std::string new_verse_usfm = filter::usfm::get_verse_text (new_chapter_usfm, verse);
+          const std::string old_verse_usfm = old_chapter_verses.get_verse_text (verse);
+          const std::string new_verse_usfm = new_chapter_verses.get_verse_text (verse);
           if (old_verse_usfm != new_verse_usfm) {
             processedChangesCount++;
             // In case of too many change notifications, processing them would take too much time, so take a few shortcuts.
@@ -370,22 +551,14 @@ void changes_modifications ()
             std::string old_text = old_verse_usfm;
             std::string new_text = new_verse_usfm;
             if (processedChangesCount < 800) {
-              Filter_Text filter_text_old = Filter_Text (bible);
-              Filter_Text filter_text_new = Filter_Text (bible);
-              filter_text_old.html_text_standard = new HtmlText ("");
-              filter_text_new.html_text_standard = new HtmlText ("");
-              filter_text_old.text_text = new Text_Text ();
-              filter_text_new.text_text = new Text_Text ();
-              filter_text_old.add_usfm_code (old_verse_usfm);
-              filter_text_new.add_usfm_code (new_verse_usfm);
-              filter_text_old.run (stylesheet);
-              filter_text_new.run (stylesheet);
-              old_html = filter_text_old.html_text_standard->get_inner_html ();
-              new_html = filter_text_new.html_text_standard->get_inner_html ();
-              old_text = filter_text_old.text_text->get ();
-              new_text = filter_text_new.text_text->get ();
+              const rendered_verse old_verse = cache.render (bible, old_verse_usfm);
+              const rendered_verse new_verse = cache.render (bible, new_verse_usfm);
+              old_html = old_verse.html;
+              new_html = new_verse.html;
+              old_text = old_verse.text;
+              new_text = new_verse.text;
             }
-            const std::string modification = filter_diff_diff (old_text, new_text);
+            const std::string modification = cache.diff (old_text, new_text);
             database::modifications::recordNotification (changeNotificationUsers, changes_bible_category (), bible, book, chapter, verse, old_html, modification, new_html);
             const std::string passage = filter_passage_display (book, chapter, std::to_string (verse))   + ": ";
             if (old_text != new_text) {
@@ -153,8 +153,9 @@ void checks_run (std::string bible)
       if (check_chapters_verses_versification) checks_versification::verses (bible, book, chapter, verses);
       
       
+      const filter::usfm::ChapterVerses chapter_verses (chapterUsfm);
       for (auto verse : verses) {
-        const std::string verseUsfm = filter::usfm::get_verse_text (chapterUsfm, verse);
+        const std::string verseUsfm = chapter_verses.get_verse_text (verse);
         if (check_double_spaces_usfm) {
           checks::space::double_space_usfm (bible, book, chapter, verse, verseUsfm);
         }
@@ -33,7 +33,7 @@
 Checks_Usfm::Checks_Usfm (const std::string& bible)
 {
   m_stylesheet = database::config::bible::get_export_stylesheet (bible);
-  markers_stylesheet = database::styles::get_markers (m_stylesheet);
+  m_styles = database::styles::get_snapshot (m_stylesheet);
   for (const stylesv2::Style& style : stylesv2::styles) {
     // Find out which markers require an endmarker.
     // And which markers are embeddable.
@@ -241,7 +241,7 @@ void Checks_Usfm::marker_in_stylesheet ()
     if (!marker.empty ()) marker = marker.substr (1);
   }
   if (marker.empty()) return;
-  if (filter::string::in_array (marker, markers_stylesheet)) return;
+  if (m_styles->find (marker)) return;
   add_result (checks::issues::text(checks::issues::issue::marker_not_in_stylesheet), Checks_Usfm::display_current);
 }
 
@@ -286,7 +286,7 @@ void Checks_Usfm::forward_slash (const std::string& usfm)
       bit = bit.substr (0, pos2);
     }
     const std::string marker = bit.substr (1, 100);
-    if (find (markers_stylesheet.begin(), markers_stylesheet.end(), marker) != markers_stylesheet.end ()) {
+    if (m_styles->find (marker)) {
       add_result (checks::issues::text(checks::issues::issue::forward_slash_instead_of_backslash) + ": " + bit, display_nothing);
     }
   }
@@ -556,7 +556,7 @@ void Checks_Usfm::note ()
   const std::string current_marker = filter::usfm::get_marker (usfm_item);
   
   // Get this style's properties.
-  const stylesv2::Style* stylev2 = database::styles::get_marker_data(m_stylesheet, current_marker);
+  const stylesv2::Style* stylev2 = m_styles->find(current_marker);
   
   // Set a flag if this USFM starts a footnote or an endnote or a crossreference.
   // Clear this flag if it ends the note or xref.
@@ -48,7 +48,7 @@ private:
   
   // Stylesheet.
   std::string m_stylesheet {};
-  std::vector <std::string> markers_stylesheet {};
+  std::shared_ptr<const database::styles::snapshot> m_styles {};
   
   // Matching markers.
   std::vector <std::string> markers_requiring_endmarkers {};
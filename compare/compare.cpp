@@ -88,10 +88,21 @@ void compare_compare(const std::string& bible, const std::string& compare, const
     std::vector<std::string> new_verses;
 
 
+    // The chapters present in both, in canonical order, each with the results of its comparison.
+    struct chapter_comparison
+    {
+        int book{0};
+        int chapter{0};
+        std::vector<std::string> result{};
+        std::vector<std::string> raw{};
+        std::vector<std::string> new_verses{};
+    };
+    std::vector<chapter_comparison> comparisons;
+
+
     for (const auto& book : books)
     {
         const std::string book_name = database::books::get_english_from_id(static_cast<book_id>(book));
-        database_jobs::set_progress(job_id, book_name);
 
 
         if (std::ranges::find(bible_books, book) == bible_books.end())
@@ -159,62 +170,113 @@ void compare_compare(const std::string& bible, const std::string& compare, const
             }
 
 
-            // Get source and compare USFM, and skip them if they are equal.
-            const std::string bible_chapter_usfm = database::bibles::get_chapter(bible, book, chapter);
-            std::string compare_chapter_usfm = database::bibles::get_chapter(compare, book, chapter);
-            if (compare_chapter_usfm.empty())
-                compare_chapter_usfm = database::usfm_resources::get_usfm(compare, book, chapter);
-            if (bible_chapter_usfm == compare_chapter_usfm)
-                continue;
+            comparisons.push_back({.book = book, .chapter = chapter});
+        }
+    }
 
 
-            // Get the sorted combined set of distinct verses in the chapter of the Bible and of the USFM to compare with.
-            const auto combined_distinct_verses = [&]
-            {
-                const std::vector<int> bible_verse_numbers = filter::usfm::get_verse_numbers(bible_chapter_usfm);
-                const std::vector<int> compare_verse_numbers = filter::usfm::get_verse_numbers(compare_chapter_usfm);
-                std::set<int> verse_set{};
-                verse_set.insert(bible_verse_numbers.cbegin(), bible_verse_numbers.cend());
-                verse_set.insert(compare_verse_numbers.cbegin(), compare_verse_numbers.cend());
-                std::vector verses(verse_set.cbegin(), verse_set.cend());
-                std::ranges::sort(verses);
-                return verses;
-            };
-
-
-            for (const int& verse : combined_distinct_verses())
+    // Compare one chapter.
+    const auto compare_chapter = [&bible, &compare, &stylesheet](chapter_comparison& comparison)
+    {
+        const int book = comparison.book;
+        const int chapter = comparison.chapter;
+
+        // Get source and compare USFM, and skip them if they are equal.
+        // Most chapters of a Bible compared with a resource it derives from are equal.
+        const std::string bible_chapter_usfm = database::bibles::get_chapter(bible, book, chapter);
+        std::string compare_chapter_usfm = database::bibles::get_chapter(compare, book, chapter);
+        if (compare_chapter_usfm.empty())
+            compare_chapter_usfm = database::usfm_resources::get_usfm(compare, book, chapter);
+        if (bible_chapter_usfm == compare_chapter_usfm)
+            return;
+
+
+        // Get the sorted combined set of distinct verses in the chapter of the Bible and of the USFM to compare with.
+        const auto combined_distinct_verses = [&]
+        {
+            const std::vector<int> bible_verse_numbers = filter::usfm::get_verse_numbers(bible_chapter_usfm);
+            const std::vector<int> compare_verse_numbers = filter::usfm::get_verse_numbers(compare_chapter_usfm);
+            std::set<int> verse_set{};
+            verse_set.insert(bible_verse_numbers.cbegin(), bible_verse_numbers.cend());
+            verse_set.insert(compare_verse_numbers.cbegin(), compare_verse_numbers.cend());
+            std::vector verses(verse_set.cbegin(), verse_set.cend());
+            std::ranges::sort(verses);
+            return verses;
+        };
+
+
+        const filter::usfm::ChapterVerses bible_chapter_verses (bible_chapter_usfm);
+        const filter::usfm::ChapterVerses compare_chapter_verses (compare_chapter_usfm);
+        for (const int& verse : combined_distinct_verses())
+        {
+            // Get the USFM of verse of the Bible and comparison USFM, and skip it if both are the same.
+            const std::string bible_verse_usfm = bible_chapter_verses.get_verse_text(verse);
+            const std::string compare_verse_usfm = compare_chapter_verses.get_verse_text(verse);
+            if (bible_verse_usfm == compare_verse_usfm)
+                continue;
+
+            auto filter_text_bible = Filter_Text(bible);
+            auto filter_text_compare = Filter_Text(compare);
+            filter_text_bible.html_text_standard = new HtmlText({});
+            filter_text_compare.html_text_standard = new HtmlText({});
+            filter_text_bible.text_text = new Text_Text();
+            filter_text_compare.text_text = new Text_Text();
+            filter_text_bible.add_usfm_code(bible_verse_usfm);
+            filter_text_compare.add_usfm_code(compare_verse_usfm);
+            filter_text_bible.run(stylesheet);
+            filter_text_compare.run(stylesheet);
+            const std::string bible_html = filter_text_bible.html_text_standard->get_inner_html();
+            const std::string compare_html = filter_text_compare.html_text_standard->get_inner_html();
+            const std::string bible_text = filter_text_bible.text_text->get();
+            if (const std::string compare_text = filter_text_compare.text_text->get();
+                bible_text != compare_text)
             {
-                // Get the USFM of verse of the Bible and comparison USFM, and skip it if both are the same.
-                const std::string bible_verse_usfm = filter::usfm::get_verse_text(bible_chapter_usfm, verse);
-                const std::string compare_verse_usfm = filter::usfm::get_verse_text(compare_chapter_usfm, verse);
-                if (bible_verse_usfm == compare_verse_usfm)
-                    continue;
+                const std::string modification = filter_diff_diff(compare_text, bible_text);
+                comparison.result.push_back(filter_passage_display(book, chapter, std::to_string(verse)) + " " + modification);
+                comparison.new_verses.push_back(
+                    filter_passage_display(book, chapter, std::to_string(verse)) + " " + bible_text);
+            }
+            const std::string modification = filter_diff_diff(compare_verse_usfm, bible_verse_usfm);
+            comparison.raw.push_back(filter_passage_display(book, chapter, std::to_string(verse)) + " " + modification);
+        }
+    };
 
-                auto filter_text_bible = Filter_Text(bible);
-                auto filter_text_compare = Filter_Text(compare);
-                filter_text_bible.html_text_standard = new HtmlText({});
-                filter_text_compare.html_text_standard = new HtmlText({});
-                filter_text_bible.text_text = new Text_Text();
-                filter_text_compare.text_text = new Text_Text();
-                filter_text_bible.add_usfm_code(bible_verse_usfm);
-                filter_text_compare.add_usfm_code(compare_verse_usfm);
-                filter_text_bible.run(stylesheet);
-                filter_text_compare.run(stylesheet);
-                const std::string bible_html = filter_text_bible.html_text_standard->get_inner_html();
-                const std::string compare_html = filter_text_compare.html_text_standard->get_inner_html();
-                const std::string bible_text = filter_text_bible.text_text->get();
-                if (const std::string compare_text = filter_text_compare.text_text->get();
-                    bible_text != compare_text)
-                {
-                    const std::string modification = filter_diff_diff(compare_text, bible_text);
-                    result.push_back(filter_passage_display(book, chapter, std::to_string(verse)) + " " + modification);
-                    new_verses.push_back(
-                        filter_passage_display(book, chapter, std::to_string(verse)) + " " + bible_text);
-                }
-                const std::string modification = filter_diff_diff(compare_verse_usfm, bible_verse_usfm);
-                raw.push_back(filter_passage_display(book, chapter, std::to_string(verse)) + " " + modification);
+
+    // The chapters get compared by a bounded number of workers,
+    // leaving processor time for serving the users.
+    std::mutex progress_mutex{};
+    size_t completed{0};
+    std::atomic<size_t> next{0};
+    const auto worker = [&]()
+    {
+        for (size_t i = next++; i < comparisons.size(); i = next++)
+        {
+            compare_chapter(comparisons[i]);
+            std::lock_guard lock(progress_mutex);
+            completed++;
+            if ((completed % 50 == 0) || (completed == comparisons.size()))
+            {
+                database_jobs::set_percentage(job_id, static_cast<int>(100 * completed / comparisons.size()));
+                database_jobs::set_progress(job_id, filter_passage_display(comparisons[i].book, comparisons[i].chapter, "") + " " +
+                                            std::to_string(completed) + "/" + std::to_string(comparisons.size()));
             }
         }
+    };
+    const size_t worker_count = std::min(std::max(std::thread::hardware_concurrency() / 2, 1u), 4u);
+    std::vector<std::thread> workers{};
+    for (size_t i{1}; i < std::min(worker_count, comparisons.size()); i++)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+
+
+    // Assemble the results in the order of the chapters.
+    for (auto& comparison : comparisons)
+    {
+        std::ranges::move(comparison.result, std::back_inserter(result));
+        std::ranges::move(comparison.raw, std::back_inserter(raw));
+        std::ranges::move(comparison.new_verses, std::back_inserter(new_verses));
     }
 
 
@@ -27,7 +27,8 @@ std::string config_globals_document_root {DIRECTORY_SEPARATOR};
 bool config_globals_unit_testing {false};
 bool config_globals_open_installation {false};
 bool config_globals_client_prepared {false};
-bool config_globals_webserver_running {true};
+std::atomic<bool> config_globals_webserver_running {true};
+std::atomic<size_t> config_globals_webserver_threads {0};
 std::thread * config_globals_http_worker {nullptr};
 std::thread * config_globals_https_worker {nullptr};
 std::thread * config_globals_timer {nullptr};
@@ -58,4 +59,6 @@ bool config_globals_running_on_chrome_os {false};
 bool config_globals_log_network {false};
 std::string config_globals_negotiated_port_number {};
 bool config_globals_has_crashed_while_mailing {false};
+// A POSTed value larger than this is written to a temporary file rather than kept in memory.
+size_t config_globals_post_spill_threshold {1'000'000};
 
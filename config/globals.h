@@ -24,7 +24,8 @@ extern std::string config_globals_document_root;
 extern bool config_globals_unit_testing;
 extern bool config_globals_open_installation;
 extern bool config_globals_client_prepared;
-extern bool config_globals_webserver_running;
+extern std::atomic<bool> config_globals_webserver_running;
+extern std::atomic<size_t> config_globals_webserver_threads;
 extern std::thread * config_globals_http_worker;
 extern std::thread * config_globals_https_worker;
 extern std::thread * config_globals_timer;
@@ -54,3 +55,4 @@ extern bool config_globals_running_on_chrome_os;
 extern bool config_globals_log_network;
 extern std::string config_globals_negotiated_port_number;
 extern bool config_globals_has_crashed_while_mailing;
+extern size_t config_globals_post_spill_threshold;
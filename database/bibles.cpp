@@ -61,10 +61,75 @@ static std::string chapter_folder (const std::string& bible, const int book, con
 }
 
 
+// The identifier given when a chapter has no revisions yet.
+// The first stored revision gets this plus one.
+constexpr int no_chapter_id {100'000'000};
+
+
+// The index of the Bibles, kept in memory.
+// Per Bible it holds book → chapter → the identifier of the most recent revision of the chapter.
+// This saves scanning and sorting the folders on every read.
+// It gets built per Bible on first use, and kept up to date as chapters are stored or deleted.
+using book_index = std::map <int, std::map <int, int>>;
+static std::mutex index_mutex {};
+static std::unordered_map <std::string, book_index> bibles_index {};
+
+
+// Returns the numeric names in the $folder.
+static std::vector <int> scan_numeric (const std::string& folder)
+{
+  std::vector <int> numbers {};
+  for (const auto& file : filter_url_scandir (folder)) {
+    if (filter::string::is_numeric (file))
+      numbers.push_back (filter::string::convert_to_int (file));
+  }
+  return numbers;
+}
+
+
+// Returns the index of the $bible, reading it from disk if needed.
+// Returns nullptr if the Bible does not exist.
+// The caller should hold the index mutex.
+static book_index* get_index (const std::string& bible)
+{
+  if (const auto iter = bibles_index.find (bible); iter != bibles_index.end ())
+    return &iter->second;
+  if (bible.empty () || !file_or_dir_exists (bible_folder (bible)))
+    return nullptr;
+  book_index books {};
+  for (const int book : scan_numeric (bible_folder (bible))) {
+    auto& chapters = books [book];
+    for (const int chapter : scan_numeric (book_folder (bible, book))) {
+      const std::vector <int> ids = scan_numeric (chapter_folder (bible, book, chapter));
+      chapters [chapter] = ids.empty () ? no_chapter_id : *std::max_element (ids.cbegin (), ids.cend ());
+    }
+  }
+  return &bibles_index.emplace (bible, std::move (books)).first->second;
+}
+
+
+// Returns the path to the most recent revision of a chapter, or nothing if there's none.
+static std::optional <std::string> get_head_path (const std::string& bible, const int book, const int chapter)
+{
+  const int id = get_chapter_id (bible, book, chapter);
+  if (id == no_chapter_id)
+    return std::nullopt;
+  return filter_url_create_path ({chapter_folder (bible, book, chapter), std::to_string (id)});
+}
+
+
+// Drops the index of the $bible, so it gets read from disk again when next needed.
+static void forget_index (const std::string& bible)
+{
+  std::lock_guard lock (index_mutex);
+  bibles_index.erase (bible);
+}
+
+
 // Returns a list of available Bibles.
 std::vector <std::string> get_bibles ()
 {
-  return filter_url_scandir (main_folder ());
+  return *filter_url_scandir_shared (main_folder ());
 }
 
 
@@ -74,6 +139,7 @@ void create_bible (const std::string& bible)
   // Create the empty system.
   const std::string& folder = bible_folder (bible);
   filter_url_mkdir (folder);
+  forget_index (bible);
   // Handle exporting it.
   Database_State::setExport (bible, 0, export_logic::export_needed);
 }
@@ -87,6 +153,7 @@ void delete_bible (const std::string& bible)
   filter_url_rmdir (path);
   // Just in case it was a regular file: Delete it too.
   filter_url_unlink (path);
+  forget_index (bible);
   // Handle exporting it.
   Database_State::setExport (bible, 0, export_logic::export_needed);
 }
@@ -111,7 +178,12 @@ void store_chapter (const std::string& bible, const int book, const int chapter_
   int id = get_chapter_id (bible, book, chapter_number);
   id++;
   const std::string file = filter_url_create_path ({folder, std::to_string (id)});
-  filter_url_file_put_contents (file, chapter_text);
+  filter_url_file_put_contents_durable (file, chapter_text);
+  {
+    std::lock_guard lock (index_mutex);
+    if (book_index* books = get_index (bible); books)
+      (*books) [book] [chapter_number] = id;
+  }
   
   // Update search fields.
   update_search_fields (bible, book, chapter_number);
@@ -130,13 +202,13 @@ void update_search_fields (const std::string& bible, const int book, const int c
 // Returns an array with the available books in a Bible.
 std::vector <int> get_books (const std::string& bible)
 {
-  // Read the books from the database.
-  const std::string folder = bible_folder (bible);
-  const std::vector <std::string> files = filter_url_scandir (folder);
+  // Read the books from the index.
   std::vector <int> books {};
-  for (const auto& book : files) {
-    if (filter::string::is_numeric (book)) {
-      books.push_back (filter::string::convert_to_int (book));
+  {
+    std::lock_guard lock (index_mutex);
+    if (const book_index* index = get_index (bible); index) {
+      for (const auto& element : *index)
+        books.push_back (element.first);
     }
   }
   
@@ -157,6 +229,11 @@ void delete_book (const std::string& bible, int book)
 {
   const std::string folder = book_folder (bible, book);
   filter_url_rmdir (folder);
+  {
+    std::lock_guard lock (index_mutex);
+    if (book_index* books = get_index (bible); books)
+      books->erase (book);
+  }
   Database_State::setExport (bible, 0, export_logic::export_needed);
 }
 
@@ -164,14 +241,15 @@ void delete_book (const std::string& bible, int book)
 // Returns an array with the available chapters in a $book in a Bible.
 std::vector <int> get_chapters (const std::string& bible, const int book)
 {
-  // Read the chapters from the database.
-  const std::string folder = book_folder (bible, book);
+  // Read the chapters from the index, where they are sorted already.
   std::vector <int> chapters;
-  const std::vector <std::string> files = filter_url_scandir (folder);
-  for (const auto& file : files) {
-    if (filter::string::is_numeric (file)) chapters.push_back (filter::string::convert_to_int (file));
+  std::lock_guard lock (index_mutex);
+  if (const book_index* books = get_index (bible); books) {
+    if (const auto iter = books->find (book); iter != books->cend ()) {
+      for (const auto& element : iter->second)
+        chapters.push_back (element.first);
+    }
   }
-  std::sort (chapters.begin (), chapters.end ());
   return chapters;
 }
 
@@ -180,6 +258,13 @@ void delete_chapter (const std::string& bible, int book, int chapter)
 {
   const std::string folder = chapter_folder (bible, book, chapter);
   filter_url_rmdir (folder);
+  {
+    std::lock_guard lock (index_mutex);
+    if (book_index* books = get_index (bible); books) {
+      if (const auto iter = books->find (book); iter != books->end ())
+        iter->second.erase (chapter);
+    }
+  }
   Database_State::setExport (bible, 0, export_logic::export_needed);
 }
 
@@ -187,12 +272,9 @@ void delete_chapter (const std::string& bible, int book, int chapter)
 // Gets the chapter data as a string.
 std::string get_chapter (const std::string& bible, const int book, const int chapter)
 {
-  // Read the chapter data from the database.
-  const std::string folder = chapter_folder (bible, book, chapter);
-  const std::vector <std::string> files = filter_url_scandir (folder);
-  if (!files.empty ()) {
-    const std::string file = files.at(files.size() - 1);
-    std::string data = filter_url_file_get_contents (filter_url_create_path ({folder, file}));
+  // Read the most recent revision of the chapter.
+  if (const std::optional <std::string> path = get_head_path (bible, book, chapter); path) {
+    std::string data = filter_url_file_get_contents (path.value ());
     // Remove trailing new line.
     data = filter::string::trim (data);
     return data;
@@ -204,25 +286,22 @@ std::string get_chapter (const std::string& bible, const int book, const int cha
 // Gets the chapter id.
 int get_chapter_id (const std::string& bible, const int book, const int chapter)
 {
-  const std::string folder = chapter_folder (bible, book, chapter);
-  const std::vector <std::string> files = filter_url_scandir (folder);
-  if (!files.empty ()) {
-    const std::string file = files.at(files.size() - 1);
-    return filter::string::convert_to_int (file);
+  std::lock_guard lock (index_mutex);
+  if (const book_index* books = get_index (bible); books) {
+    if (const auto book_iter = books->find (book); book_iter != books->cend ()) {
+      if (const auto chapter_iter = book_iter->second.find (chapter); chapter_iter != book_iter->second.cend ())
+        return chapter_iter->second;
+    }
   }
-  return 100'000'000;
+  return no_chapter_id;
 }
 
 
 // Gets the chapter's time stamp in seconds since the Epoch.
 int get_chapter_age (const std::string& bible, const int book, const int chapter)
 {
-  const std::string folder = chapter_folder (bible, book, chapter);
-  const std::vector <std::string> files = filter_url_scandir (folder);
-  if (!files.empty ()) {
-    const std::string file = files.at(files.size() - 1);
-    const std::string path = filter_url_create_path ({folder, file});
-    const int time = filter_url_file_modification_time (path);
+  if (const std::optional <std::string> path = get_head_path (bible, book, chapter); path) {
+    const int time = filter_url_file_modification_time (path.value ());
     const int now = filter::date::get_seconds_since_epoch ();
     return now - time;
   }
@@ -244,15 +323,31 @@ void optimize ()
         const std::vector <std::string> files = filter_url_scandir (folder);
         // Remove files with 0 size. so that in case a chapter was emptied by accident,
         // it is removed now, effectually reverting the chapter to an earlier version.
+        std::vector <std::string> empty_files {};
         std::vector <std::string> files2 {};
         for (const auto& file : files) {
-          const std::string path = filter_url_create_path ({folder, file});
-          if (filter_url_filesize (path) == 0) {
-            filter_url_unlink (path);
-            Database_State::setExport (bible, 0, export_logic::export_needed);
-          }
+          // Skip temporary files of chapters being written right now.
+          if (!filter::string::is_numeric (file))
+            continue;
+          if (filter_url_filesize (filter_url_create_path ({folder, file})) == 0)
+            empty_files.push_back (file);
           else files2.push_back (file);
         }
+        if (!empty_files.empty ()) {
+          // If the most recent revision is empty, point the index to the one before it,
+          // before removing it, so nobody reads the removed revision meanwhile.
+          {
+            std::lock_guard lock (index_mutex);
+            if (book_index* index = get_index (bible); index) {
+              int& id = (*index) [book] [chapter];
+              if (std::find (empty_files.cbegin (), empty_files.cend (), std::to_string (id)) != empty_files.cend ())
+                id = files2.empty () ? no_chapter_id : filter::string::convert_to_int (files2.back ());
+            }
+          }
+          for (const auto& file : empty_files)
+            filter_url_unlink (filter_url_create_path ({folder, file}));
+          Database_State::setExport (bible, 0, export_logic::export_needed);
+        }
         // Remove the three most recent files from the list, so they don't get deleted.
         // Because scandir sorts the files, the files to be kept are at the end.
         if (!files2.empty()) files2.pop_back ();
@@ -269,4 +364,13 @@ void optimize ()
 }
 
 
+// Drops the index of all Bibles.
+// To be called after Bible data was written to disk other than through this database.
+void clear_index ()
+{
+  std::lock_guard lock (index_mutex);
+  bibles_index.clear ();
+}
+
+
 }
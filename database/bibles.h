@@ -51,5 +51,7 @@ int get_chapter_age (const std::string& bible, const int book, const int chapter
 
 void optimize ();
 
+void clear_index ();
+
 }
 
@@ -20,11 +20,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <database/cache.h>
 #include <filter/url.h>
 #include <filter/string.h>
-#include <filter/shell.h>
+#include <filter/date.h>
 #include <database/sqlite.h>
 #include <database/logs.h>
 #include <database/logic.h>
 #include <database/config/general.h>
+#ifndef HAVE_WINDOWS
+#include <sys/statvfs.h>
+#endif
 
 
 // Databases resilience:
@@ -210,6 +213,40 @@ std::string retrieve (const std::string& resource, const int book, const int cha
 }
 
 
+// Retrieves the cached values of all verses of a chapter, in one query.
+// Returns them per verse.
+std::map <int, std::string> retrieve (const std::string& resource, const int book, const int chapter)
+{
+  std::map <std::string, std::vector <std::string>> result {};
+  // If the book-based cache exists, retrieve them from there.
+  if (exists (resource, book)) {
+    SqliteDatabase sql = SqliteDatabase (filename (resource, book));
+    sql.add ("SELECT verse, value FROM cache WHERE chapter = ");
+    sql.add (chapter);
+    sql.add (";");
+    result = sql.query ();
+  }
+  // Else if the previous cache layout exists, retrieve them from there.
+  else if (exists (resource, 0)) {
+    SqliteDatabase sql = SqliteDatabase (filename (resource, 0));
+    sql.add ("SELECT verse, value FROM cache WHERE book =");
+    sql.add (book);
+    sql.add ("AND chapter = ");
+    sql.add (chapter);
+    sql.add (";");
+    result = sql.query ();
+  }
+  std::map <int, std::string> values {};
+  const std::vector <std::string>& verses = result ["verse"];
+  const std::vector <std::string>& texts = result ["value"];
+  for (size_t i = 0; (i < verses.size ()) && (i < texts.size ()); i++) {
+    // Like the query for one verse, take the first value stored for a verse.
+    values.emplace (filter::string::convert_to_int (verses [i]), texts [i]);
+  }
+  return values;
+}
+
+
 // Returns how many element are in cache $resource.
 int count (const std::string& resource)
 {
@@ -287,6 +324,129 @@ static std::string split_file (std::string file)
 }
 
 
+// The index of the cached files, kept in memory.
+// It lists the files from the most to the least recently used, with their sizes.
+// Storing a file removes the least recently used files once the cache grows beyond its budget.
+// This way the cache stays within its budget without walking through the cache folder.
+// The index gets read from disk once, at the first trim.
+struct cached_file {
+  std::string path {};
+  size_t size {0};
+  int accessed {0};
+};
+static std::mutex index_mutex {};
+static std::list <cached_file> cached_files {};
+static std::unordered_map <std::string, std::list <cached_file>::iterator> cached_index {};
+static size_t cached_bytes {0};
+static bool index_loaded {false};
+static size_t byte_budget {1'024 * 1'024 * 1'024};
+// Storing a file creates its folder, and removing a file removes the folders that become empty.
+// This mutex makes those happen one after the other, so a folder does not disappear while a file gets stored in it.
+// When both mutexes are needed, this one is locked first.
+static std::mutex folder_mutex {};
+
+
+// Returns the access time and the size of the file at $path.
+static std::pair <int, size_t> file_access_size (const std::string& path)
+{
+  struct stat attributes {};
+  if (stat (path.c_str (), &attributes) != 0)
+    return {0, 0};
+  return {static_cast<int>(attributes.st_atime), static_cast<size_t>(attributes.st_size)};
+}
+
+
+// Removes the cached file at $path, and the folders that become empty through that.
+static void remove_file (const std::string& path)
+{
+  filter_url_unlink (path);
+  const std::string root = full_path ("");
+  std::string folder = filter_url_dirname (path);
+  while ((folder.size () > root.size ()) && filter_url_scandir (folder).empty ()) {
+    filter_url_rmdir (folder);
+    folder = filter_url_dirname (folder);
+  }
+}
+
+
+// Records that the file at $path of $size bytes was used just now.
+// The caller should hold the index mutex.
+static void touch (const std::string& path, const size_t size)
+{
+  if (const auto iter = cached_index.find (path); iter != cached_index.end ()) {
+    cached_bytes -= iter->second->size;
+    cached_files.erase (iter->second);
+  }
+  cached_files.push_front ({path, size, filter::date::get_seconds_since_epoch ()});
+  cached_index [path] = cached_files.begin ();
+  cached_bytes += size;
+}
+
+
+// Takes the least recently used files out of the index till the cache is within the budget,
+// and also the files that were not used since the $cutoff time.
+// It returns their paths.
+// The caller should hold the index mutex, and remove the files after releasing it,
+// so that other threads do not wait for the disk.
+[[nodiscard]] static std::vector <std::string> evict (const int cutoff = 0)
+{
+  std::vector <std::string> paths {};
+  while (!cached_files.empty ()) {
+    cached_file& file = cached_files.back ();
+    if ((cached_bytes <= byte_budget) && (file.accessed >= cutoff))
+      break;
+    cached_bytes -= file.size;
+    cached_index.erase (file.path);
+    paths.push_back (std::move (file.path));
+    cached_files.pop_back ();
+  }
+  return paths;
+}
+
+
+// Removes the files at the $paths, and the folders that become empty through that.
+// A file that was stored again after it was evicted is back in the index, and is kept.
+static void remove_files (const std::vector <std::string>& paths)
+{
+  if (paths.empty ())
+    return;
+  std::lock_guard folder_lock (folder_mutex);
+  for (const auto& path : paths) {
+    {
+      std::lock_guard index_lock (index_mutex);
+      if (cached_index.contains (path))
+        continue;
+    }
+    remove_file (path);
+  }
+}
+
+
+// Reads the index from disk, keeping the files used since the process started.
+// The caller should hold the index mutex.
+static void load_index ()
+{
+  std::vector <std::string> paths {};
+  filter_url_recursive_scandir (full_path (""), paths);
+  std::vector <cached_file> files {};
+  for (auto& path : paths) {
+    if (cached_index.count (path) || filter_url_is_dir (path))
+      continue;
+    const auto [accessed, size] = file_access_size (path);
+    files.push_back ({std::move (path), size, accessed});
+  }
+  std::sort (files.begin (), files.end (), [] (const cached_file& a, const cached_file& b) noexcept {
+    return a.accessed > b.accessed;
+  });
+  for (auto& file : files) {
+    cached_bytes += file.size;
+    cached_files.push_back (std::move (file));
+    cached_index [cached_files.back ().path] = std::prev (cached_files.end ());
+  }
+  index_loaded = true;
+}
+
+
 bool exists (std::string schema)
 {
   schema = filter_url_clean_filename (schema);
@@ -302,9 +462,18 @@ void put (std::string schema, const std::string& contents)
   schema = split_file (schema);
   schema = full_path (schema);
   const std::string path = filter_url_dirname (schema);
-  if (!file_or_dir_exists (path)) 
-    filter_url_mkdir (path);
-  filter_url_file_put_contents (schema, contents);
+  std::vector <std::string> evicted {};
+  {
+    std::lock_guard folder_lock (folder_mutex);
+    if (!file_or_dir_exists (path)) 
+      filter_url_mkdir (path);
+    filter_url_file_put_contents (schema, contents);
+    std::lock_guard index_lock (index_mutex);
+    touch (schema, contents.size ());
+    if (index_loaded)
+      evicted = evict ();
+  }
+  remove_files (evicted);
 }
 
 
@@ -313,7 +482,12 @@ std::string get (std::string schema)
   schema = filter_url_clean_filename (schema);
   schema = database::cache::file::split_file (schema);
   schema = database::cache::file::full_path (schema);
-  return filter_url_file_get_contents (schema);
+  std::string contents = filter_url_file_get_contents (schema);
+  if (!contents.empty ()) {
+    std::lock_guard lock (index_mutex);
+    touch (schema, contents.size ());
+  }
+  return contents;
 }
 
 
@@ -323,6 +497,47 @@ void remove (std::string schema)
   schema = split_file (schema);
   schema = full_path (schema);
   filter_url_unlink (schema);
+  std::lock_guard lock (index_mutex);
+  if (const auto iter = cached_index.find (schema); iter != cached_index.end ()) {
+    cached_bytes -= iter->second->size;
+    cached_files.erase (iter->second);
+    cached_index.erase (iter);
+  }
+}
+
+
+// Sets the maximum number of bytes the file-based cache takes.
+void set_budget (const size_t bytes)
+{
+  std::vector <std::string> evicted {};
+  {
+    std::lock_guard lock (index_mutex);
+    byte_budget = bytes;
+    if (index_loaded)
+      evicted = evict ();
+  }
+  remove_files (evicted);
+}
+
+
+// Returns the percentage of the disk in use on the file system that contains $path.
+static int get_percentage_disk_in_use (const std::string& path)
+{
+#ifdef HAVE_WINDOWS
+  (void) path;
+  return 0;
+#else
+  struct statvfs stats {};
+  if (statvfs (path.c_str (), &stats) != 0)
+    return 0;
+  // Calculate it the same way as "df" does:
+  // The used blocks as a part of the used blocks plus the blocks available to normal users, rounded up.
+  const unsigned long long used = stats.f_blocks - stats.f_bfree;
+  const unsigned long long total = used + stats.f_bavail;
+  if (total == 0)
+    return 0;
+  return static_cast<int>((used * 100 + total - 1) / total);
+#endif
 }
 
 
@@ -332,71 +547,45 @@ void trim (bool clear)
   if (clear)
     database::logs::log ("Clearing cache");
   
-  // The directory that contains the file-based cache files.
-  std::string path = database::cache::file::full_path ("");
-  
-  // Get the free space on the file system that contains the cache.
-  std::string output, error;
-  filter::shell::run (path, filter::shell::get_executable(filter::shell::Executable::df), {"."}, &output, &error);
-  if (!error.empty ())
-    database::logs::log (error);
-  int percentage_disk_in_use {0};
-  {
-    const std::vector<std::string> bits = filter::string::explode(output, ' ');
-    for (const auto& bit : bits) {
-      if (bit.find ('%') != std::string::npos) {
-        percentage_disk_in_use = filter::string::convert_to_int(bit);
-        // If a real percentage was found, other than 0, then skip the remainder.
-        // On macOS the first percentage found is %iused, so will be skipped.
-        if (percentage_disk_in_use != 0)
-          break;
-      }
-    }
-  }
+  // Get the space in use on the file system that contains the caches.
+  const std::string databases_path = filter_url_create_root_path ({database_logic_databases ()});
+  const int percentage_disk_in_use = get_percentage_disk_in_use (databases_path);
   database::logs::log ("Disk space in use is " + std::to_string(percentage_disk_in_use) + "%");
   
   // There have been instances that the cache takes up 4, 5, or 6 Gigabytes in the Cloud.
   // If the cache is left untrimmed, the size can be even larger.
   // This leads to errors when the disk runs out of space.
   // Therefore, it's good to remove cached files older than a couple of hours
-  // in cases where disk space is tight.
+  // in cases where disk space is tight, and to give the cache a smaller budget.
   // Two hours.
-  std::string minutes = "+120";
+  int minutes {120};
+  size_t budget {256 * 1'024 * 1'024};
   // One day.
-  if (percentage_disk_in_use < 70)
-    minutes = "+1440";
+  if (percentage_disk_in_use < 70) {
+    minutes = 1440;
+    budget = 1'024 * 1'024 * 1'024;
+  }
   // One week.
-  if (percentage_disk_in_use < 50)
-    minutes = "+10080";
-  
-  // Handle clearing the cache immediately.
-  if (clear)
-    minutes = "+0";
-  
-  // Remove files that have not been modified for x minutes.
-  // It uses a Linux shell command.
-  // This can be done because it runs on the server only.
-  // It used to do "cd /path/to/cache; find /path/to/cache ...".
-  // This could remove the folder "cache" too.
-  // After this folder was removed, no caching could take place anymore.
-  // https://github.com/bibledit/cloud/issues/366
-  // This was not visible on macOS, but it was visible on Linux.
-  // The fix is to do "cd /path/to/cache; find . ...".
-  output.clear ();
-  error.clear ();
-  filter::shell::run (path, filter::shell::get_executable(filter::shell::Executable::find), {".", "-amin", minutes, "-delete"}, &output, &error);
-  if (!output.empty ()) database::logs::log (output);
-  if (!error.empty ()) database::logs::log (error);
-  
-  // Remove empty directories.
-  output.clear ();
-  error.clear ();
-  filter::shell::run (path, filter::shell::get_executable(filter::shell::Executable::find), {".", "-type", "d", "-empty", "-delete"}, &output, &error);
-  if (!output.empty ()) database::logs::log (output);
-  if (!error.empty ()) database::logs::log (error);
+  if (percentage_disk_in_use < 50) {
+    minutes = 10080;
+    budget = static_cast<size_t>(4) * 1'024 * 1'024 * 1'024;
+  }
   
-  // The directory that contains the database-based cache files.
-  path = filter_url_create_root_path ({database_logic_databases ()});
+  // Remove files that have not been used for x minutes,
+  // and the least recently used files above the budget.
+  std::vector <std::string> evicted {};
+  {
+    std::lock_guard lock (index_mutex);
+    byte_budget = budget;
+    if (!index_loaded)
+      load_index ();
+    // Handle clearing the cache immediately.
+    if (clear)
+      evicted = evict (std::numeric_limits<int>::max ());
+    else
+      evicted = evict (filter::date::get_seconds_since_epoch () - minutes * 60);
+  }
+  remove_files (evicted);
   
   // The number of days to keep cached data depends on the percentage of the disk in use.
   // There have been instances that the cache takes up 4, 5, or 6 Gigabytes in the Cloud.
@@ -404,30 +593,34 @@ void trim (bool clear)
   // This may lead to errors when the disk runs out of space.
   // Therefore, it's good to limit caches more if the space is tight.
   // By default, keep the resources cache for 30 days.
-  std::string days = "+30";
+  int days {30};
   // If keeping the resources cache for an extended period of time, keep it for a full year.
   if (database::config::general::get_keep_resources_cache_for_long())
-    days = "+365";
+    days = 365;
   // If free disk space is tighter, keep the caches for a shorter period.
   if (percentage_disk_in_use > 80)
-    days = "+14";
+    days = 14;
   if (percentage_disk_in_use > 85)
-    days = "+7";
+    days = 7;
   if (percentage_disk_in_use > 90)
-    days = "+1";
+    days = 1;
   
   // Handle clearing the cache immediately.
   if (clear)
-    days = "0";
+    days = 0;
   
-  database::logs::log ("Will remove resource caches not accessed for " + days + " days");
+  database::logs::log ("Will remove resource caches not accessed for " + std::to_string (days) + " days");
   
-  // Remove database-based cached files that have not been modified for x days.
-  output.clear ();
-  error.clear ();
-  filter::shell::run (path, filter::shell::get_executable(filter::shell::Executable::find), {path, "-name", database::cache::sql::fragment () + "*", "-atime", days, "-delete"}, &output, &error);
-  if (!output.empty ()) database::logs::log (output);
-  if (!error.empty ()) database::logs::log (error);
+  // Remove database-based cached files that have not been accessed for x days.
+  const int cutoff = filter::date::get_seconds_since_epoch () - days * 24 * 3600;
+  const std::string fragment = database::cache::sql::fragment ();
+  for (const auto& name : filter_url_scandir (databases_path)) {
+    if (name.find (fragment) != 0)
+      continue;
+    const std::string path = filter_url_create_path ({databases_path, name});
+    if (clear || (file_access_size (path).first < cutoff))
+      filter_url_unlink (path);
+  }
   
   if (clear)
     database::logs::log ("Ready clearing  cache");
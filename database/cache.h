@@ -32,6 +32,7 @@ bool exists (const std::string& resource, int book);
 bool exists (const std::string& resource, int book, int chapter, int verse);
 void cache (const std::string& resource, int book, int chapter, int verse, const std::string& value);
 std::string retrieve (const std::string& resource, int book, int chapter, int verse);
+std::map <int, std::string> retrieve (const std::string& resource, int book, int chapter);
 int count (const std::string& resource);
 bool ready (const std::string& resource, int book);
 void ready (const std::string& resource, int book, bool ready);
@@ -45,6 +46,7 @@ namespace database::cache::file {
 bool exists (std::string schema);
 void put (std::string schema, const std::string& contents);
 std::string get (std::string schema);
+void set_budget (size_t bytes);
 void trim (bool clear);
 
 }
@@ -30,7 +30,9 @@ namespace database::config::bible {
 // Cache values in memory for better speed.
 // The speed improvement is supposed to come from reading a value from disk only once,
 // and after that to read the value straight from the memory cache.
+// Several threads may read settings at once, e.g. when indexing Bibles, so the cache is guarded.
 static std::map <std::string, std::string> cache;
+static std::mutex cache_mutex;
 
 
 // Functions for getting and setting values or lists of values follow now:
@@ -69,17 +71,21 @@ static T get_value(const std::string& bible, const char* key, const char* defaul
     {
         // Check the memory cache.
         const std::string cache_key = map_key(bible, key);
-        if (cache.contains(cache_key))
-            return cache.at(cache_key);
-        // Get the setting from file.
+        {
+            std::lock_guard lock(cache_mutex);
+            if (const auto iter = cache.find(cache_key); iter != cache.cend())
+                return iter->second;
+        }
+        // Get the setting from file, without holding the lock.
         std::string value;
         if (const std::string filename = file(bible, key); 
             file_or_dir_exists(filename))
             value = filter_url_file_get_contents(filename);
         else
             value = default_value;
-        // Cache it.
-        cache[cache_key] = value;
+        // Cache it, unless another thread has set a value meanwhile.
+        std::lock_guard lock(cache_mutex);
+        cache.emplace(cache_key, value);
         // Done.
         return value;
     };
@@ -113,13 +119,16 @@ static void set_value(const std::string& bible, const char* key, const T& value)
         if (bible.empty())
             return;
         // Store in memory cache.
-        cache[map_key(bible, key)] = val;
+        {
+            std::lock_guard lock(cache_mutex);
+            cache[map_key(bible, key)] = val;
+        }
         // Store on disk.
         const std::string filename = file(bible, key);
         if (const std::string dirname = filter_url_dirname(filename); 
             !file_or_dir_exists(dirname))
             filter_url_mkdir(dirname);
-        filter_url_file_put_contents(filename, val);
+        filter_url_file_put_contents_durable(filename, val);
     };
 
     if constexpr (std::is_same_v<T, std::string>)
@@ -147,6 +156,7 @@ void remove(const std::string& bible)
     const std::string folder = file(bible);
     filter_url_rmdir(folder);
     // Clear cache.
+    std::lock_guard lock(cache_mutex);
     cache.clear();
 }
 
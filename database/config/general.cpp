@@ -100,7 +100,7 @@ static void set_value(const char* key, const T& value)
         cache[key] = val;
         // Store on disk.
         const std::string filename = file(key);
-        filter_url_file_put_contents(filename, val);
+        filter_url_file_put_contents_durable(filename, val);
     };
 
     if constexpr (std::is_same_v<T, std::string>)
@@ -23,115 +23,179 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <filter/string.h>
 #include <filter/url.h>
 #include <webserver/request.h>
+#include <config/globals.h>
 
 
-// Database resilience: Stored in plain file system.
+// The messages are kept in memory, and requests waiting for a message are woken up straightaway.
+// Resilience: On a client the messages are mirrored in the plain file system,
+// so they survive the app being restarted.
 
 
 namespace database_ipc {
+
+
+namespace {
+
+struct Record
+{
+    int rowid{0};
+    std::string user{};
+    std::string channel{};
+    std::string command{};
+    std::string message{};
+    int timestamp{0};
+};
+
+std::vector<Record> records{};
+// The most recent row identifier, for giving each message a higher one.
+int last_rowid{0};
+// Whether the records have been loaded from disk.
+bool loaded{false};
+// The number of requests now waiting for a message.
+size_t waiting{0};
+std::mutex mutex{};
+std::condition_variable condition{};
+
+}
+
+
+#ifdef HAVE_CLIENT
+
+
 static std::string folder()
 {
     return filter_url_create_root_path({database_logic_databases(), "ipc"});
 }
 
 
-static std::string file(const std::string& file)
+// The name of the file that mirrors a record looks like this: rowid__user__channel__command
+static std::string file(const Record& record)
 {
-    return filter_url_create_path({folder(), file});
+    const std::string filename = std::to_string(record.rowid) + "__" + record.user + "__" + record.channel + "__" + record.command;
+    return filter_url_create_path({folder(), filename});
 }
 
 
-// Reads most fields of all data in this database.
-// Returns a container with the above.
-// The fields are those that can be obtained from the name of the files.
-// One file is one entry in the database.
-// The filename looks like this: rowid__user__channel__command
-static std::vector<Item> read_data()
+#endif
+
+
+// Loads the records mirrored on disk, once.
+// The mutex should be locked.
+static void load()
 {
-    std::vector<Item> data;
+    if (loaded)
+        return;
+    loaded = true;
+#ifdef HAVE_CLIENT
     const std::vector<std::string> files = filter_url_scandir(folder());
-    std::ranges::for_each(files, [&](const std::string& file)
+    for (const std::string& filename : files)
     {
-        if (const auto explosion = filter::string::explode(file, '_'); explosion.size() == 7)
+        if (const auto explosion = filter::string::explode(filename, '_'); explosion.size() == 7)
         {
-            Item item {
-                .file = file,
+            const std::string path = filter_url_create_path({folder(), filename});
+            Record record {
                 .rowid = filter::string::convert_to_int(explosion.at(0)),
                 .user = explosion.at(2),
                 .channel = explosion.at(4),
                 .command = explosion.at(6),
+                .message = filter_url_file_get_contents(path),
+                .timestamp = filter_url_file_modification_time(path),
             };
-            data.emplace_back(std::move(item));
+            last_rowid = std::max(last_rowid, record.rowid);
+            records.push_back(std::move(record));
         }
-    });
-    return data;
+    }
+    std::ranges::sort(records, {}, &Record::rowid);
+#endif
 }
 
 
-static void write_record(const int rowid, const std::string& user, const std::string& channel, const std::string& command, const std::string& message)
+// Removes the records for which the predicate is true.
+// The mutex should be locked.
+static void remove_records(const auto& predicate)
 {
-    std::string filename = std::to_string(rowid) + "__" + user + "__" + channel + "__" + command;
-    filename = file(filename);
-    filter_url_file_put_contents(filename, message);
+#ifdef HAVE_CLIENT
+    for (const Record& record : records)
+    {
+        if (predicate(record))
+            filter_url_unlink(file(record));
+    }
+#endif
+    std::erase_if(records, predicate);
 }
 
 
-// Returns the next available row identifier.
-static int get_next_id(const std::vector<Item>& data)
+// Finds the message with the highest identifier that matches.
+// The mutex should be locked.
+static Message find_message(const int id, const std::string& user, const std::string& channel, const std::string& command)
 {
-    auto&& range = data | std::views::transform(&Item::rowid);
-    const auto it = std::ranges::max_element(range);
-    int id = it != range.end() ? *it : 0;
-    ++id;
-    return id;
+    Message message;
+    // The records are sorted on identifier, so search from the end.
+    for (auto iter = records.crbegin(); iter != records.crend(); ++iter)
+    {
+        const Record& record = *iter;
+        // Selection condition 1: The database record has a message identifier younger than the calling identifier.
+        if (record.rowid <= id)
+            break;
+        // Selection condition 2: Channel matches calling channel, or empty channel.
+        if (record.channel != channel and !record.channel.empty())
+            continue;
+        // Selection condition 3: Record user matches calling user, or empty user.
+        if (record.user != user and !record.user.empty())
+            continue;
+        // Selection condition 4: Matching command.
+        if (record.command != command)
+            continue;
+        message.id = record.rowid;
+        message.channel = record.channel;
+        message.command = record.command;
+        message.message = record.message;
+        break;
+    }
+    return message;
 }
 
 
 void trim()
 {
-    const std::vector<Item> data = read_data();
-    std::ranges::for_each(data, [](const auto& record)
-    {
-        if (record.user.empty())
-            delete_message(record.rowid);
-    });
+    std::unique_lock lock(mutex);
+    load();
     const int now = filter::date::get_seconds_since_epoch();
-    std::vector<std::string> files = filter_url_scandir(folder());
-    std::ranges::for_each(files, [now] (const std::string& item)
-    {
-        const std::string path = file(item);
-        if (const int modification_time = filter_url_file_modification_time(path);
-            now - modification_time > 3600)
-            filter_url_unlink(path);
+    remove_records([now](const Record& record) noexcept {
+        return record.user.empty() or (now - record.timestamp > 3600);
     });
 }
 
 
 void store_message(const std::string& user, const std::string& channel, const std::string& command, const std::string& message)
 {
-    // Load entire database into memory.
-    const std::vector<Item> data = read_data();
-
-    // Write new information.
     {
-        const int rowid = get_next_id(data);
-        write_record(rowid, user, channel, command, message);
-    }
+        std::unique_lock lock(mutex);
+        load();
 
-    // Gather information about records to delete and delete those.
-    // Do this after writing new data, to be sure there is always some data on disk.
-    if (channel.empty())
-    {
-        const auto match = [&](auto&& record) noexcept
+        // Messages on the empty channel replace earlier ones of the same user and command.
+        if (channel.empty())
         {
-            return record.user == user and record.channel == channel and record.command == command;
+            remove_records([&](const Record& record) noexcept {
+                return record.user == user and record.channel == channel and record.command == command;
+            });
+        }
+
+        Record record {
+            .rowid = ++last_rowid,
+            .user = user,
+            .channel = channel,
+            .command = command,
+            .message = message,
+            .timestamp = filter::date::get_seconds_since_epoch(),
         };
-        auto&& row_ids = data | std::views::filter(match) | std::views::transform(&Item::rowid);
-        std::ranges::for_each(row_ids, [](const auto row_id)
-        {
-            delete_message(row_id);
-        });
+#ifdef HAVE_CLIENT
+        filter_url_file_put_contents(file(record), message);
+#endif
+        records.push_back(std::move(record));
     }
+    // Wake up the requests waiting for a message.
+    condition.notify_all();
 }
 
 
@@ -139,59 +203,60 @@ void store_message(const std::string& user, const std::string& channel, const st
 // Returns an object with the data.
 // The rowid is 0 if there was nothing,
 // Else the object's properties are set properly.
-Message retrieve_message(int id, const std::string& user, const std::string& channel, const std::string& command)
+Message retrieve_message(const int id, const std::string& user, const std::string& channel, const std::string& command)
 {
-    int highest_id = 0;
-    std::string hit_channel;
-    std::string hit_command;
-    std::string hit_message;
-    for (auto& [record_file, record_id, record_user, record_channel, record_command] : read_data())
-    {
-        // Selection condition 1: The database record has a message identifier younger than the calling identifier.
-        if (record_id > id)
-        {
-            // Selection condition 2: Channel matches calling channel, or empty channel.
-            if (record_channel == channel or record_channel.empty())
-            {
-                // Selection condition 3: Record user matches calling user, or empty user.
-                if (record_user == user or record_user.empty())
-                {
-                    // Selection condition 4: Matching command.
-                    if (record_command == command)
-                    {
-                        if (record_id > highest_id)
-                        {
-                            highest_id = record_id;
-                            hit_channel = record_channel;
-                            hit_command = record_command;
-                            hit_message = filter_url_file_get_contents(file(record_file));
-                        }
-                    }
-                }
-            }
-        }
-    }
-    Message message;
-    if (highest_id)
-    {
-        message.id = highest_id;
-        message.channel = hit_channel;
-        message.command = hit_command;
-        message.message = hit_message;
-    }
-    return message;
+    std::unique_lock lock(mutex);
+    load();
+    return find_message(id, user, channel, command);
 }
 
 
 void delete_message(const int id)
 {
-    const std::vector<Item> data = read_data();
-    std::ranges::for_each(data, [id](const auto& record)
+    std::unique_lock lock(mutex);
+    load();
+    remove_records([id](const Record& record) noexcept {
+        return record.rowid == id;
+    });
+}
+
+
+// Waits till there is a message for the user with the command on the empty channel,
+// younger than the identifier passed.
+// It returns the message, or an empty message if none came within the timeout.
+// This is for long-polls. Each waiting request keeps a thread of the web server busy,
+// so if a quarter of those threads are waiting already, this returns right away.
+Message wait_message(const int id, const std::string& user, const std::string& command, const std::chrono::milliseconds timeout)
+{
+    const size_t maximum_waiting {std::max(config_globals_webserver_threads / 4, static_cast<size_t>(1))};
+    std::unique_lock lock(mutex);
+    load();
+    Message message = find_message(id, user, std::string(), command);
+    if (message.id or (waiting >= maximum_waiting))
+        return message;
+    waiting++;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    // Wake up every second to check whether the server is stopping.
+    while (!message.id and config_globals_webserver_running)
     {
-        if (record.rowid == id)
-            filter_url_unlink(file(record.file));
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+        condition.wait_until(lock, std::min(deadline, now + std::chrono::seconds(1)));
+        message = find_message(id, user, std::string(), command);
+    }
+    waiting--;
+    return message;
+}
 
-    });
+
+// Removes all messages from memory, so they get loaded again.
+void clear()
+{
+    std::unique_lock lock(mutex);
+    records.clear();
+    last_rowid = 0;
+    loaded = false;
 }
 
 
@@ -199,27 +264,19 @@ Message get_note(Webserver_Request& webserver_request)
 {
     const std::string& user = webserver_request.session_logic()->get_username();
 
-    int highest_id = 0;
-    std::string hit_message;
-
-    const  std::vector<Item> data = read_data();
-    std::ranges::for_each(data, [&](const auto& record)
-    {
-        // Conditions: Command is "opennote", and matching user.
-        if (record.command == "opennote" and record.user == user and record.rowid > highest_id)
-        {
-            highest_id = record.rowid;
-            hit_message = filter_url_file_get_contents(file(record.file));
-        }
-    });
+    std::unique_lock lock(mutex);
+    load();
 
+    // Conditions: Command is "opennote", and matching user.
     Message note;
-    if (highest_id)
+    const auto iter = std::ranges::find_if(records.crbegin(), records.crend(), [&user](const Record& record) {
+        return record.command == "opennote" and record.user == user;
+    });
+    if (iter != records.crend())
     {
-        note.id = highest_id;
-        note.message = hit_message;
+        note.id = iter->rowid;
+        note.message = iter->message;
     }
-
     return note;
 }
 
@@ -228,25 +285,18 @@ bool get_notes_alive(Webserver_Request& webserver_request)
 {
     const std::string& user = webserver_request.session_logic()->get_username();
 
-    int highest_id = 0;
-    std::string hit_message;
+    std::unique_lock lock(mutex);
+    load();
 
-    const std::vector<Item> data = read_data();
-    std::ranges::for_each(data, [&](const auto& record)
-    {
-        // Conditions: Command is "notesalive", and matching user.
-        if (record.command == "notesalive" and record.user == user and record.rowid > highest_id)
-        {
-            highest_id = record.rowid;
-            hit_message = filter_url_file_get_contents(file(record.file));
-        }
+    // Conditions: Command is "notesalive", and matching user.
+    const auto iter = std::ranges::find_if(records.crbegin(), records.crend(), [&user](const Record& record) {
+        return record.command == "notesalive" and record.user == user;
     });
-
-    if (highest_id)
-        return filter::string::convert_to_bool(hit_message);
+    if (iter != records.crend())
+        return filter::string::convert_to_bool(iter->message);
 
     return false;
 }
 
 
-}
\ No newline at end of file
+}
@@ -29,14 +29,8 @@ class Webserver_Request;
 namespace database_ipc {
 
 
-struct Item
-{
-    std::string file{};
-    int rowid{0};
-    std::string user{};
-    std::string channel{};
-    std::string command{};
-};
+// How long a long-poll waits for a message.
+constexpr std::chrono::seconds long_poll_timeout {15};
 
 
 struct Message
@@ -52,6 +46,8 @@ void trim();
 void store_message(const std::string& user, const std::string& channel, const std::string& command, const std::string& message);
 Message retrieve_message(int id, const std::string& user, const std::string& channel, const std::string& command);
 void delete_message(int id);
+Message wait_message(int id, const std::string& user, const std::string& command, std::chrono::milliseconds timeout);
+void clear();
 Message get_note(Webserver_Request&);
 bool get_notes_alive(Webserver_Request&);
 
@@ -31,6 +31,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 // Due to the infrequent write operations, there is a low and acceptable change of corruption.
 
 
+// Every authenticated request looks up the username and the touch setting by the cookie.
+// The logins found are cached in memory, so that most requests do not need the database.
+// The database is updated along with the cache.
+// The daily update of the timestamp of a login is written behind, by the timer.
+
+
 namespace database::login {
 // Gets the current number of days since the Unix epoch.
 static int timestamp()
@@ -39,6 +45,36 @@ static int timestamp()
 }
 
 
+namespace {
+
+struct Login final
+{
+    std::string username {};
+    bool touch {false};
+    // The day the login was last used.
+    int timestamp {0};
+    // When the cached login gets read from the database again.
+    int expiry {0};
+};
+
+// Cached logins expire after this many seconds, as a safeguard against outside changes to the database.
+constexpr int cache_seconds {600};
+
+std::mutex cache_mutex {};
+
+// The cached logins, keyed by cookie.
+std::unordered_map<std::string, Login> cache {};
+
+// The cookies whose timestamp is still to be written to the database.
+std::set<std::string> pending_timestamps {};
+
+// Changes whenever logins get removed from the cache.
+// A login read from the database while this changed may be outdated, so it does not get cached.
+unsigned int cache_generation {0};
+
+}
+
+
 // The name of the database.
 const char* database()
 {
@@ -65,6 +101,12 @@ void create()
 void trim()
 {
     // Remove persistent logins after 365 days of inactivity.
+    write_timestamps();
+    {
+        std::lock_guard lock(cache_mutex);
+        cache.clear();
+        cache_generation++;
+    }
     SqliteDatabase sql(database());
     sql.add("DELETE FROM logins WHERE timestamp < ");
     sql.add(timestamp() - 365);
@@ -75,10 +117,12 @@ void trim()
 
 void optimize()
 {
+    write_timestamps();
     if (!healthy())
     {
         // (Re)create damaged or non-existing database.
         filter_url_unlink(sqlite::get_file(database()));
+        clear_cache();
         create();
     }
     // Vacuum it.
@@ -125,6 +169,9 @@ void set_tokens(std::string username, std::string address, std::string agent, st
     sql.add(timestamp());
     sql.add(");");
     sql.execute();
+    std::lock_guard lock(cache_mutex);
+    cache.erase(cookie);
+    cache_generation++;
 }
 
 
@@ -136,6 +183,9 @@ void remove_tokens(const std::string& username)
     sql.add(username);
     sql.add(";");
     sql.execute();
+    std::lock_guard lock(cache_mutex);
+    std::erase_if(cache, [&username](const auto& element) { return element.second.username == username; });
+    cache_generation++;
 }
 
 
@@ -152,6 +202,9 @@ void remove_tokens(const std::string& username, const std::string& cookie)
     sql.add(cookie);
     sql.add(";");
     sql.execute();
+    std::lock_guard lock(cache_mutex);
+    cache.erase(cookie);
+    cache_generation++;
 }
 
 
@@ -166,44 +219,70 @@ void rename_tokens(const std::string& username_existing, const std::string& user
     sql.add(cookie);
     sql.add(";");
     sql.execute();
+    std::lock_guard lock(cache_mutex);
+    cache.erase(cookie);
+    cache_generation++;
 }
 
 
 // Returns the username that matches the cookie sent by the browser.
 // Once a day, $daily will be set true.
+// On a cache miss the database is queried without holding the lock, so other requests are not held up.
 std::string get_username(const std::string& cookie, bool& daily)
 {
-    SqliteDatabase sql(database());
-    sql.add("SELECT rowid, timestamp, username FROM logins WHERE cookie =");
-    sql.add(cookie);
-    sql.add(";");
-    std::map<std::string, std::vector<std::string>> result = sql.query();
-    if (result.empty()) return std::string();
-    std::string username = result["username"][0];
-    if (const int stamp = filter::string::convert_to_int(result["timestamp"][0]);
-        stamp != timestamp())
+    daily = false;
+    const int now = filter::date::get_seconds_since_epoch();
+    std::unique_lock lock(cache_mutex);
+    auto iter = cache.find(cookie);
+    if ((iter == cache.end()) || (iter->second.expiry < now))
     {
-        // Touch the timestamp. This occurs once a day.
-        const int row_id = filter::string::convert_to_int(result["rowid"][0]);
-        sql.clear();
-        sql.add("UPDATE logins SET timestamp =");
-        sql.add(timestamp());
-        sql.add("WHERE rowid =");
-        sql.add(row_id);
-        sql.execute();
-        daily = true;
+        const unsigned int generation = cache_generation;
+        lock.unlock();
+        SqliteDatabase sql(database());
+        sql.add("SELECT timestamp, username, touch FROM logins WHERE cookie =");
+        sql.add(cookie);
+        sql.add(";");
+        std::map<std::string, std::vector<std::string>> result = sql.query();
+        lock.lock();
+        if (result["username"].empty())
+        {
+            if (generation == cache_generation)
+                cache.erase(cookie);
+            return std::string();
+        }
+        Login login {
+            .username = result["username"][0],
+            .touch = filter::string::convert_to_bool(result["touch"][0]),
+            .timestamp = filter::string::convert_to_int(result["timestamp"][0]),
+            .expiry = now + cache_seconds
+        };
+        // A timestamp still to be written is more recent than the one in the database.
+        if (pending_timestamps.contains(cookie))
+            login.timestamp = timestamp();
+        // If logins were removed meanwhile, this one may be outdated, so it is not cached.
+        if (generation != cache_generation)
+            return login.username;
+        iter = cache.insert_or_assign(cookie, std::move(login)).first;
     }
-    else
+    if (iter->second.timestamp != timestamp())
     {
-        daily = false;
+        // Touch the timestamp. This occurs once a day.
+        iter->second.timestamp = timestamp();
+        pending_timestamps.insert(cookie);
+        daily = true;
     }
-    return username;
+    return iter->second.username;
 }
 
 
 // Returns whether the device, that matches the cookie it sent, is touch-enabled.
 bool get_touch_enabled(const std::string& cookie)
 {
+    {
+        std::lock_guard lock(cache_mutex);
+        if (const auto iter = cache.find(cookie); iter != cache.cend())
+            return iter->second.touch;
+    }
     SqliteDatabase sql(database());
     sql.add("SELECT touch FROM logins WHERE cookie =");
     sql.add(cookie);
@@ -215,8 +294,48 @@ bool get_touch_enabled(const std::string& cookie)
 }
 
 
+// Writes the timestamps of the logins used today to the database.
+void write_timestamps()
+{
+    std::set<std::string> cookies {};
+    {
+        std::lock_guard lock(cache_mutex);
+        cookies.swap(pending_timestamps);
+    }
+    if (cookies.empty())
+        return;
+    SqliteDatabase sql(database());
+    sql.set_sql("BEGIN;");
+    sql.execute();
+    for (const auto& cookie : cookies)
+    {
+        sql.clear();
+        sql.add("UPDATE logins SET timestamp =");
+        sql.add(timestamp());
+        sql.add("WHERE cookie =");
+        sql.add(cookie);
+        sql.add(";");
+        sql.execute();
+    }
+    sql.set_sql("COMMIT;");
+    sql.execute();
+}
+
+
+// Clears the logins cached in memory, and forgets the timestamps still to be written.
+void clear_cache()
+{
+    std::lock_guard lock(cache_mutex);
+    cache.clear();
+    pending_timestamps.clear();
+    cache_generation++;
+}
+
+
 void test_timestamp()
 {
+    write_timestamps();
+    clear_cache();
     SqliteDatabase sql(database());
     sql.add("UPDATE logins SET timestamp = timestamp - 370;");
     sql.execute();
@@ -34,6 +34,8 @@ void remove_tokens (const std::string& username, const std::string& cookie);
 void rename_tokens (const std::string& username_existing, const std::string& username_new, const std::string& cookie);
 std::string get_username (const std::string& cookie, bool & daily);
 bool get_touch_enabled (const std::string& cookie);
+void write_timestamps ();
+void clear_cache ();
 void test_timestamp ();
 
 }
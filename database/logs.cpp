@@ -30,7 +30,366 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 // 2. Android has VACUUM errors due to a locked database.
 
 
+// The journal is stored in append-only segment files in the logbook folder.
+// Earlier versions stored one file per entry, which took a file open, write and close per entry,
+// a full directory scan for every poll of the journal page, and a lot of inodes.
+// A segment is named after the key of its first entry, with the ".log" suffix.
+// Each record in a segment consists of a header line with the key and the size of the entry,
+// followed by the entry itself and a new line.
+// The entry is the level, a space, and the description.
+// The key is the number of seconds since the Unix epoch,
+// followed by the number of microseconds within the second, padded to 8 digits.
+// Sample key: "146495380700927147".
+// An index of all entries, plus the text of the most recent entries, is kept in memory.
+
+
 namespace database::logs {
+
+
+namespace {
+
+
+// When a segment is larger than this, a new segment gets started.
+constexpr off_t segment_size_limit {1'000'000};
+
+
+// The number of most recent entries whose text is kept in memory.
+constexpr size_t tail_size {500};
+
+
+constexpr const char* segment_suffix {".log"};
+
+
+struct Entry final
+{
+    std::string key {};
+    std::string segment {};
+    off_t offset {0};
+    size_t size {0};
+    // The text of the entry if it is in the tail, else empty.
+    std::string text {};
+};
+
+
+struct Journal final
+{
+    std::mutex mutex {};
+    bool loaded {false};
+    // All entries, sorted on their keys.
+    std::vector<Entry> entries {};
+    // The segment being appended to, its file descriptor, and its known size.
+    std::string segment {};
+    int fd {-1};
+    off_t end {0};
+    // Changes when the journal gets loaded, rotated, or cleared.
+    // This detects that happening while the lock was released for reading the disk.
+    unsigned int generation {0};
+};
+
+
+Journal journal {};
+
+
+// The index of the journal as read from the logbook folder.
+struct Index final
+{
+    std::vector<Entry> entries {};
+    std::vector<std::string> segments {};
+    // The number of bytes parsed in the last segment.
+    off_t end {0};
+    // The keys and the texts of the entries stored by earlier versions.
+    std::vector<std::pair<std::string, std::string>> legacy_entries {};
+};
+
+
+// Whether a file in the logbook folder is an entry as stored by earlier versions of Bibledit.
+bool is_legacy_entry(const std::string& file)
+{
+    return !file.empty() && std::all_of(file.cbegin(), file.cend(), ::isdigit);
+}
+
+
+void sort_entries(std::vector<Entry>& entries)
+{
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.key < b.key; });
+}
+
+
+void close_segment()
+{
+    if (journal.fd >= 0)
+        close(journal.fd);
+    journal.fd = -1;
+    journal.segment.clear();
+    journal.end = 0;
+}
+
+
+// Keeps the text of the most recent entries only.
+void trim_tail(std::vector<Entry>& entries)
+{
+    if (entries.size() > tail_size)
+    {
+        Entry& entry = entries[entries.size() - tail_size - 1];
+        std::string().swap(entry.text);
+    }
+}
+
+
+// Parses the records in $data, which starts at $offset in $segment, and adds them to $entries.
+// Returns the number of bytes parsed, which excludes an incomplete record at the end.
+size_t parse_records(const std::string& segment, const std::string& data, const off_t offset, std::vector<Entry>& entries)
+{
+    size_t position {0};
+    while (position < data.size())
+    {
+        const size_t newline = data.find('\n', position);
+        if (newline == std::string::npos)
+            break;
+        const std::vector<std::string> header = filter::string::explode(data.substr(position, newline - position), ' ');
+        if (header.size() != 2)
+            break;
+        const size_t size = static_cast<size_t>(filter::string::convert_to_int(header[1]));
+        const size_t start = newline + 1;
+        if (start + size + 1 > data.size())
+            break;
+        Entry entry {
+            .key = header[0],
+            .segment = segment,
+            .offset = offset + static_cast<off_t>(start),
+            .size = size,
+            .text = data.substr(start, size)
+        };
+        entries.push_back(std::move(entry));
+        trim_tail(entries);
+        position = start + size + 1;
+    }
+    return position;
+}
+
+
+// Reads the records appended to the current segment since its known size.
+void read_appended_records()
+{
+    std::ifstream file(filter_url_create_path({folder(), journal.segment}), std::ios::binary);
+    file.seekg(journal.end);
+    const std::string data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    const size_t count = journal.entries.size();
+    journal.end += static_cast<off_t>(parse_records(journal.segment, data, journal.end, journal.entries));
+    // Entries written by other processes may be out of order.
+    if (!std::is_sorted(journal.entries.cbegin() + static_cast<std::ptrdiff_t>(count > 0 ? count - 1 : 0), journal.entries.cend(),
+                        [](const Entry& a, const Entry& b) { return a.key < b.key; }))
+        sort_entries(journal.entries);
+}
+
+
+// Writes one record to the current segment.
+bool write_record(const std::string& key, const std::string& text)
+{
+    std::string record = key + " " + std::to_string(text.size()) + "\n";
+    const size_t header_size = record.size();
+    record.append(text);
+    record.append("\n");
+    if (write(journal.fd, record.data(), record.size()) != static_cast<ssize_t>(record.size()))
+        return false;
+    // Other processes may append to the segment too.
+    // The segment is opened for appending, so after the write, the file offset is just past this record.
+    const off_t end = lseek(journal.fd, 0, SEEK_CUR);
+    if ((end >= 0) && (end - static_cast<off_t>(record.size()) != journal.end))
+    {
+        // Another process wrote to the segment after it was last read.
+        // Read its records together with this one.
+        read_appended_records();
+        return true;
+    }
+    journal.entries.push_back(Entry {
+        .key = key,
+        .segment = journal.segment,
+        .offset = journal.end + static_cast<off_t>(header_size),
+        .size = text.size(),
+        .text = text
+    });
+    trim_tail(journal.entries);
+    journal.end += static_cast<off_t>(record.size());
+    return true;
+}
+
+
+void open_segment(const std::string& segment)
+{
+    close_segment();
+    const std::string path = filter_url_create_path({folder(), segment});
+    journal.fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+    if (journal.fd < 0)
+        return;
+    journal.segment = segment;
+    struct stat status {};
+    if (fstat(journal.fd, &status) == 0)
+        journal.end = status.st_size;
+}
+
+
+// Reads the index of the journal from the segments in the logbook folder.
+// This does not touch the journal in memory, so it runs without holding the lock.
+Index read_index()
+{
+    Index index {};
+    const std::string directory = folder();
+    for (const auto& file : filter_url_scandir(directory))
+    {
+        const std::string path = filter_url_create_path({directory, file});
+        const std::string extension = filter_url_get_extension(file);
+        if (extension == "log")
+            index.segments.push_back(file);
+        // A rotation that got interrupted leaves a temporary segment behind.
+        // The rotation renames it into place before it removes the older segments,
+        // so its entries are still in those older segments.
+        else if (extension == "tmp")
+            filter_url_unlink(path);
+        else if (is_legacy_entry(file))
+            index.legacy_entries.emplace_back(file, filter_url_file_get_contents(path));
+    }
+    for (const auto& segment : index.segments)
+    {
+        const std::string data = filter_url_file_get_contents(filter_url_create_path({directory, segment}));
+        index.end = static_cast<off_t>(parse_records(segment, data, 0, index.entries));
+    }
+    sort_entries(index.entries);
+    // A rotation that got interrupted after renaming the new segment into place
+    // leaves older segments behind with the same entries.
+    const auto duplicates = std::unique(index.entries.begin(), index.entries.end(),
+                                        [](const Entry& a, const Entry& b) { return a.key == b.key; });
+    index.entries.erase(duplicates, index.entries.end());
+    return index;
+}
+
+
+// Puts the index read from the logbook folder in place.
+// Entries stored by earlier versions of Bibledit, one per file, are moved into a segment.
+void install(Index& index)
+{
+    close_segment();
+    journal.entries = std::move(index.entries);
+    if (!index.segments.empty())
+    {
+        open_segment(index.segments.back());
+        // Records appended after the index was read get read on the next synchronization.
+        journal.end = index.end;
+    }
+    journal.loaded = true;
+    journal.generation++;
+    for (const auto& [file, text] : index.legacy_entries)
+    {
+        if (journal.fd < 0)
+            open_segment(file + segment_suffix);
+        if (journal.fd >= 0 && write_record(file, text))
+            filter_url_unlink(filter_url_create_path({folder(), file}));
+    }
+    if (!index.legacy_entries.empty())
+        sort_entries(journal.entries);
+}
+
+
+// Whether the segments on disk were replaced or removed, so the index has to be read again.
+bool outdated()
+{
+    if (!journal.loaded)
+        return true;
+    if (journal.fd < 0)
+        return false;
+    struct stat status {};
+    return (fstat(journal.fd, &status) != 0) || (status.st_nlink == 0);
+}
+
+
+// Whether another process may have started a new segment.
+// A process does that when there was none, or when the current one was full.
+bool may_have_new_segment()
+{
+    if (journal.fd < 0)
+        return true;
+    struct stat status {};
+    return (fstat(journal.fd, &status) == 0) && (status.st_size > segment_size_limit);
+}
+
+
+// Brings the index in memory up to date with the segments on disk.
+// This deals with the logbook being cleared or replaced from outside,
+// and with entries and segments added by other processes.
+// It reads the folder and the segments with the lock released,
+// so other threads can go on logging meanwhile.
+void synchronize(std::unique_lock<std::mutex>& lock)
+{
+    while (true)
+    {
+        const unsigned int generation = journal.generation;
+        if (outdated())
+        {
+            lock.unlock();
+            Index index = read_index();
+            lock.lock();
+            // If another thread loaded, rotated or cleared the journal meanwhile, check again.
+            if (journal.generation == generation)
+                install(index);
+            continue;
+        }
+        if (may_have_new_segment())
+        {
+            const std::string segment = journal.segment;
+            lock.unlock();
+            std::vector<std::string> segments = filter_url_scandir(folder());
+            lock.lock();
+            const bool newer = std::any_of(segments.cbegin(), segments.cend(), [&segment](const std::string& file) {
+                return (filter_url_get_extension(file) == "log") && (file > segment);
+            });
+            if (newer && (journal.generation == generation) && (journal.segment == segment))
+            {
+                journal.loaded = false;
+                continue;
+            }
+        }
+        break;
+    }
+    if (journal.fd < 0)
+        return;
+    struct stat status {};
+    if ((fstat(journal.fd, &status) == 0) && (status.st_size > journal.end))
+        read_appended_records();
+}
+
+
+// Gets the text of an entry, from memory if it is in the tail, else from its segment.
+std::string read_text(const Entry& entry)
+{
+    if (!entry.text.empty())
+        return entry.text;
+    std::ifstream file(filter_url_create_path({folder(), entry.segment}), std::ios::binary);
+    file.seekg(entry.offset);
+    std::string text(entry.size, '\0');
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    text.resize(static_cast<size_t>(file.gcount()));
+    return text;
+}
+
+
+// Returns a key that is unique and more recent than the most recent entry.
+std::string new_key()
+{
+    const std::string seconds = std::to_string(filter::date::get_seconds_since_epoch());
+    std::string key = seconds + filter::string::fill(std::to_string(filter::date::get_microseconds_within_second()), 8, '0');
+    // The microseconds granularity depends on the platform.
+    // On Windows it is lower than on Linux.
+    // Ensure the key is more recent than the last one.
+    if (!journal.entries.empty() && key <= journal.entries.back().key)
+        key = std::to_string(std::stoll(journal.entries.back().key) + 1);
+    return key;
+}
+
+
+} // Namespace.
+
+
 // The folder where to store the records.
 std::string folder()
 {
@@ -54,23 +413,17 @@ void log(std::string description, const int level)
         description.append ("... This entry was too large and has been truncated: " + std::to_string(length) + " bytes");
     }
 
-    // Save this logbook entry to a filename with seconds and microseconds.
-    const std::string seconds = std::to_string(filter::date::get_seconds_since_epoch());
-    const std::string time = seconds + filter::string::fill(std::to_string(filter::date::get_microseconds_within_second()), 8, '0');
-    const std::string file = filter_url_create_path({folder(), time});
-    // The microseconds granularity depends on the platform.
-    // On Windows it is lower than on Linux.
-    // There may be the rare case of more than one entry per file.
-    // Append the data so it won't overwrite an earlier entry.
-    if (file_or_dir_exists(file))
-        description.insert(0, " | ");
-    else
-        description.insert(0, std::to_string(level) + " ");
-    filter_url_file_put_contents_append(file, description);
-#ifdef HAVE_WINDOWS
-    // Delay to cover for lower usec granularity on Windows.
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-#endif
+    description.insert(0, std::to_string(level) + " ");
+
+    // Append the entry to the current segment.
+    // The segment stays open, so this costs one write only.
+    std::unique_lock lock(journal.mutex);
+    synchronize(lock);
+    const std::string key = new_key();
+    if ((journal.fd < 0) || (journal.end > segment_size_limit))
+        open_segment(key + segment_suffix);
+    if (journal.fd >= 0)
+        write_record(key, description);
 }
 
 
@@ -84,59 +437,94 @@ void log(std::string subject, const std::string& body, const int level)
 }
 
 
+// Removes expired and filtered entries from the journal, and rewrites what remains into a new segment.
 void rotate()
 {
-    std::string directory = folder();
-    std::vector<std::string> files = filter_url_scandir(directory);
+    bool filtered_entries = false;
+    {
+        std::unique_lock lock(journal.mutex);
+        synchronize(lock);
 
 
-    // Timestamp for removing older records, depending on whether it's a tiny journal.
+        // Timestamp for removing older records, depending on whether it's a tiny journal.
 #ifdef HAVE_TINY_JOURNAL
-    const int old_timestamp = filter::date::get_seconds_since_epoch() - 14400;
+        const int old_timestamp = filter::date::get_seconds_since_epoch() - 14400;
 #else
-    const int old_timestamp = filter::date::get_seconds_since_epoch() - 6 * 86400;
+        const int old_timestamp = filter::date::get_seconds_since_epoch() - 6 * 86400;
 #endif
 
 
-    // Limit the journal entry count in the filesystem.
-    // This speeds up subsequent reading of the journal by the users.
-    // In previous versions of Bibledit, there were certain conditions
-    // that led to an infinite loop, as had been noticed at times,
-    // and this quickly exhausted the available inodes on the filesystem.
+        // Limit the journal entry count.
+        // This speeds up subsequent reading of the journal by the users.
+        // In previous versions of Bibledit, there were certain conditions
+        // that led to an infinite loop, as had been noticed at times,
+        // and this quickly exhausted the available inodes on the filesystem.
 #ifdef HAVE_TINY_JOURNAL
-    const int limit_file_count = static_cast<int>(files.size() - 200);
+        const int limit_entry_count = static_cast<int>(journal.entries.size()) - 200;
 #else
-    const int limit_file_count = static_cast<int>(files.size() - 2000);
+        const int limit_entry_count = static_cast<int>(journal.entries.size()) - 2000;
 #endif
 
 
-    bool filtered_entries = false;
-    for (unsigned int i = 0; i < files.size(); ++i)
-    {
-        const std::string path = filter_url_create_path({directory, files.at(i)});
-
-        // Limit the number of journal entries.
-        if (static_cast<int>(i) < limit_file_count)
+        std::vector<std::pair<std::string, std::string>> remaining {};
+        for (unsigned int i = 0; i < journal.entries.size(); ++i)
         {
-            filter_url_unlink(path);
-            continue;
+            const Entry& entry = journal.entries[i];
+
+            // Limit the number of journal entries.
+            if (static_cast<int>(i) < limit_entry_count)
+                continue;
+
+            // Remove expired entries.
+            if (const int timestamp = filter::string::convert_to_int(entry.key.substr(0, 10));
+                timestamp < old_timestamp)
+                continue;
+
+            // Filtering of certain entries.
+            std::string text = read_text(entry);
+            if (journal_logic_filter_entry(text))
+            {
+                filtered_entries = true;
+                continue;
+            }
+
+            remaining.emplace_back(entry.key, std::move(text));
         }
 
-        // Remove expired entries.
-        if (const int timestamp = filter::string::convert_to_int(files[i].substr(0, 10));
-            timestamp < old_timestamp)
-        {
-            filter_url_unlink(path);
-            continue;
-        }
 
-        // Filtering of certain entries.
-        if (const std::string entry = filter_url_file_get_contents(path);
-            journal_logic_filter_entry(entry))
+        // Write the remaining entries to a new segment, and remove the older segments.
+        // The new segment is renamed into place first, so if this gets interrupted,
+        // all entries are still in the segments.
+        std::vector<std::string> segments {};
+        for (const auto& file : filter_url_scandir(folder()))
+            if (filter_url_get_extension(file) == "log")
+                segments.push_back(file);
+        close_segment();
+        journal.entries.clear();
+        if (!remaining.empty())
         {
-            filtered_entries = true;
-            filter_url_unlink(path);
+            const std::string segment = remaining.front().first + segment_suffix;
+            const std::string temporary = segment + ".tmp";
+            const std::string temporary_path = filter_url_create_path({folder(), temporary});
+            filter_url_unlink(temporary_path);
+            open_segment(temporary);
+            for (const auto& [key, text] : remaining)
+                write_record(key, text);
+            close_segment();
+            filter_url_rename(temporary_path, filter_url_create_path({folder(), segment}));
+            // If renaming failed, the older segments stay.
+            if (file_or_dir_exists(temporary_path))
+            {
+                filter_url_unlink(temporary_path);
+                segments.clear();
+            }
+            segments.erase(std::remove(segments.begin(), segments.end(), segment), segments.end());
         }
+        for (const auto& file : segments)
+            filter_url_unlink(filter_url_create_path({folder(), file}));
+        // The next access reads the new segment.
+        journal.loaded = false;
+        journal.generation++;
     }
 
     if (filtered_entries)
@@ -147,18 +535,17 @@ void rotate()
 // Get the logbook entries.
 std::vector<std::string> get(std::string& last_filename)
 {
+    std::unique_lock lock(journal.mutex);
+    synchronize(lock);
     last_filename = "0";
-
-    // Read the journal records from the filesystem.
-    const std::vector<std::string> files = filter_url_scandir(folder());
-    for (const auto & file : filter_url_scandir(folder()))
-    {
-        // Last second gets updated based on the filename.
-        last_filename = file;
-    }
-
-    // Done.
-    return files;
+    std::vector<std::string> keys {};
+    keys.reserve(journal.entries.size());
+    for (const auto& entry : journal.entries)
+        keys.push_back(entry.key);
+    // Last second gets updated based on the most recent entry.
+    if (!keys.empty())
+        last_filename = keys.back();
+    return keys;
 }
 
 
@@ -166,26 +553,47 @@ std::vector<std::string> get(std::string& last_filename)
 // Updates "filename" to the item it got.
 std::string next(std::string& filename)
 {
-    for (const auto & file : filter_url_scandir(folder()))
-    {
-        if (file > filename)
-        {
-            filename = file;
-            return file;
-        }
-    }
-    return {};
+    std::unique_lock lock(journal.mutex);
+    synchronize(lock);
+    const auto iter = std::upper_bound(journal.entries.cbegin(), journal.entries.cend(), filename,
+                                       [](const std::string& key, const Entry& entry) { return key < entry.key; });
+    if (iter == journal.entries.cend())
+        return {};
+    filename = iter->key;
+    return filename;
+}
+
+
+// Gets the journal entry with the key in "filename": The level, a space, and the description.
+std::string get_entry(const std::string& filename)
+{
+    std::unique_lock lock(journal.mutex);
+    synchronize(lock);
+    const auto iter = std::lower_bound(journal.entries.cbegin(), journal.entries.cend(), filename,
+                                       [](const Entry& entry, const std::string& key) { return entry.key < key; });
+    if ((iter == journal.entries.cend()) || (iter->key != filename))
+        return {};
+    return read_text(*iter);
 }
 
 
 // Clears all journal entries.
 void clear()
 {
-    for (const std::string directory = folder();
-        const auto& file : filter_url_scandir(directory))
     {
-        filter_url_unlink(filter_url_create_path({directory, file}));
+        std::lock_guard lock(journal.mutex);
+        close_segment();
+        journal.entries.clear();
+        for (const std::string directory = folder();
+            const auto& file : filter_url_scandir(directory))
+        {
+            filter_url_unlink(filter_url_create_path({directory, file}));
+        }
+        journal.loaded = true;
+        journal.generation++;
     }
     log("The journal was cleared");
 }
+
+
 }
@@ -29,6 +29,7 @@ void log (std::string subject, const std::string& body, int level = 5);
 void rotate ();
 std::vector <std::string> get (std::string & last_filename);
 std::string next (std::string &filename);
+std::string get_entry (const std::string& filename);
 void clear ();
 
 }
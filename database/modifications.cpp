@@ -286,8 +286,8 @@ std::vector <int> getTeamDiffChapters (const std::string& bible, int book)
   std::string pattern = bible + "." + std::to_string (book) + ".";
   size_t length = pattern.length ();
   std::vector <int> chapters;
-  std::vector <std::string> files = filter_url_scandir (teamFolder ());
-  for (auto & file : files) {
+  const auto files = filter_url_scandir_shared (teamFolder ());
+  for (const auto& file : *files) {
     if (file.substr (0, length) != pattern) continue;
     std::vector <std::string> bits = filter::string::explode (file, '.');
     filter::string::implode_from_beginning_remain_with_max_n_bits (bits, 3, ".");
@@ -317,8 +317,8 @@ int getTeamDiffCount (const std::string& bible)
   std::string pattern = bible + ".";
   size_t length = pattern.length ();
   int count = 0;
-  std::vector <std::string> files = filter_url_scandir (teamFolder ());
-  for (auto & file : files) {
+  const auto files = filter_url_scandir_shared (teamFolder ());
+  for (const auto& file : *files) {
     if (file.substr (0, length) != pattern) continue;
     count++;
   }
@@ -333,8 +333,8 @@ std::vector <int> getTeamDiffBooks (const std::string& bible)
   std::vector <int> books;
   const std::string pattern = bible + ".";
   const size_t length = pattern.length ();
-  const std::vector <std::string> files = filter_url_scandir (teamFolder ());
-  for (const auto& file : files) {
+  const auto files = filter_url_scandir_shared (teamFolder ());
+  for (const auto& file : *files) {
     if (file.substr (0, length) != pattern) continue;
     std::vector <std::string> bits = filter::string::explode (file, '.');
     filter::string::implode_from_beginning_remain_with_max_n_bits (bits, 3, ".");
@@ -353,8 +353,8 @@ std::vector <int> getTeamDiffBooks (const std::string& bible)
 std::vector <std::string> getTeamDiffBibles ()
 {
   std::vector <std::string> bibles;
-  std::vector <std::string> files = filter_url_scandir (teamFolder ());
-  for (auto & file : files) {
+  const auto files = filter_url_scandir_shared (teamFolder ());
+  for (const auto& file : *files) {
     std::vector <std::string> bits = filter::string::explode (file, '.');
     filter::string::implode_from_beginning_remain_with_max_n_bits (bits, 3, ".");
     if (bits.size() != 3) continue;
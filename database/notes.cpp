@@ -456,7 +456,7 @@ void Database_Notes::set_identifier(int identifier, int new_identifier)
     path = note_file(new_identifier);
     std::string folder = filter_url_dirname(path);
     filter_url_mkdir(folder);
-    filter_url_file_put_contents(path, json);
+    filter_url_file_put_contents_durable(path, json);
 
     // Update main notes database.
     {
@@ -589,7 +589,7 @@ int Database_Notes::store_new_note(const NewNote& new_note)
         {contents_key(), contents},
     });
     std::string json = note.dump(4);
-    filter_url_file_put_contents(path, json);
+    filter_url_file_put_contents_durable(path, json);
 
     // Store new default note into the database.
     {
@@ -1943,7 +1943,7 @@ std::vector<std::string> Database_Notes::set_bulk(std::string json)
                 {severity_key(), std::to_string(severity)},
             });
             std::string json2 = note2.dump(4);
-            filter_url_file_put_contents(path, json2);
+            filter_url_file_put_contents_durable(path, json2);
 
             // Update the indexes.
             update_database(identifier);
@@ -1986,7 +1986,7 @@ void Database_Notes::set_field(const int identifier, const std::string& key, con
         nlohmann::json note = nlohmann::json::parse(json);
         note[key] = value;
         json = note.dump(4);
-        filter_url_file_put_contents(file, json);
+        filter_url_file_put_contents_durable(file, json);
     }
     catch (...) { }
 }
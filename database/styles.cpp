@@ -43,9 +43,14 @@ constexpr const auto database_name {"styles"};
 static std::string databasefolder ();
 static std::string sheetfolder (const std::string& sheet);
 
-// Styles cache and lock.
-std::map<std::string,std::list<stylesv2::Style>> sheet_cache;
+// The published snapshots of the stylesheets, and the lock.
+// A snapshot that gets replaced stays alive for as long as anyone still holds it.
+std::map<std::string,std::shared_ptr<const snapshot>> snapshots;
 std::mutex cache_mutex;
+// The version given to the most recently started compilation of a snapshot.
+unsigned int snapshot_version {0};
+// Snapshots with this version or older were compiled before the snapshots were dropped.
+unsigned int dropped_version {0};
 // Style file suffix.
 constexpr const char* style_file_suffix {"conf"};
 // Style file keys.
@@ -78,7 +83,8 @@ constexpr const std::string_view category_key {"category"};
 
 // Forward declarations of local functions.
 static std::string style_file (const std::string& sheet, const std::string& marker);
-static void ensure_sheet_in_cache(const std::string& sheet);
+static std::list<stylesv2::Style> compile_sheet(const std::string& sheet);
+static std::shared_ptr<const snapshot> publish_snapshot(const std::string& sheet);
 static std::string add_space(const std::string_view key);
 static std::vector<std::string> get_updated_markers (const std::string& sheet);
 
@@ -134,7 +140,9 @@ void delete_sheet (const std::string& sheet)
 {
   if (!sheet.empty ()) {
     filter_url_rmdir (sheetfolder (sheet));
-    sheet_cache.clear();
+    std::unique_lock lock (cache_mutex);
+    snapshots.erase(sheet);
+    dropped_version = snapshot_version;
   }
 }
 
@@ -190,38 +198,96 @@ static std::string style_file (const std::string& sheet, const std::string& mark
 }
 
 
-// Ensure sheet cache has been filled.
-static void ensure_sheet_in_cache(const std::string& sheet)
+// Compiles the styles of a sheet:
+// The hard-coded default styles, with any updated or deleted or added styles applied.
+static std::list<stylesv2::Style> compile_sheet(const std::string& sheet)
 {
-  // Check whether the requested stylesheet is already in the cache.
-  // If so: Ready.
-  {
-    const auto iter = sheet_cache.find(sheet);
-    if (iter != sheet_cache.cend())
-      return;
-  }
-  // The sheet is not in the cache at this point.
-  
-  // Create enmpty cache for the sheet.
-  sheet_cache[sheet].clear();
-  std::list<stylesv2::Style>& cache {sheet_cache.at(sheet)};
+  // Copy the hard-coded default stylesheet.
+  std::list<stylesv2::Style> styles {stylesv2::styles};
   
-  // Copy the hard-coded default stylesheet to the cache.
-  for (const auto& style : stylesv2::styles)
-    cache.push_back(style);
-  
-  // Update the cache with any updated or deleted or added styles.
+  // Update the styles with any updated or deleted or added styles.
   const std::vector<std::string> updated_markers {get_updated_markers (sheet)};
   for (const auto& marker : updated_markers) {
     // Since there's an update, remove the existing style.
-    auto iter = std::ranges::find(cache, marker, &stylesv2::Style::marker);
-    if (iter != cache.cend())
-      cache.erase(iter);
-    // Get the updated style. If one is given, add it to the cache.
+    auto iter = std::ranges::find(styles, marker, &stylesv2::Style::marker);
+    if (iter != styles.cend())
+      styles.erase(iter);
+    // Get the updated style. If one is given, add it.
     std::optional<stylesv2::Style> style = load_style(sheet, marker);
     if (style)
-      cache.push_back(std::move(style.value()));
+      styles.push_back(std::move(style.value()));
+  }
+  
+  return styles;
+}
+
+
+// Compiles a new snapshot of a sheet and publishes it, and returns it.
+// The sheet is compiled without holding the lock.
+// A compilation started later sees all changes made before it started,
+// so a snapshot only replaces one with an older version.
+static std::shared_ptr<const snapshot> publish_snapshot(const std::string& sheet)
+{
+  unsigned int version {0};
+  {
+    std::unique_lock lock (cache_mutex);
+    version = ++snapshot_version;
+  }
+  auto compiled = std::make_shared<const snapshot>(compile_sheet(sheet), version);
+  std::unique_lock lock (cache_mutex);
+  if (version <= dropped_version)
+    return compiled;
+  auto& published = snapshots[sheet];
+  if (!published or (published->version() < version))
+    published = std::move(compiled);
+  return published;
+}
+
+
+snapshot::snapshot (std::list<stylesv2::Style> styles, const unsigned int version) :
+m_styles (std::move(styles)),
+m_version (version)
+{
+  // The list does not move its elements, so the index can point into it.
+  // If a marker occurs more than once, the first style is the one found.
+  for (const stylesv2::Style& style : m_styles)
+    m_markers.emplace(style.marker, std::addressof(style));
+}
+
+
+// Returns the style of a marker, or nullptr if the sheet has no such marker.
+const stylesv2::Style* snapshot::find (const std::string_view marker) const
+{
+  if (const auto iter = m_markers.find(marker); iter != m_markers.cend())
+    return iter->second;
+  return nullptr;
+}
+
+
+// Returns the current snapshot of a stylesheet.
+// The snapshot remains valid for as long as it is held, also after a style in the sheet is changed.
+std::shared_ptr<const snapshot> get_snapshot (const std::string& sheet)
+{
+  // The standard stylesheet is hard-coded and never changes.
+  if (sheet == stylesv2::standard_sheet()) {
+    static const std::shared_ptr<const snapshot> standard {std::make_shared<const snapshot>(stylesv2::styles, 0)};
+    return standard;
   }
+  {
+    std::unique_lock lock (cache_mutex);
+    if (const auto iter = snapshots.find(sheet); iter != snapshots.cend())
+      return iter->second;
+  }
+  return publish_snapshot(sheet);
+}
+
+
+// Drops the snapshots, so they get compiled again from the files on disk.
+void clear_snapshots ()
+{
+  std::unique_lock lock (cache_mutex);
+  snapshots.clear();
+  dropped_version = snapshot_version;
 }
 
 
@@ -279,9 +345,8 @@ void delete_marker (const std::string& sheet, const std::string& marker)
   if (iter == stylesv2::styles.cend()) {
     reset_marker(sheet, marker);
   }
-  // Clear the sheet cache.
-  std::unique_lock lock (cache_mutex);
-  sheet_cache.clear();
+  // Publish the changed sheet.
+  publish_snapshot(sheet);
 }
 
 
@@ -291,23 +356,17 @@ void reset_marker (const std::string& sheet, const std::string& marker)
   // Remove the file for this marker: This means the marker does not have changes compared to the default style.
   const std::string filename = style_file (sheet, marker);
   filter_url_unlink(filename);
-  // Clear the sheet cache.
-  std::unique_lock lock (cache_mutex);
-  sheet_cache.clear();
+  // Publish the changed sheet.
+  publish_snapshot(sheet);
 }
 
 
-const std::list<stylesv2::Style>& get_styles(const std::string& sheet)
+// Returns the styles in the current snapshot of the sheet.
+// The pointer shares the ownership of the snapshot, so the styles remain valid for as long as it is held.
+std::shared_ptr<const std::list<stylesv2::Style>> get_styles(const std::string& sheet)
 {
-  // If the standard stylesheet is requested, return a reference to the standard hard-coded stylesheet.
-  if (sheet == stylesv2::standard_sheet())
-    return stylesv2::styles;
-
-  // Make sure the stylesheet has been cached.
-  ensure_sheet_in_cache (sheet);
-
-  // Return a reference to tne sheet from the cache.
-  return sheet_cache.at(sheet);
+  const std::shared_ptr<const snapshot> current {get_snapshot(sheet)};
+  return std::shared_ptr<const std::list<stylesv2::Style>>(current, std::addressof(current->styles()));
 }
 
 
@@ -315,8 +374,8 @@ const std::list<stylesv2::Style>& get_styles(const std::string& sheet)
 std::vector <std::string> get_markers (const std::string& sheet)
 {
   std::vector <std::string> markers;
-  const std::list<stylesv2::Style>& styles {get_styles(sheet)};
-  std::transform(styles.begin(), styles.end(), std::back_inserter(markers), [](const stylesv2::Style& style) {
+  const auto styles {get_styles(sheet)};
+  std::transform(styles->begin(), styles->end(), std::back_inserter(markers), [](const stylesv2::Style& style) {
     return style.marker;
   });
   return markers;
@@ -327,23 +386,21 @@ std::vector <std::string> get_markers (const std::string& sheet)
 std::map <std::string, std::string> get_markers_and_names (const std::string& sheet)
 {
   std::map <std::string, std::string> markers_names;
-  const std::list<stylesv2::Style>& styles {get_styles(sheet)};
-  std::transform(styles.begin(), styles.end(), std::inserter(markers_names, markers_names.end()), [](const stylesv2::Style& style) {
+  const auto styles {get_styles(sheet)};
+  std::transform(styles->begin(), styles->end(), std::inserter(markers_names, markers_names.end()), [](const stylesv2::Style& style) {
     return std::make_pair(style.marker, style.name);
   });
   return markers_names;
 }
 
 
-// Returns a pointer to a style object with all data belonging to a marker.
-const stylesv2::Style* get_marker_data (const std::string& sheet, const std::string& marker)
+// Returns a pointer to a style object with all data belonging to a marker, or nullptr if there's none.
+// The pointer shares the ownership of the snapshot, so the style remains valid for as long as it is held.
+std::shared_ptr<const stylesv2::Style> get_marker_data (const std::string& sheet, const std::string& marker)
 {
-  // If the requested marker is among the styles in the requested sheet, return that.
-  const std::list<stylesv2::Style>& styles {get_styles(sheet)};
-  const auto iter = std::ranges::find(styles, marker, &stylesv2::Style::marker);
-  if (iter != styles.cend())
-    return std::addressof(*iter);
-  // Style not found.
+  const std::shared_ptr<const snapshot> current {get_snapshot(sheet)};
+  if (const stylesv2::Style* style = current->find(marker); style)
+    return std::shared_ptr<const stylesv2::Style>(current, style);
   return nullptr;
 }
 
@@ -499,9 +556,8 @@ void save_style(const std::string& sheet, const stylesv2::Style& style)
   else
     filter_url_file_put_contents (filename, filter::string::implode (lines, "\n"));
 
-  // A style was saved: Clear the cache.
-  std::unique_lock lock (cache_mutex);
-  sheet_cache.clear();
+  // A style was saved: Publish the changed sheet.
+  publish_snapshot(sheet);
 }
 
 
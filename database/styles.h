@@ -24,6 +24,26 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 namespace database::styles {
 
+
+// A compiled and immutable copy of a stylesheet.
+// When a style gets saved, a new snapshot of its sheet gets published,
+// while anyone still holding the previous snapshot can safely continue using it.
+class snapshot final {
+public:
+  snapshot (std::list<stylesv2::Style> styles, unsigned int version);
+  snapshot (const snapshot&) = delete;
+  snapshot& operator= (const snapshot&) = delete;
+  const std::list<stylesv2::Style>& styles () const { return m_styles; }
+  const stylesv2::Style* find (std::string_view marker) const;
+  unsigned int version () const { return m_version; }
+private:
+  std::list<stylesv2::Style> m_styles {};
+  // The keys refer to the markers of the styles in the list.
+  std::unordered_map<std::string_view, const stylesv2::Style*> m_markers {};
+  unsigned int m_version {0};
+};
+
+
 void create_database ();
 void create_sheet (const std::string& sheet);
 std::vector <std::string> get_sheets ();
@@ -34,11 +54,13 @@ bool has_write_access (const std::string& user, const std::string& sheet);
 void add_marker (const std::string& sheet, const std::string& marker, const std::string& base);
 void delete_marker (const std::string& sheet, const std::string& marker);
 void reset_marker (const std::string& sheet, const std::string& marker);
-const std::list<stylesv2::Style>& get_styles(const std::string& sheet);
+std::shared_ptr<const std::list<stylesv2::Style>> get_styles(const std::string& sheet);
 std::vector <std::string> get_markers (const std::string& sheet);
 std::map <std::string, std::string> get_markers_and_names (const std::string& sheet);
-const stylesv2::Style* get_marker_data (const std::string& sheet, const std::string& marker);
+std::shared_ptr<const stylesv2::Style> get_marker_data (const std::string& sheet, const std::string& marker);
 void save_style(const std::string& sheet, const stylesv2::Style& style);
 std::optional<stylesv2::Style> load_style(const std::string& sheet, const std::string& marker);
+std::shared_ptr<const snapshot> get_snapshot (const std::string& sheet);
+void clear_snapshots ();
 
 } // Namespace
@@ -57,7 +57,7 @@ static std::string chapter_file(const std::string& name, const int book, const i
 
 std::vector<std::string> get_resources()
 {
-    return filter_url_scandir(main_folder());
+    return *filter_url_scandir_shared(main_folder());
 }
 
 
@@ -98,10 +98,10 @@ void store_chapter(const std::string& name, const int book, const int chapter, c
 
 std::vector<int> get_books(const std::string& name)
 {
-    const std::vector<std::string> files = filter_url_scandir(resource_folder(name));
+    const auto files = filter_url_scandir_shared(resource_folder(name));
     std::vector<int> books;
-    books.reserve(files.size());
-    for (auto& book : files)
+    books.reserve(files->size());
+    for (const auto& book : *files)
         books.push_back(filter::string::convert_to_int(book));
     std::ranges::sort(books);
     return books;
@@ -110,10 +110,10 @@ std::vector<int> get_books(const std::string& name)
 
 std::vector<int> get_chapters(const std::string& name, const int book)
 {
-    const std::vector<std::string> folders = filter_url_scandir(book_folder(name, book));
+    const auto folders = filter_url_scandir_shared(book_folder(name, book));
     std::vector<int> chapters;
-    chapters.reserve(folders.size());
-    for (auto& chapter : folders)
+    chapters.reserve(folders->size());
+    for (const auto& chapter : *folders)
         chapters.push_back(filter::string::convert_to_int(chapter));
     std::ranges::sort(chapters);
     return chapters;
@@ -260,6 +260,8 @@ void demo_create_sample_bible ()
     if (!file_or_dir_exists (path)) filter_url_mkdir (path);
     filter_url_file_put_contents (file, data);
   }
+  // The Bible data was written straight to disk.
+  database::bibles::clear_index ();
   
   database::logs::log ("Sample Bible was created");
 }
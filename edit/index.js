@@ -221,6 +221,7 @@ function editorLoadChapter ()
   editorLoadedBook = editorNavigationBook;
   editorLoadedChapter = editorNavigationChapter;
   editorChapterIdOnServer = 0;
+  edit2ChapterRevision = 0;
   edit2CaretPosition = getCaretPosition ();
   edit2CaretInitialized = false;
   var url = "load?" + new URLSearchParams([["bible", editorLoadedBible], ["book", editorLoadedBook], ["chapter", editorLoadedChapter], ["id", chapterEditorUniqueID]]).toString();
@@ -300,6 +301,7 @@ function editSaveChapter (synchronous)
   editorStatus (editorChapterSaving);
   editorReferenceText = html;
   editorChapterIdOnServer = 0;
+  edit2ChapterRevision = 0;
   var encodedHtml = filter_url_plus_to_tag (html);
   var checksum = checksum_get (encodedHtml);
   editorSaving = true;
@@ -1330,6 +1332,135 @@ var editorHtmlAtStartOfUpdate = null;
 var useShadowQuill = false;
 
 
+// The identifier of the chapter on the server that the reference text in the editor is at.
+// Zero if not known.
+var edit2ChapterRevision = 0;
+
+
+// The maximum number of changed verses to send to the server as verses rather than as the whole chapter.
+var edit2VerseUpdateMaximum = 5;
+
+
+// Splits the editor html into the html per verse, in the way the server splits the USFM into verses.
+// Returns the html of each verse, keyed on the verse number,
+// plus the notes and attributes that follow the text of the chapter.
+// Returns undefined if the html does not split cleanly.
+function edit2SplitVerses (html)
+{
+  var containers = ["b-notes", "b-wordlevelattributes", "b-milestoneattributes"];
+  var container = document.createElement ("div");
+  container.innerHTML = html;
+  var verses = new Map ();
+  var verse = "0";
+  var paragraphs = [];
+  var opening = "";
+  var nodes = [];
+  var serialize = function (node) {
+    if (node.nodeType == Node.ELEMENT_NODE) return node.outerHTML;
+    return node.textContent.replace (/&/g, "&amp;").replace (/</g, "&lt;").replace (/>/g, "&gt;").replace (/\u00a0/g, "&nbsp;");
+  };
+  var closeParagraph = function () {
+    if (nodes.length) paragraphs.push (opening + nodes.map (serialize).join ("") + "</p>");
+    nodes = [];
+  };
+  var closeVerse = function () {
+    closeParagraph ();
+    if (verses.has (verse)) return false;
+    verses.set (verse, paragraphs.join (""));
+    paragraphs = [];
+    return true;
+  };
+  var tail = "";
+  var children = Array.from (container.children);
+  for (var i = 0; i < children.length; i++) {
+    var paragraph = children[i];
+    var style = paragraph.getAttribute ("class") || "";
+    if (containers.includes (style)) {
+      tail = children.slice (i).map (serialize).join ("");
+      break;
+    }
+    if (paragraph.tagName != "P") return undefined;
+    // On the server, an empty paragraph goes with the verse that follows it.
+    if (paragraph.textContent == "") return undefined;
+    opening = "<p" + (style ? ' class="' + style + '"' : "") + ">";
+    var childNodes = Array.from (paragraph.childNodes);
+    for (var j = 0; j < childNodes.length; j++) {
+      var node = childNodes[j];
+      if ((node.nodeType == Node.ELEMENT_NODE) && node.classList.contains ("i-v")) {
+        var number = node.textContent;
+        if (!/^\d+$/.test (number)) return undefined;
+        if (nodes.length) {
+          // The verse starts within the paragraph.
+          // The space before the verse number separates the verses, and does not belong to either of them.
+          while (nodes.length) {
+            var last = nodes[nodes.length - 1];
+            var text = last.textContent.replace (/\s+$/, "");
+            if (text == "") nodes.pop ();
+            else if (last.nodeType == Node.TEXT_NODE) { nodes[nodes.length - 1] = document.createTextNode (text); break; }
+            else break;
+          }
+          closeParagraph ();
+          if (!closeVerse ()) return undefined;
+          opening = "<p>";
+        } else {
+          // The verse starts the paragraph.
+          var pending = opening;
+          if (!closeVerse ()) return undefined;
+          opening = pending;
+        }
+        verse = number;
+      }
+      nodes.push (node);
+    }
+    closeParagraph ();
+  }
+  if (!closeVerse ()) return undefined;
+  return { verses: verses, tail: tail };
+}
+
+
+// Determines the verses that differ between the loaded html and the edited html.
+// Returns undefined if the editor should send the whole chapter instead.
+function edit2ChangedVerses (loadedHtml, editedHtml)
+{
+  if (!edit2ChapterRevision) return undefined;
+  var loaded = edit2SplitVerses (loadedHtml);
+  var edited = edit2SplitVerses (editedHtml);
+  if (!loaded || !edited) return undefined;
+  // Changes in notes or attributes, or in the verses present, affect the whole chapter.
+  if (loaded.tail != edited.tail) return undefined;
+  var numbers = Array.from (loaded.verses.keys ());
+  if (numbers.join (" ") != Array.from (edited.verses.keys ()).join (" ")) return undefined;
+  var changed = [];
+  for (var number of numbers) {
+    var loadedVerse = loaded.verses.get (number);
+    var editedVerse = edited.verses.get (number);
+    if (loadedVerse == editedVerse) continue;
+    if (/i-(notecall|wla|mls)/.test (loadedVerse + editedVerse)) return undefined;
+    changed.push ({ number: number, loaded: loadedVerse, edited: editedVerse });
+  }
+  if (changed.length > edit2VerseUpdateMaximum) return undefined;
+  return changed;
+}
+
+
+// Gets the position in the editor where the verse starts, or -1 if the verse is not there.
+function edit2VersePosition (editor, verse)
+{
+  if (verse == "0") return 0;
+  var position = 0;
+  for (var op of editor.getContents ().ops) {
+    if (typeof op.insert != "string") {
+      position++;
+      continue;
+    }
+    if (op.attributes && (op.attributes.character == "v") && (op.insert == verse)) return position;
+    position += op.insert.length;
+  }
+  return -1;
+}
+
+
 function edit2UpdateExecute ()
 {
   // Determine whether the conditions for an editor update are all met.
@@ -1362,15 +1493,36 @@ function edit2UpdateExecute ()
     editorStatus (editorChapterSaving);
   }
 
-  var checksum1 = checksum_get (encodedLoadedHtml);
-  var checksum2 = checksum_get (encodedEditedHtml);
+  // If possible, send only the verses that changed since the text in the editor was at the known revision.
+  // Else send the whole chapter.
+  var changedVerses = edit2ChangedVerses (editorReferenceText, editorHtmlAtStartOfUpdate);
+  var parameters = [ ["bible", editorLoadedBible], ["book", editorLoadedBook], ["chapter", editorLoadedChapter] ];
+  if (changedVerses) {
+    var checksummed = "";
+    parameters.push (["revision", edit2ChapterRevision]);
+    parameters.push (["verses", changedVerses.map ((changed) => changed.number).join (" ")]);
+    for (var changed of changedVerses) {
+      var encodedLoadedVerse = filter_url_plus_to_tag (changed.loaded);
+      var encodedEditedVerse = filter_url_plus_to_tag (changed.edited);
+      parameters.push (["loaded" + changed.number, encodedLoadedVerse]);
+      parameters.push (["edited" + changed.number, encodedEditedVerse]);
+      checksummed += encodedLoadedVerse + encodedEditedVerse;
+    }
+    parameters.push (["checksum", checksum_get (checksummed)]);
+  } else {
+    parameters.push (["loaded", encodedLoadedHtml]);
+    parameters.push (["edited", encodedEditedHtml]);
+    parameters.push (["checksum1", checksum_get (encodedLoadedHtml)]);
+    parameters.push (["checksum2", checksum_get (encodedEditedHtml)]);
+  }
+  parameters.push (["id", chapterEditorUniqueID]);
 
   edit2AjaxActive = true;
   
   fetch("update", {
     method: "POST",
     headers: { "Content-Type": "application/x-www-form-urlencoded" },
-    body: new URLSearchParams([ ["bible", editorLoadedBible], ["book", editorLoadedBook], ["chapter", editorLoadedChapter], ["loaded", encodedLoadedHtml], ["edited", encodedEditedHtml], ["checksum1", checksum1], ["checksum2", checksum2], ["id", chapterEditorUniqueID] ]).toString(),
+    body: new URLSearchParams(parameters).toString(),
   })
   .then((response) => {
     if (!response.ok) {
@@ -1387,6 +1539,9 @@ function edit2UpdateExecute ()
     // To not make it more complex than needed, leave read-only out.
     var readwrite = checksum_readwrite (response);
 
+    // Whether to take the text sent as the reference, rather than the updated text.
+    var resynchronize = false;
+
     // Checksumming.
     response = checksum_receive (response);
     if (response !== false) {
@@ -1407,12 +1562,36 @@ function edit2UpdateExecute ()
       editorStatus (bits.shift());
 
       // The next bit is the new chapter identifier.
-      oneverseChapterId = bits.shift();
+      edit2ChapterRevision = bits.shift();
+
+      // After sending the changed verses, the next bit says whether the rest of the editor is in sync.
+      // If not, do an update of the whole chapter.
+      // The text sent is now on the server, so take that as the reference.
+      if (changedVerses && (bits.shift () != "1")) {
+        editorReferenceText = editorHtmlAtStartOfUpdate;
+        edit2ChapterRevision = 0;
+        edit2UpdateTrigger = true;
+        bits = [];
+        resynchronize = true;
+      }
 
       // Apply the remaining data, the differences, to the editor.
+      // The positions of the differences in a verse are relative to the start of that verse.
+      var verseOffset = 0;
       while (bits.length > 0) {
         var position = parseInt (bits.shift ());
         var operator = bits.shift();
+        if (operator == "v") {
+          verseOffset = edit2VersePosition (useShadowQuill ? quill2 : quill, String (position));
+          if (verseOffset < 0) {
+            // The verse is no longer in the editor: Do an update of the whole chapter.
+            edit2ChapterRevision = 0;
+            edit2UpdateTrigger = true;
+            break;
+          }
+          continue;
+        }
+        position += verseOffset;
         // Position 0 in the incoming changes always refers to the initial new line in the editor.
         // Do not insert or delete that new line, but just apply any formatting there.
         if (position == 0) {
@@ -1476,12 +1655,15 @@ function edit2UpdateExecute ()
       // If the checksum is not valid, the response will become false.
       // Checksum error.
       editorStatus (editorChapterRetrying);
+      edit2ChapterRevision = 0;
     }
 
     // The browser may reformat the loaded html, so take the possible reformatted data for reference.
-    editorReferenceText = editorGetHtml ();
-    if (useShadowQuill) {
-      editorReferenceText = document.querySelector("#edittemp > .ql-editor").innerHTML;
+    if (!resynchronize) {
+      editorReferenceText = editorGetHtml ();
+      if (useShadowQuill) {
+        editorReferenceText = document.querySelector("#edittemp > .ql-editor").innerHTML;
+      }
     }
     var edittemp = document.querySelector("#edittemp");
     if (edittemp)
@@ -1494,6 +1676,7 @@ function edit2UpdateExecute ()
   .catch((error) => {
     console.log(error);
     editorStatus (editorChapterRetrying);
+    edit2ChapterRevision = 0;
     edit2ContentChanged ();
   })
   .finally(() => {
@@ -42,6 +42,7 @@
 #include <developer/logic.h>
 #include <sendreceive/logic.h>
 #include <database/bibles.h>
+#include <filter/quill.h>
 
 
 std::string edit_update_url ()
@@ -59,8 +60,297 @@ bool edit_update_acl (Webserver_Request& webserver_request)
 }
 
 
+constexpr const char* separator {"#_be_#"};
+
+
+// Encodes the condensed differences for the response to the Javascript editor.
+static void edit_update_append (std::string& response,
+                                const std::vector <int>& positions,
+                                const std::vector <int>& sizes,
+                                const std::vector <std::string>& operators,
+                                const std::vector <std::string>& content)
+{
+  for (size_t i = 0; i < positions.size(); i++) {
+    response.append (separator);
+    response.append (std::to_string (positions[i]));
+    response.append (separator);
+    const std::string& operation = operators[i];
+    response.append (operation);
+    if (operation == bible_logic::insert_operator ()) {
+      const std::string& text = content[i];
+      const std::string character = filter::string::unicode_string_substr (text, 0, 1);
+      response.append (separator);
+      response.append (character);
+      const size_t length = filter::string::unicode_string_length (text);
+      const std::string format = filter::string::unicode_string_substr (text, 1, length - 1);
+      response.append (separator);
+      response.append (format);
+      // Also add the size of the character in UTF-16 format, 2-bytes or 4 bytes, as size 1 or 2.
+      response.append (separator);
+      response.append (std::to_string (sizes[i]));
+    }
+    else if (operation == bible_logic::delete_operator ()) {
+      // When deleting a UTF-16 character encoded in 4 bytes,
+      // then the size in Quilljs is 2 instead of 1.
+      // So always give the size when deleting a character.
+      response.append (separator);
+      response.append (std::to_string (sizes[i]));
+    }
+    else if (operation == bible_logic::format_paragraph_operator ()) {
+      response.append (separator);
+      response.append (content[i]);
+    }
+    else if (operation == bible_logic::format_character_operator ()) {
+      response.append (separator);
+      response.append (content[i]);
+    }
+  }
+}
+
+
+// A verse as edited in the chapter editor.
+struct edit_update_verse
+{
+  int verse {0};
+  std::string number {};
+  std::string loaded_html {};
+  std::string edited_html {};
+};
+
+
+// Whether the editor can apply the updates to a verse without affecting the rest of the chapter.
+// The editor holds the notes, word-level attributes, and milestone attributes after the text of the chapter.
+// It holds paragraphs across verse boundaries.
+// Updates that touch those need the whole chapter.
+static bool edit_update_verse_scoped (const std::string& server_html, const std::vector <std::string>& operators, const std::vector <std::string>& content)
+{
+  for (const char* container : {quill::notes_class, quill::word_level_attributes_class, quill::milestone_attributes_class}) {
+    const std::string cls = std::string(quill::class_prefix_block) + container;
+    if (server_html.find (R"(class=")" + cls + R"(")") != std::string::npos)
+      return false;
+  }
+  for (size_t i = 0; i < operators.size(); i++) {
+    if (operators[i] == bible_logic::format_paragraph_operator ())
+      return false;
+    if (content[i].starts_with ("\n"))
+      return false;
+  }
+  return true;
+}
+
+
+// Saves the verses changed in the chapter editor, and sends the updates for those verses back.
+// The editor posts the chapter identifier its text is based on,
+// plus the loaded and edited html of only the verses that changed.
+// Each verse gets converted, merged, and saved on its own,
+// so the cost of saving no longer depends on the size of the chapter.
+// If the chapter on the server moved on from that identifier,
+// the response tells the editor to do an update of the whole chapter.
+static std::string edit_update_verses (Webserver_Request& webserver_request)
+{
+  // Whether the update is good to go.
+  bool good2go = true;
+
+
+  // The messages to return.
+  std::vector <std::string> messages;
+
+
+  // Get the relevant bits of information.
+  const std::string bible = webserver_request.post_get("bible");
+  const int book = filter::string::convert_to_int(webserver_request.post_get("book"));
+  const int chapter = filter::string::convert_to_int(webserver_request.post_get("chapter"));
+  const int revision = filter::string::convert_to_int(webserver_request.post_get("revision"));
+  std::vector <edit_update_verse> verses;
+  std::string checksummed;
+  for (const auto& number : filter::string::explode (webserver_request.post_get("verses"), ' ')) {
+    if (number != std::to_string (filter::string::convert_to_int (number))) {
+      messages.push_back (translate("Don't know what to update"));
+      good2go = false;
+      break;
+    }
+    edit_update_verse edited_verse {
+      .verse = filter::string::convert_to_int (number),
+      .number = number,
+      .loaded_html = webserver_request.post_get("loaded" + number),
+      .edited_html = webserver_request.post_get("edited" + number)
+    };
+    checksummed.append (edited_verse.loaded_html);
+    checksummed.append (edited_verse.edited_html);
+    verses.push_back (std::move (edited_verse));
+  }
+
+
+  // Checksum of the loaded and edited html of all verses.
+  if (good2go && checksum_logic::get (checksummed) != webserver_request.post_get("checksum")) {
+    webserver_request.response_code = 409;
+    messages.push_back (translate ("Checksum error"));
+    good2go = false;
+  }
+
+
+  // Decode html encoded in javascript, clean it, and check on valid UTF-8.
+  for (auto& edited_verse : verses) {
+    edited_verse.loaded_html = filter::string::trim (filter_url_tag_to_plus (edited_verse.loaded_html));
+    edited_verse.edited_html = filter::string::trim (filter_url_tag_to_plus (edited_verse.edited_html));
+    if (!filter::string::unicode_string_is_valid (edited_verse.loaded_html) || !filter::string::unicode_string_is_valid (edited_verse.edited_html)) {
+      if (good2go)
+        messages.push_back (translate ("Cannot update: Needs Unicode"));
+      good2go = false;
+    }
+  }
+
+
+  bool bible_write_access = false;
+  if (good2go) {
+    bible_write_access = access_bible::book_write (webserver_request, std::string(), bible, book);
+  }
+
+
+  std::string stylesheet;
+  if (good2go) {
+    stylesheet = database::config::bible::get_editor_stylesheet (bible);
+  }
+
+
+  // Collect some data about the changes for this user.
+  const std::string& username = webserver_request.session_logic ()->get_username ();
+  const int old_id = database::bibles::get_chapter_id (bible, book, chapter);
+  const std::string old_chapter_usfm = database::bibles::get_chapter (bible, book, chapter);
+
+
+  // The editor has the text of the chapter at the given revision, apart from the edited verses.
+  // If the chapter on the server is still at that revision, updating the edited verses suffices.
+  bool in_sync = good2go && (revision != 0) && (revision == old_id);
+
+
+  // Save the verses one by one.
+  // Each saved verse changes the chapter, so take the existing verse from the chapter as it is now.
+  std::string chapter_usfm (old_chapter_usfm);
+  bool text_was_saved {false};
+  for (const auto& edited_verse : verses) {
+    if (!good2go || !bible_write_access)
+      break;
+
+    const std::string loaded_verse_usfm = editone_logic_html_to_usfm (stylesheet, edited_verse.loaded_html);
+    std::string edited_verse_usfm = editone_logic_html_to_usfm (stylesheet, edited_verse.edited_html);
+    edited_verse_usfm = filter::usfm::transpose_opening_marker_and_space_sequence(std::move(edited_verse_usfm));
+    if (loaded_verse_usfm == edited_verse_usfm)
+      continue;
+    const std::string existing_verse_usfm = filter::string::trim (filter::usfm::get_verse_text_quill (chapter, edited_verse.verse, chapter_usfm));
+
+    // Do a three-way merge if the USFM on the server differs from the USFM loaded in the editor.
+    if (loaded_verse_usfm != existing_verse_usfm) {
+      std::vector <Merge_Conflict> conflicts;
+      // Do a merge while giving priority to the USFM already in the chapter.
+      std::string merged_verse_usfm = filter_merge_run (loaded_verse_usfm, edited_verse_usfm, existing_verse_usfm, true, conflicts);
+      // Mail the user if there is a merge anomaly.
+      filter_merge_add_book_chapter (conflicts, book, chapter);
+      bible_logic::optional_merge_irregularity_email (bible, book, chapter, username, loaded_verse_usfm, edited_verse_usfm, merged_verse_usfm);
+      bible_logic::merge_irregularity_mail ({username}, conflicts);
+      // Let the merged data now become the edited data (so it gets saved properly).
+      edited_verse_usfm = std::move(merged_verse_usfm);
+    }
+
+    // Collapse any double spaces in the USFM to save.
+    // https://github.com/bibledit/cloud/issues/711
+    edited_verse_usfm = filter::string::collapse_whitespace(edited_verse_usfm);
+
+    // Safely store the verse.
+    std::string explanation;
+    const std::string message = filter::usfm::safely_store_verse (webserver_request, bible, book, chapter, edited_verse.verse, edited_verse_usfm, explanation, true);
+    bible_logic::unsafe_save_mail (message, explanation, username, edited_verse_usfm, book, chapter);
+    if (message.empty ()) {
+      text_was_saved = true;
+      chapter_usfm = database::bibles::get_chapter (bible, book, chapter);
+    } else {
+      // Feedback about anomaly to user.
+      messages.push_back (message);
+    }
+  }
+
+
+  // The new chapter identifier and new chapter USFM.
+  const int new_id = database::bibles::get_chapter_id (bible, book, chapter);
+  const std::string& new_chapter_usfm = chapter_usfm;
+
+
+  if (text_was_saved) {
+#ifdef HAVE_CLOUD
+    // The Cloud stores details of the user's changes.
+    database::modifications::recordUserSave (username, bible, book, chapter, old_id, old_chapter_usfm, new_id, new_chapter_usfm);
+    if (sendreceive_git_repository_linked (bible)) {
+      database::git::store_chapter (username, bible, book, chapter, old_chapter_usfm, new_chapter_usfm);
+    }
+#endif
+    // Feedback to user.
+    messages.push_back (locale_logic_text_saved ());
+  }
+
+
+  // If there's no message at all, return at least something to the editor.
+  if (messages.empty ()) messages.push_back (locale_logic_text_updated ());
+
+
+  // The response starts with the save message(s) and the new chapter identifier.
+  std::string response;
+  response.append (filter::string::implode (messages, " | "));
+  response.append (separator);
+  response.append (std::to_string (new_id));
+
+
+  // The differences between what the editor now has in each verse and what the server now has.
+  // The positions of the updates for a verse are relative to the start of that verse in the editor.
+  // This is the format to send them in:
+  // verse - "v" - the updates for that verse
+  std::string updates;
+  if (in_sync) {
+    for (const auto& edited_verse : verses) {
+      std::string server_html;
+      const std::string verse_usfm = filter::usfm::get_verse_text_quill (chapter, edited_verse.verse, new_chapter_usfm);
+      editone_logic_editable_html (verse_usfm, stylesheet, server_html);
+      std::vector <int> positions;
+      std::vector <int> sizes;
+      std::vector <std::string> operators;
+      std::vector <std::string> content;
+      bible_logic::html_to_editor_updates (edited_verse.edited_html, server_html, positions, sizes, operators, content);
+      if (!edit_update_verse_scoped (server_html, operators, content)) {
+        in_sync = false;
+        break;
+      }
+      if (positions.empty ())
+        continue;
+      updates.append (separator);
+      updates.append (edited_verse.number);
+      updates.append (separator);
+      updates.append ("v");
+      edit_update_append (updates, positions, sizes, operators, content);
+    }
+  }
+
+
+  // Whether the editor is in sync with the chapter on the server after applying the updates.
+  // If not, the editor should do an update of the whole chapter.
+  response.append (separator);
+  response.append (filter::string::convert_to_string (in_sync));
+  if (in_sync)
+    response.append (updates);
+
+
+  const bool write = access_bible::book_write (webserver_request, username, bible, book);
+  response = checksum_logic::send (response, write);
+
+  return response;
+}
+
+
 std::string edit_update (Webserver_Request& webserver_request)
 {
+  // The editor posts only the edited verses if it can.
+  if (webserver_request.post_count("verses"))
+    return edit_update_verses (webserver_request);
+
+
   // Whether the update is good to go.
   bool good2go = true;
   
@@ -314,7 +604,6 @@ std::string edit_update (Webserver_Request& webserver_request)
   
   // The response to send to back to the editor.
   std::string response;
-  std::string separator = "#_be_#";
   // The response starts with the save message(s) if any.
   // The message(s) contain information about save success or failure.
   // Send it to the browser for display to the user.
@@ -350,41 +639,7 @@ std::string edit_update (Webserver_Request& webserver_request)
     std::vector <std::string> content;
     bible_logic::html_to_editor_updates (editor_html, server_html, positions, sizes, operators, content);
     // Encode the condensed differences for the response to the Javascript editor.
-    for (size_t i = 0; i < positions.size(); i++) {
-      response.append ("#_be_#");
-      response.append (std::to_string (positions[i]));
-      response.append ("#_be_#");
-      std::string operation = operators[i];
-      response.append (operation);
-      if (operation == bible_logic::insert_operator ()) {
-        std::string text = content[i];
-        std::string character = filter::string::unicode_string_substr (text, 0, 1);
-        response.append ("#_be_#");
-        response.append (character);
-        size_t length = filter::string::unicode_string_length (text);
-        std::string format = filter::string::unicode_string_substr (text, 1, length - 1);
-        response.append ("#_be_#");
-        response.append (format);
-        // Also add the size of the character in UTF-16 format, 2-bytes or 4 bytes, as size 1 or 2.
-        response.append ("#_be_#");
-        response.append (std::to_string (sizes[i]));
-      }
-      else if (operation == bible_logic::delete_operator ()) {
-        // When deleting a UTF-16 character encoded in 4 bytes,
-        // then the size in Quilljs is 2 instead of 1.
-        // So always give the size when deleting a character.
-        response.append ("#_be_#");
-        response.append (std::to_string (sizes[i]));
-      }
-      else if (operation == bible_logic::format_paragraph_operator ()) {
-        response.append ("#_be_#");
-        response.append (content[i]);
-      }
-      else if (operation == bible_logic::format_character_operator ()) {
-        response.append ("#_be_#");
-        response.append (content[i]);
-      }
-    }
+    edit_update_append (response, positions, sizes, operators, content);
   }
   
   // Things to try out in the C++ and Javacript update routines.
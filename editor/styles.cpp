@@ -41,7 +41,7 @@ std::string Editor_Styles::get_recently_used (Webserver_Request& webserver_reque
   for (const auto& marker : styles) {
     if (!fragment.empty())
       fragment.append (" | ");
-    const stylesv2::Style* style = database::styles::get_marker_data (stylesheet, marker);
+    const auto style = database::styles::get_marker_data (stylesheet, marker);
     if (!style)
       continue;
     const std::string name = translate(style->name) + " (" + marker + ")";
@@ -88,7 +88,7 @@ std::string Editor_Styles::get_all (Webserver_Request& webserver_request)
     const std::string& marker = item.first;
     std::string name = item.second;
     name = translate (name);
-    const stylesv2::Style* style = database::styles::get_marker_data (stylesheet, marker);
+    const auto style = database::styles::get_marker_data (stylesheet, marker);
     if (!style)
       continue;
     std::stringstream category{};
@@ -132,7 +132,7 @@ std::string Editor_Styles::get_action (Webserver_Request& webserver_request, con
   const std::string bible = webserver_request.database_config_user()->get_bible ();
   const std::string stylesheet = database::config::bible::get_editor_stylesheet (bible);
   
-  if (const stylesv2::Style* style {database::styles::get_marker_data (stylesheet, marker)}; style)
+  if (const auto style {database::styles::get_marker_data (stylesheet, marker)}; style)
   {
     switch (style->type) {
       case stylesv2::Type::book_id:
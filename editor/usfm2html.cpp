@@ -41,9 +41,9 @@ void Editor_Usfm2Html::load (std::string usfm)
 
 void Editor_Usfm2Html::stylesheet (const std::string& stylesheet)
 {
-  m_stylesheet = stylesheet;
   // Load style information into the object.
-  for (const stylesv2::Style& style : database::styles::get_styles(stylesheet)) {
+  m_styles = database::styles::get_snapshot(stylesheet);
+  for (const stylesv2::Style& style : m_styles->styles()) {
     m_note_citations.evaluate_style(style);
   }
 }
@@ -193,7 +193,7 @@ void Editor_Usfm2Html::process ()
         if (is_opening_marker) {
           filter::usfm::remove_word_level_attributes (marker, m_markers_and_text, m_markers_and_text_pointer);
         }
-      if (const stylesv2::Style* style {database::styles::get_marker_data (m_stylesheet, marker)}; style)
+      if (const stylesv2::Style* style {m_styles->find (marker)}; style)
       {
         switch (style->type) {
           case stylesv2::Type::starting_boundary:
@@ -709,7 +709,7 @@ void Editor_Usfm2Html::add_note_link (pugi::xml_node& dom_node, const int identi
 bool Editor_Usfm2Html::road_is_clear ()
 {
   // Call a unit testable function to do the work.
-  return ::road_is_clear (m_markers_and_text, m_markers_and_text_pointer, m_stylesheet);
+  return ::road_is_clear (m_markers_and_text, m_markers_and_text_pointer, *m_styles);
 }
 
 
@@ -869,6 +869,16 @@ void Editor_Usfm2Html::add_milestone_attributes(const std::string id)
 bool road_is_clear(const std::vector<std::string>& markers_and_text,
                    const unsigned int markers_and_text_pointer,
                    const std::string& stylesheet)
+{
+  return road_is_clear(markers_and_text, markers_and_text_pointer, *database::styles::get_snapshot(stylesheet));
+}
+
+
+// Returns true if the road ahead is clear for the current marker,
+// given the snapshot of the stylesheet.
+bool road_is_clear(const std::vector<std::string>& markers_and_text,
+                   const unsigned int markers_and_text_pointer,
+                   const database::styles::snapshot& styles)
 {
   // Section 1: Functions to find marker properties.
   
@@ -967,7 +977,7 @@ bool road_is_clear(const std::vector<std::string>& markers_and_text,
 
   // The marker. If not in stylesheet, the road is clear.
   const std::string input_marker {filter::usfm::get_marker (input_item)};
-  const stylesv2::Style* input_style {database::styles::get_marker_data (stylesheet, input_marker)};
+  const stylesv2::Style* input_style {styles.find (input_marker)};
   if (!input_style)
     return true;
 
@@ -997,7 +1007,7 @@ bool road_is_clear(const std::vector<std::string>& markers_and_text,
     if (filter::usfm::is_usfm_marker (current_item))
     {
       const std::string marker = filter::usfm::get_marker (current_item);
-      const stylesv2::Style* style {database::styles::get_marker_data (stylesheet, marker)};
+      const stylesv2::Style* style {styles.find (marker)};
       if (style)
       {
         const bool opener {filter::usfm::is_opening_marker (current_item)};
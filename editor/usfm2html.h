@@ -42,7 +42,7 @@ private:
   unsigned int m_markers_and_text_pointer {0};
   
   // All the style information.
-  std::string m_stylesheet{};
+  std::shared_ptr<const database::styles::snapshot> m_styles{};
   
   // XML nodes.
   pugi::xml_document m_document {};
@@ -106,3 +106,6 @@ private:
 bool road_is_clear(const std::vector<std::string>& markers_and_text,
                    const unsigned int markers_and_text_pointer,
                    const std::string& stylesheet);
+bool road_is_clear(const std::vector<std::string>& markers_and_text,
+                   const unsigned int markers_and_text_pointer,
+                   const database::styles::snapshot& styles);
@@ -61,13 +61,26 @@ void send ()
   Database_Mail database_mail (webserver_request);
   Database_Users database_users;
   
+  // Many emails in a batch go to the same few users.
+  // Look up the email address of each of them once only.
+  std::unordered_map <std::string, std::string> email_addresses {};
+  
+#ifdef HAVE_CLOUD
+  // All emails in the batch go through one session with the SMTP server.
+  // It gets connected on the first email.
+  std::optional <smtp_session> session {};
+#endif
+  
   const auto mails = database_mail.getMailsToSend ();
   for (auto id : mails) {
     
     // Get all details of the mail.
     Database_Mail_Item details = database_mail.get (id);
     std::string username = details.username;
-    std::string email = database_users.get_email (username);
+    auto iter = email_addresses.find (username);
+    if (iter == email_addresses.end ())
+      iter = email_addresses.emplace (username, database_users.get_email (username)).first;
+    std::string email = iter->second;
     std::string subject = details.subject;
     std::string body = details.body;
     
@@ -108,7 +121,13 @@ void send ()
     body = filter_mail_limit_line_length_rfc5322(body);
     
     // Send the email.
+#ifdef HAVE_CLOUD
+    if (!session)
+      session.emplace (get_smtp_settings (), 2);
+    std::string result = session->send (email, username, subject, body);
+#else
     std::string result = email::send (email, username, subject, body);
+#endif
     if (result.empty ()) {
       database_mail.erase (id);
       std::stringstream ss;
@@ -124,12 +143,18 @@ void send ()
     } else {
       // Special handling of cases that the smart host denied login.
       bool login_denied = result == "Login denied";
+      // Special handling of cases that the smart host cannot be reached, even after trying again.
+      bool unreachable {false};
+#ifdef HAVE_CLOUD
+      unreachable = session->unreachable ();
+#endif
       // Write result to logbook.
       result.insert (0, "Email to " + email + " could not be sent - reason: ");
       database::logs::log (result, roles::manager);
-      // If the login was denied, then postpone all emails queued for sending,
-      // rather than trying to send them all, and have them all cause a 'login denied' error.
-      if (login_denied) {
+      // If the login was denied, or the smart host cannot be reached,
+      // then postpone all emails queued for sending,
+      // rather than trying to send them all, and have them all cause the same error.
+      if (login_denied || unreachable) {
         std::vector <int> ids = database_mail.getAllMails ();
         for (auto id2 : ids) {
           database_mail.postpone (id2);
@@ -144,101 +169,38 @@ void send ()
 }
 
 
-static std::vector <std::string> payload_text;
+#ifdef HAVE_CLOUD
+
+
+namespace {
 
 
-struct upload_status {
-  size_t lines_read;
+// The message being uploaded to the SMTP server.
+struct upload_status final
+{
+  std::string payload {};
+  size_t offset {0};
 };
 
 
-#ifdef HAVE_CLIENT
-#else
-static size_t payload_source (void *ptr, size_t size, size_t nmemb, void *userp)
+size_t payload_source (char *ptr, size_t size, size_t nmemb, void *userp)
 {
-  upload_status *upload_ctx = static_cast <upload_status *> (userp);
-  const char *data;
-  
-  if((size == 0) || (nmemb == 0) || ((size*nmemb) < 1)) {
-    return 0;
-  }
-  
-  if (upload_ctx->lines_read >= payload_text.size()) {
-    return 0;
-  }
-  
-  data = payload_text[upload_ctx->lines_read].c_str();
-  
-  size_t len = strlen(data);
-  memcpy(ptr, data, len);
-  upload_ctx->lines_read++;
-  
-  return len;
+  upload_status *upload = static_cast <upload_status *> (userp);
+  const size_t count = std::min (size * nmemb, upload->payload.size () - upload->offset);
+  memcpy (ptr, upload->payload.data () + upload->offset, count);
+  upload->offset += count;
+  return count;
 }
-#endif
 
 
-// Sends the email as specified by the parameters.
-// If all went well, it returns an empty string.
-// In case of failure, it returns the error message.
-std::string send ([[maybe_unused]] std::string to_mail,
-                  std::string to_name,
-                  std::string subject,
-                  std::string body,
-                  [[maybe_unused]] bool verbose)
+// Assembles the headers and the body of the email.
+std::string compose (const smtp_settings& settings,
+                     const std::string& to_mail, const std::string& to_name,
+                     const std::string& subject, const std::string& body)
 {
-  // Truncate huge emails because libcurl crashes on it.
-  const size_t length = body.length();
-  if (length > max_email_size)
-    body = "This email was " + std::to_string (length) + " bytes long. It was too long, and could not be sent.";
-  
-  // Deal with empty subject.
-  if (subject.empty ())
-    subject = translate ("Bibledit");
-  
-#ifdef HAVE_CLIENT
-  
-  if (!client_logic_client_enabled ())
-    return std::string();
-  
-  Webserver_Request webserver_request;
-  Sync_Logic sync_logic (webserver_request);
-  
-  std::map <std::string, std::string> post;
-  post ["n"] = filter::string::bin2hex (to_name);
-  post ["s"] = subject;
-  post ["b"] = body;
-  
-  std::string address = database::config::general::get_server_address ();
-  int port = database::config::general::get_server_port ();
-  std::string url = client_logic_url (address, port, sync_mail_url ());
-  
-  std::string error;
-  std::string response = sync_logic.post (post, url, error);
-  
-  if (!error.empty ()) {
-    database::logs::log ("Failure sending email: " + error, roles::guest);
-  }
-  
-  return error;
-  
-#else
-  
-  std::string from_mail = database::config::general::get_site_mail_address ();
-  std::string from_name = database::config::general::get_site_mail_name ();
-  
-  CURL *curl;
-  CURLcode res = CURLE_OK;
-  curl_slist * recipients {nullptr};
-  upload_status upload_ctx;
-  
-  upload_ctx.lines_read = 0;
-  
+  std::string payload {};
   int seconds = filter::date::get_seconds_since_epoch ();
-  payload_text.clear();
-  std::string payload;
   payload = "Date: " + std::to_string (filter::date::get_year_ad (seconds)) + "/" + std::to_string (filter::date::get_month_within_year (seconds)) + "/" + std::to_string (filter::date::get_day_within_month (seconds)) + " " + std::to_string (filter::date::get_hour_within_day (seconds)) + ":" + std::to_string (filter::date::get_minute_within_hour (seconds)) + "\n";
-  payload_text.push_back (std::move(payload));
   const auto generate_address_line = [] (const char* header,
                                          const std::string& name,
                                          const std::string& mail) {
@@ -248,88 +210,123 @@ std::string send ([[maybe_unused]] std::string to_mail,
     ss << " " << "<" << mail << ">";
     return std::move(ss).str();
   };
-  payload = generate_address_line("To", to_name, to_mail) + "\n";
-  payload_text.push_back (std::move(payload));
-  payload = generate_address_line("From", from_name, from_mail) + "\n";
-  payload_text.push_back (std::move(payload));
-  std::string site = from_mail;
+  payload.append (generate_address_line("To", to_name, to_mail) + "\n");
+  payload.append (generate_address_line("From", settings.from_name, settings.from_mail) + "\n");
+  std::string site = settings.from_mail;
   size_t pos = site.find ("@");
   if (pos != std::string::npos) site = site.substr (pos);
-  payload = "Message-ID: <" + md5 (std::to_string (filter::string::rand (0, 1000000))) + site + ">\n";
-  payload_text.push_back (std::move(payload));
-  payload = "Subject: " + subject + "\n";
-  payload_text.push_back (std::move(payload));
-  payload_text.push_back ("Mime-version: 1.0\n");
-  payload_text.push_back (R"(Content-Type: multipart/alternative; boundary="------------010001060501040600060905")");
+  payload.append ("Message-ID: <" + md5 (std::to_string (filter::string::rand (0, 1000000))) + site + ">\n");
+  payload.append ("Subject: " + subject + "\n");
+  payload.append ("Mime-version: 1.0\n");
+  payload.append (R"(Content-Type: multipart/alternative; boundary="------------010001060501040600060905")");
   // Empty line to divide headers from body, see RFC5322.
-  payload_text.push_back ("\n");
+  payload.append ("\n");
   // Plain text part.
-  payload_text.push_back ("--------------010001060501040600060905\n");
-  payload_text.push_back ("Content-Type: text/plain; charset=utf-8\n");
-  payload_text.push_back ("Content-Transfer-Encoding: 7bit\n");
-  payload_text.push_back ("\n");
-  payload_text.push_back ("Plain text message.\n");
-  payload_text.push_back ("--------------010001060501040600060905\n");
-  payload_text.push_back ("Content-Type: text/html; charset=\"utf-8\"\n");
-  payload_text.push_back ("Content-Transfer-Encoding: 8bit\n");
-  payload_text.push_back ("\n");
-  payload_text.push_back ("<!DOCTYPE html>\n");
-  payload_text.push_back ("<html>\n");
-  payload_text.push_back ("<head>\n");
-  payload_text.push_back ("<meta http-equiv=\"content-type\" content=\"text/html; charset=UTF-8\"></meta>\n");
-  payload_text.push_back ("<meta charset=\"utf-8\" />\n");
-  payload_text.push_back ("</head>\n");
-  payload_text.push_back ("<body>\n");
+  payload.append ("--------------010001060501040600060905\n");
+  payload.append ("Content-Type: text/plain; charset=utf-8\n");
+  payload.append ("Content-Transfer-Encoding: 7bit\n");
+  payload.append ("\n");
+  payload.append ("Plain text message.\n");
+  payload.append ("--------------010001060501040600060905\n");
+  payload.append ("Content-Type: text/html; charset=\"utf-8\"\n");
+  payload.append ("Content-Transfer-Encoding: 8bit\n");
+  payload.append ("\n");
+  payload.append ("<!DOCTYPE html>\n");
+  payload.append ("<html>\n");
+  payload.append ("<head>\n");
+  payload.append ("<meta http-equiv=\"content-type\" content=\"text/html; charset=UTF-8\"></meta>\n");
+  payload.append ("<meta charset=\"utf-8\" />\n");
+  payload.append ("</head>\n");
+  payload.append ("<body>\n");
   std::vector <std::string> bodylines = filter::string::explode (body, '\n');
   for (auto & line : bodylines) {
-    if (filter::string::trim (line).empty ()) payload_text.push_back (" ");
-    else payload_text.push_back (line);
-    payload_text.push_back ("\n");
+    if (filter::string::trim (line).empty ()) payload.append (" ");
+    else payload.append (line);
+    payload.append ("\n");
   }
-  payload_text.push_back ("</body>");
-  payload_text.push_back ("</html>\n");
+  payload.append ("</body>");
+  payload.append ("</html>\n");
   // Empty line.
-  payload_text.push_back ("\n");
-  
-  curl = curl_easy_init();
-  /* Set username and password */
-  std::string username = database::config::general::get_mail_send_username();
-  std::string password = database::config::general::get_mail_send_password();
-  curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-  curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
+  payload.append ("\n");
+  return payload;
+}
+
+
+// Whether a failure to send an email is likely to go away when trying again a bit later.
+bool is_transient (const CURLcode code)
+{
+  return (code == CURLE_COULDNT_CONNECT)
+  || (code == CURLE_OPERATION_TIMEDOUT)
+  || (code == CURLE_SEND_ERROR)
+  || (code == CURLE_RECV_ERROR)
+  || (code == CURLE_GOT_NOTHING)
+  || (code == CURLE_SSL_CONNECT_ERROR);
+}
+
+
+}
+
+
+#endif
+
+
+// Truncates huge emails and deals with an empty subject.
+static void prepare (std::string& subject, std::string& body)
+{
+  // Truncate huge emails because libcurl crashes on it.
+  const size_t length = body.length();
+  if (length > max_email_size)
+    body = "This email was " + std::to_string (length) + " bytes long. It was too long, and could not be sent.";
   
+  // Deal with empty subject.
+  if (subject.empty ())
+    subject = translate ("Bibledit");
+}
+
+
+// Gets the settings for sending email from the configuration.
+smtp_settings get_smtp_settings ()
+{
+  smtp_settings settings {};
   /* This is the URL for your mailserver. Note the use of port 587 here,
    * instead of the normal SMTP port (25). Port 587 is commonly used for
    * secure mail submission (see RFC4403), but you should use whatever
    * matches your server configuration. */
-  std::string smtp = "smtp://";
-  smtp.append (database::config::general::get_mail_send_host());
-  smtp.append (":");
-  std::string port = database::config::general::get_mail_send_port();
-  smtp.append (port);
-  curl_easy_setopt(curl, CURLOPT_URL, smtp.c_str());
+  const std::string port = database::config::general::get_mail_send_port();
+  settings.url = "smtp://" + database::config::general::get_mail_send_host() + ":" + port;
+  settings.username = database::config::general::get_mail_send_username();
+  settings.password = database::config::general::get_mail_send_password();
+  settings.from_mail = database::config::general::get_site_mail_address ();
+  settings.from_name = database::config::general::get_site_mail_name ();
+  settings.use_tls = (port != "25");
+  return settings;
+}
+
+
+#ifdef HAVE_CLOUD
+
+
+smtp_session::smtp_session (smtp_settings settings, const int retries, const bool verbose) :
+m_settings (std::move (settings)),
+m_retries (retries)
+{
+  CURL* curl = curl_easy_init();
+  m_curl = curl;
+
+  /* Set username and password */
+  if (!m_settings.username.empty ()) {
+    curl_easy_setopt(curl, CURLOPT_USERNAME, m_settings.username.c_str());
+    curl_easy_setopt(curl, CURLOPT_PASSWORD, m_settings.password.c_str());
+  }
+  
+  curl_easy_setopt(curl, CURLOPT_URL, m_settings.url.c_str());
   
   /* In this example, we'll start with a plain text connection, and upgrade
    * to Transport Layer Security (TLS) using the STARTTLS command. Be careful
    * of using CURLUSESSL_TRY here, because if TLS upgrade fails, the transfer
    * will continue anyway - see the security discussion in the libcurl
    * tutorial for more details. */
-  if (port != "25") curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-  
-  /* If your server doesn't have a valid certificate, then you can disable
-   * part of the Transport Layer Security protection by setting the
-   * CURLOPT_SSL_VERIFYPEER and CURLOPT_SSL_VERIFYHOST options to 0 (false).
-   */
-  // curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-  // curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-  /*
-   * That is, in general, a bad idea. It is still better than sending your
-   * authentication details in plain text though.
-   * Instead, you should get the issuer certificate (or the host certificate
-   * if the certificate is self-signed) and add it to the set of certificates
-   * that are known to libcurl using CURLOPT_CAINFO and/or CURLOPT_CAPATH. See
-   * docs/SSLCERTS for more information. */
-  //curl_easy_setopt(curl, CURLOPT_CAINFO, "/path/to/certificate.pem");
+  if (m_settings.use_tls) curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
   
   /* Note that this option isn't strictly required, omitting it will result in
    * libcurl sending the MAIL FROM command with empty sender data. All
@@ -337,18 +334,11 @@ std::string send ([[maybe_unused]] std::string to_mail,
    * to the address in the reverse-path which triggered them. Otherwise, they
    * could cause an endless loop. See RFC 5321 Section 4.5.5 for more details.
    */
-  curl_easy_setopt(curl, CURLOPT_MAIL_FROM, from_mail.c_str());
-  
-  /* Add the recipients, in this particular case they correspond to the
-   * To: addressee in the header, but they could be any kind of recipient. */
-  recipients = curl_slist_append(recipients, to_mail.c_str());
-  curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipients);
+  curl_easy_setopt(curl, CURLOPT_MAIL_FROM, m_settings.from_mail.c_str());
   
   /* We're using a callback function to specify the payload (the headers and
-   * body of the message). You could just use the CURLOPT_READDATA option to
-   * specify a FILE pointer to read from. */
+   * body of the message). */
   curl_easy_setopt(curl, CURLOPT_READFUNCTION, payload_source);
-  curl_easy_setopt(curl, CURLOPT_READDATA, &upload_ctx);
   curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
   
   // Since the traffic will be encrypted, it is very useful to turn on debug
@@ -360,21 +350,106 @@ std::string send ([[maybe_unused]] std::string to_mail,
   
   // Timeout values.
   filter_url_curl_set_timeout (curl);
+}
+
+
+smtp_session::~smtp_session ()
+{
+  // This closes the connection to the server.
+  curl_easy_cleanup(m_curl);
+}
+
+
+// Sends the email over the connection of this session.
+// The first email opens the connection, and the next ones reuse it.
+// If all went well, it returns an empty string.
+// In case of failure, it returns the error message.
+std::string smtp_session::send (const std::string& to_mail, const std::string& to_name, std::string subject, std::string body)
+{
+  prepare (subject, body);
+
+  CURL* curl = m_curl;
+  upload_status upload {};
+  upload.payload = compose (m_settings, to_mail, to_name, subject, body);
+  curl_easy_setopt(curl, CURLOPT_READDATA, &upload);
+
+  /* Add the recipients, in this particular case they correspond to the
+   * To: addressee in the header, but they could be any kind of recipient. */
+  curl_slist * recipients = curl_slist_append(nullptr, to_mail.c_str());
+  curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipients);
   
   /* Send the message */
-  res = curl_easy_perform(curl);
+  // Once the message has started to go out, the server may have accepted it,
+  // so trying again could deliver it twice.
+  CURLcode res = curl_easy_perform(curl);
+  for (int attempt {0}; (res != CURLE_OK) && is_transient (res) && (upload.offset == 0) && (attempt < m_retries); attempt++) {
+    // Back off before trying again on a fresh connection.
+    std::this_thread::sleep_for (std::chrono::seconds (1 << attempt));
+    upload.offset = 0;
+    curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+    res = curl_easy_perform(curl);
+    curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
+  }
   
   /* Check for errors */
   std::string result;
   if (res != CURLE_OK) result = curl_easy_strerror (res);
+  m_unreachable = (res != CURLE_OK) && is_transient (res);
   
   /* Free the list of recipients */
+  curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, nullptr);
   curl_slist_free_all(recipients);
-  
-  /* Always cleanup */
-  curl_easy_cleanup(curl);
+  curl_easy_setopt(curl, CURLOPT_READDATA, nullptr);
   
   return result;
+}
+
+
+#endif
+
+
+// Sends the email as specified by the parameters.
+// If all went well, it returns an empty string.
+// In case of failure, it returns the error message.
+std::string send ([[maybe_unused]] std::string to_mail,
+                  std::string to_name,
+                  std::string subject,
+                  std::string body,
+                  [[maybe_unused]] bool verbose)
+{
+#ifdef HAVE_CLIENT
+  
+  prepare (subject, body);
+  
+  if (!client_logic_client_enabled ())
+    return std::string();
+  
+  Webserver_Request webserver_request;
+  Sync_Logic sync_logic (webserver_request);
+  
+  std::map <std::string, std::string> post;
+  post ["n"] = filter::string::bin2hex (to_name);
+  post ["s"] = subject;
+  post ["b"] = body;
+  
+  std::string address = database::config::general::get_server_address ();
+  int port = database::config::general::get_server_port ();
+  std::string url = client_logic_url (address, port, sync_mail_url ());
+  
+  std::string error;
+  std::string response = sync_logic.post (post, url, error);
+  
+  if (!error.empty ()) {
+    database::logs::log ("Failure sending email: " + error, roles::guest);
+  }
+  
+  return error;
+  
+#else
+  
+  smtp_session session (get_smtp_settings (), 0, verbose);
+  return session.send (to_mail, to_name, std::move (subject), std::move (body));
+
 #endif
 }
 
@@ -26,6 +26,45 @@ namespace email {
 // Maximum email size, on the safe side, that libcurl can send without it crashing.
 constexpr const int max_email_size {100000};
 
+// The settings for sending email through an SMTP server.
+struct smtp_settings final
+{
+  // The URL of the server, e.g. smtp://host:587.
+  std::string url {};
+  std::string username {};
+  std::string password {};
+  std::string from_mail {};
+  std::string from_name {};
+  // Whether to require upgrading the connection to TLS through STARTTLS.
+  bool use_tls {true};
+};
+
+smtp_settings get_smtp_settings ();
+
+#ifdef HAVE_CLOUD
+// A session with the SMTP server that sends a batch of emails over one connection.
+// The connection, the TLS handshake, and the login, are done once, and reused for the next email.
+class smtp_session final
+{
+public:
+  explicit smtp_session (smtp_settings settings, int retries = 0, bool verbose = false);
+  ~smtp_session ();
+  smtp_session (const smtp_session&) = delete;
+  smtp_session& operator= (const smtp_session&) = delete;
+  smtp_session (smtp_session&&) = delete;
+  smtp_session& operator= (smtp_session&&) = delete;
+  std::string send (const std::string& to_mail, const std::string& to_name, std::string subject, std::string body);
+  bool unreachable () const { return m_unreachable; }
+private:
+  smtp_settings m_settings {};
+  // The number of times to try again after a transient failure.
+  int m_retries {0};
+  // Whether the last email failed on a transient error that persisted after trying again.
+  bool m_unreachable {false};
+  void* m_curl {nullptr};
+};
+#endif
+
 void send ();
 std::string send (std::string to_mail, std::string to_name, std::string subject, std::string body, bool verbose = false);
 void schedule (std::string to, std::string subject, std::string body, int time = 0);
@@ -0,0 +1,101 @@
+/*
+ Copyright (©) 2003-2026 Teus Benschop.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <export/combined.h>
+#include <export/logic.h>
+#include <export/html.h>
+#include <export/odt.h>
+#include <export/esword.h>
+#include <export/onlinebible.h>
+#include <export/textusfm.h>
+#include <database/bibles.h>
+#include <database/config/bible.h>
+#include <filter/string.h>
+#include <filter/text.h>
+#include <filter/passage.h>
+
+
+// Exports a book, or the whole Bible when $book is 0, to several formats in one go.
+// The USFM is read and converted once, with all the requested outputs attached to the same text filter.
+// $formats: The export_logic format identifiers to produce.
+void export_combined (const std::string& bible, const int book, const std::vector <int>& formats, const bool log)
+{
+  const auto requested = [&formats] (const int format) {
+    return std::find (formats.cbegin (), formats.cend (), format) != formats.cend ();
+  };
+  const bool html = requested (export_logic::export_html);
+  const bool text = requested (export_logic::export_text_and_basic_usfm);
+  const bool odt = requested (export_logic::export_opendocument);
+  const bool esword = requested (export_logic::export_esword);
+  const bool onlinebible = requested (export_logic::export_online_bible);
+
+  
+  const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
+  
+  
+  Filter_Text filter_text = Filter_Text (bible);
+  if (html)
+    export_html_attach (filter_text, bible);
+  if (text)
+    export_text_usfm_attach (filter_text, bible, book);
+  if (odt)
+    export_odt_attach (filter_text, bible);
+  if (esword)
+    export_esword_attach (filter_text, bible);
+  if (onlinebible)
+    export_onlinebible_attach (filter_text);
+
+  
+  // The whole Bible goes in the order the separate exports would use.
+  // The OpenDocument export follows the book order as set by the user.
+  std::vector <int> books {book};
+  if (book == 0) {
+    if (odt)
+      books = filter_passage_get_ordered_books (bible);
+    else
+      books = database::bibles::get_books (bible);
+  }
+  for (const auto book2 : books) {
+    const std::vector <int> chapters = database::bibles::get_chapters (bible, book2);
+    for (const auto chapter : chapters) {
+      std::string usfm = database::bibles::get_chapter (bible, book2, chapter);
+      usfm = filter::string::trim (usfm);
+      // Use small chunks of USFM at a time for much better performance.
+      filter_text.add_usfm_code (usfm);
+      if (text)
+        export_text_usfm_chapter (bible, book2, chapter, usfm, stylesheet);
+    }
+  }
+  
+  
+  // One conversion feeds all outputs.
+  filter_text.run (stylesheet);
+
+  
+  if (html)
+    export_html_save (filter_text, bible, book, log);
+  if (text)
+    export_text_usfm_save (filter_text, bible, book, log);
+  if (odt)
+    export_odt_save (filter_text, bible, book, log);
+  if (esword)
+    export_esword_save (filter_text, bible, log);
+  if (onlinebible)
+    export_onlinebible_save (filter_text, bible, log);
+}
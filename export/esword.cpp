@@ -38,23 +38,11 @@
 
 void export_esword (const std::string& bible, bool log)
 {
-  const std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "esword"});
-  if (!file_or_dir_exists (directory))
-    filter_url_mkdir (directory);
-  
-  
-  const std::string filename = filter_url_create_path ({directory, "bible.bblx"});
-
-  
-  if (file_or_dir_exists (filename)) 
-    filter_url_unlink (filename);
-  
-  
   const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
   
   
   Filter_Text filter_text_bible = Filter_Text (bible);
-  filter_text_bible.esword_text = new Esword_Text (bible);
+  export_esword_attach (filter_text_bible, bible);
   const std::vector <int> books = database::bibles::get_books (bible);
   for (const auto book : books) {
     const std::vector <int> chapters = database::bibles::get_chapters (bible, book);
@@ -64,8 +52,34 @@ void export_esword (const std::string& bible, bool log)
     }
   }
   filter_text_bible.run (stylesheet);
-  filter_text_bible.esword_text->finalize ();
-  filter_text_bible.esword_text->createModule (filename);
+  export_esword_save (filter_text_bible, bible, log);
+}
+
+
+// Attaches the e-Sword module output to the text filter.
+void export_esword_attach (Filter_Text& filter_text, const std::string& bible)
+{
+  filter_text.esword_text = new Esword_Text (bible);
+}
+
+
+// Creates the e-Sword module from the text filter that has run.
+void export_esword_save (const Filter_Text& filter_text, const std::string& bible, const bool log)
+{
+  const std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "esword"});
+  if (!file_or_dir_exists (directory))
+    filter_url_mkdir (directory);
+  
+  
+  const std::string filename = filter_url_create_path ({directory, "bible.bblx"});
+
+  
+  if (file_or_dir_exists (filename)) 
+    filter_url_unlink (filename);
+  
+  
+  filter_text.esword_text->finalize ();
+  filter_text.esword_text->createModule (filename);
 
   
   Database_State::clearExport (bible, 0, export_logic::export_esword);
@@ -21,4 +21,8 @@
 
 #include <config/libraries.h>
 
+class Filter_Text;
+
 void export_esword (const std::string& bible, bool log);
+void export_esword_attach (Filter_Text& filter_text, const std::string& bible);
+void export_esword_save (const Filter_Text& filter_text, const std::string& bible, const bool log);
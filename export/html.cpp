@@ -40,6 +40,46 @@
 
 
 void export_html_book (const std::string& bible, const int book, const bool log)
+{
+  const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
+  
+  
+  Filter_Text filter_text = Filter_Text (bible);
+  export_html_attach (filter_text, bible);
+  
+  
+  // Load one book.
+  const std::vector <int> chapters = database::bibles::get_chapters (bible, book);
+  for (const auto chapter : chapters) {
+    // Get the USFM for this chapter.
+    std::string usfm = database::bibles::get_chapter (bible, book, chapter);
+    usfm = filter::string::trim (usfm);
+    // Use small chunks of USFM at a time for much better performance.
+    filter_text.add_usfm_code (usfm);
+  }
+  
+  
+  // Convert the USFM.
+  filter_text.run (stylesheet);
+  
+  
+  export_html_save (filter_text, bible, book, log);
+}
+
+
+// Attaches the html output to the text filter.
+void export_html_attach (Filter_Text& filter_text, const std::string& bible)
+{
+  filter_text.html_text_standard = new HtmlText (translate("Bible"));
+  filter_text.html_text_standard->custom_class = filter::css::get_class (bible);
+  if (database::config::bible::get_export_html_notes_on_hover(bible)) {
+    filter_text.html_text_standard->have_popup_notes();
+  }
+}
+
+
+// Saves the html produced by the text filter that has run.
+void export_html_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log)
 {
   // Create folders for the html export.
   const std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "html"});
@@ -72,29 +112,6 @@ void export_html_book (const std::string& bible, const int book, const bool log)
   }
   
   
-  Filter_Text filter_text = Filter_Text (bible);
-  filter_text.html_text_standard = new HtmlText (translate("Bible"));
-  filter_text.html_text_standard->custom_class = filter::css::get_class (bible);
-  if (database::config::bible::get_export_html_notes_on_hover(bible)) {
-    filter_text.html_text_standard->have_popup_notes();
-  }
-  
-  
-  // Load one book.
-  const std::vector <int> chapters = database::bibles::get_chapters (bible, book);
-  for (const auto chapter : chapters) {
-    // Get the USFM for this chapter.
-    std::string usfm = database::bibles::get_chapter (bible, book, chapter);
-    usfm = filter::string::trim (usfm);
-    // Use small chunks of USFM at a time for much better performance.
-    filter_text.add_usfm_code (usfm);
-  }
-  
-  
-  // Convert the USFM.
-  filter_text.run (stylesheet);
-  
-  
   // Save the html file.
   filter_text.html_text_standard->save (filename_html);
   
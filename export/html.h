@@ -21,4 +21,8 @@
 
 #include <config/libraries.h>
 
+class Filter_Text;
+
 void export_html_book (const std::string& bible, const int book, const bool log);
+void export_html_attach (Filter_Text& filter_text, const std::string& bible);
+void export_html_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log);
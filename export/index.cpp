@@ -67,33 +67,32 @@ void export_index ()
         export_logic::schedule_web_index (bible, false);
       }
 
-      if (database::config::bible::get_export_hml_during_night (bible)) {
-        export_logic::schedule_html (bible, false);
-      }
-      
       if (database::config::bible::get_export_usfm_during_night (bible)) {
         export_logic::schedule_usfm (bible, false);
       }
       
-      if (database::config::bible::get_export_text_during_night (bible)) {
-        export_logic::schedule_text_and_basic_usfm (bible, false);
-      }
-      
-      if (database::config::bible::get_export_odt_during_night (bible)) {
-        export_logic::schedule_open_document (bible, false);
-      }
-      
       if (database::config::bible::get_generate_info_during_night (bible)) {
         export_logic::schedule_info (bible, false);
       }
       
+      // The formats that convert the USFM through the text filter share one conversion per book.
+      std::vector <int> formats {};
+      if (database::config::bible::get_export_hml_during_night (bible)) {
+        formats.push_back (export_logic::export_html);
+      }
+      if (database::config::bible::get_export_text_during_night (bible)) {
+        formats.push_back (export_logic::export_text_and_basic_usfm);
+      }
+      if (database::config::bible::get_export_odt_during_night (bible)) {
+        formats.push_back (export_logic::export_opendocument);
+      }
       if (database::config::bible::get_export_e_sword_during_night (bible)) {
-        export_logic::schedule_e_sword (bible, false);
+        formats.push_back (export_logic::export_esword);
       }
-
       if (database::config::bible::get_export_online_bible_during_night (bible)) {
-        export_logic::schedule_online_bible (bible, false);
+        formats.push_back (export_logic::export_online_bible);
       }
+      export_logic::schedule_combined (bible, formats, false);
       
     }
   }
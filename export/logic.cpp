@@ -119,6 +119,56 @@ void export_logic::schedule_e_sword (const std::string& bible, bool log)
 }
 
 
+// Schedule exports to the formats that are produced from one conversion of the USFM.
+// $formats: The requested formats among html, text and basic USFM, OpenDocument, e-Sword, and Online Bible.
+// There is one task per book and one task for the whole Bible,
+// and each of those converts the USFM once for all formats it produces.
+// The tasks for the books run in parallel on the tasks thread pool.
+void export_logic::schedule_combined (const std::string& bible, const std::vector <int>& formats, bool log)
+{
+  const auto requested = [&formats] (const int format) {
+    return std::find (formats.cbegin (), formats.cend (), format) != formats.cend ();
+  };
+  
+  // The formats produced per book.
+  std::vector <std::string> book_formats {};
+  for (const int format : {export_html, export_text_and_basic_usfm, export_opendocument}) {
+    if (requested (format))
+      book_formats.push_back (std::to_string (format));
+  }
+
+  // The formats produced for the whole Bible.
+  std::vector <std::string> bible_formats {};
+  for (const int format : {export_esword, export_online_bible}) {
+    if (requested (format))
+      bible_formats.push_back (std::to_string (format));
+  }
+  // The OpenDocument export of the whole Bible follows the book order as set by the user.
+  // It can share the conversion with the e-Sword and Online Bible exports
+  // only in case that order is the same as the standard order they use.
+  bool separate_bible_odt {false};
+  if (requested (export_opendocument)) {
+    if (bible_formats.empty () || (filter_passage_get_ordered_books (bible) == database::bibles::get_books (bible)))
+      bible_formats.push_back (std::to_string (export_opendocument));
+    else
+      separate_bible_odt = true;
+  }
+
+  if (!book_formats.empty ()) {
+    const std::vector <int> books = database::bibles::get_books (bible);
+    for (const auto book : books) {
+      tasks_logic_queue (tasks::enums::task::export_combined, {bible, std::to_string (book), filter::string::implode (book_formats, " "), filter::string::convert_to_string (log)});
+    }
+  }
+  if (!bible_formats.empty ()) {
+    tasks_logic_queue (tasks::enums::task::export_combined, {bible, "0", filter::string::implode (bible_formats, " "), filter::string::convert_to_string (log)});
+  }
+  if (separate_bible_odt) {
+    tasks_logic_queue (tasks::enums::task::export_odt, {bible, "0", filter::string::convert_to_string (log)});
+  }
+}
+
+
 // The main exports directory.
 std::string export_logic::main_directory ()
 {
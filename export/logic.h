@@ -35,6 +35,7 @@ void schedule_web (const std::string & bible, bool log);
 void schedule_web_index (const std::string & bible, bool log);
 void schedule_online_bible (const std::string & bible, bool log);
 void schedule_e_sword (const std::string & bible, bool log);
+void schedule_combined (const std::string & bible, const std::vector <int> & formats, bool log);
 std::string main_directory ();
 std::string bible_directory (const std::string & bible);
 std::string usfm_directory (const std::string & bible, int type);
@@ -40,27 +40,11 @@
 
 void export_odt_book (std::string bible, int book, bool log)
 {
-  // Create folders for the OpenDocument export.
-  std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "opendocument"});
-  if (!file_or_dir_exists (directory)) filter_url_mkdir (directory);
-  
-  
-  // Filenames for the various types of OpenDocument files.
-  std::string basename = export_logic::base_book_filename (bible, book);
-  std::string standardFilename = filter_url_create_path ({directory, basename + "_standard.odt"});
-  std::string textOnlyFilename = filter_url_create_path ({directory, basename + "_text_only.odt"});
-  std::string textAndCitationsFilename = filter_url_create_path ({directory, basename + "_text_and_note_citations.odt"});
-  std::string notesFilename = filter_url_create_path ({directory, basename + "_notes.odt"});
-
-  
   const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
   
   
   Filter_Text filter_text = Filter_Text (bible);
-  filter_text.odf_text_standard = new odf_text (bible);
-  filter_text.odf_text_text_only = new odf_text (bible);
-  filter_text.odf_text_text_and_note_citations = new odf_text (bible);
-  filter_text.odf_text_notes = new odf_text (bible);
+  export_odt_attach (filter_text, bible);
   
   
   if (book == 0) {
@@ -91,12 +75,42 @@ void export_odt_book (std::string bible, int book, bool log)
   filter_text.run (stylesheet);
   
   
+  export_odt_save (filter_text, bible, book, log);
+}
+
+
+// Attaches the four OpenDocument outputs to the text filter.
+void export_odt_attach (Filter_Text& filter_text, const std::string& bible)
+{
+  filter_text.odf_text_standard = new odf_text (bible);
+  filter_text.odf_text_text_only = new odf_text (bible);
+  filter_text.odf_text_text_and_note_citations = new odf_text (bible);
+  filter_text.odf_text_notes = new odf_text (bible);
+}
+
+
+// Saves the OpenDocument files produced by the text filter that has run.
+void export_odt_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log)
+{
+  // Create folders for the OpenDocument export.
+  std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "opendocument"});
+  if (!file_or_dir_exists (directory)) filter_url_mkdir (directory);
+  
+  
+  // Filenames for the various types of OpenDocument files.
+  std::string basename = export_logic::base_book_filename (bible, book);
+  std::string standardFilename = filter_url_create_path ({directory, basename + "_standard.odt"});
+  std::string textOnlyFilename = filter_url_create_path ({directory, basename + "_text_only.odt"});
+  std::string textAndCitationsFilename = filter_url_create_path ({directory, basename + "_text_and_note_citations.odt"});
+  std::string notesFilename = filter_url_create_path ({directory, basename + "_notes.odt"});
+
+  
   // Save text files and optionally the images included in the text.
   filter_text.odf_text_standard->save (standardFilename);
   filter_text.odf_text_text_only->save (textOnlyFilename);
   filter_text.odf_text_text_and_note_citations->save (textAndCitationsFilename);
   filter_text.odf_text_notes->save (notesFilename);
-  for (auto src : filter_text.image_sources) {
+  for (const auto& src : filter_text.image_sources) {
     std::string contents = database::bible_images::get(src);
     std::string path = filter_url_create_path ({directory, src});
     filter_url_file_put_contents(path, contents);
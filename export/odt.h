@@ -21,4 +21,8 @@
 
 #include <config/libraries.h>
 
+class Filter_Text;
+
 void export_odt_book (std::string bible, int book, bool log);
+void export_odt_attach (Filter_Text& filter_text, const std::string& bible);
+void export_odt_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log);
@@ -39,18 +39,11 @@
 
 void export_onlinebible (std::string bible, bool log)
 {
-  std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "onlinebible"});
-  if (!file_or_dir_exists (directory)) filter_url_mkdir (directory);
-  
-  
-  std::string filename = filter_url_create_path ({directory, "bible.exp"});
-
-  
   const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
   
   
   Filter_Text filter_text_bible = Filter_Text (bible);
-  filter_text_bible.onlinebible_text = new OnlineBible_Text ();
+  export_onlinebible_attach (filter_text_bible);
   std::vector <int> books = database::bibles::get_books (bible);
   for (auto book : books) {
     std::vector <int> chapters = database::bibles::get_chapters (bible, book);
@@ -61,7 +54,28 @@ void export_onlinebible (std::string bible, bool log)
     }
   }
   filter_text_bible.run (stylesheet);
-  filter_text_bible.onlinebible_text->save (filename);
+  export_onlinebible_save (filter_text_bible, bible, log);
+}
+
+
+// Attaches the Online Bible output to the text filter.
+void export_onlinebible_attach (Filter_Text& filter_text)
+{
+  filter_text.onlinebible_text = new OnlineBible_Text ();
+}
+
+
+// Saves the Online Bible input file produced by the text filter that has run.
+void export_onlinebible_save (const Filter_Text& filter_text, const std::string& bible, const bool log)
+{
+  std::string directory = filter_url_create_path ({export_logic::bible_directory (bible), "onlinebible"});
+  if (!file_or_dir_exists (directory)) filter_url_mkdir (directory);
+  
+  
+  std::string filename = filter_url_create_path ({directory, "bible.exp"});
+
+  
+  filter_text.onlinebible_text->save (filename);
 
   
   Database_State::clearExport (bible, 0, export_logic::export_online_bible);
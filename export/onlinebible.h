@@ -21,4 +21,8 @@
 
 #include <config/libraries.h>
 
+class Filter_Text;
+
 void export_onlinebible (std::string bible, bool log);
+void export_onlinebible_attach (Filter_Text& filter_text);
+void export_onlinebible_save (const Filter_Text& filter_text, const std::string& bible, const bool log);
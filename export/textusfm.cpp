@@ -36,45 +36,25 @@
 #include <styles/sheets.h>
 
 
+static std::string export_text_usfm_basic_filename (const std::string& bible, const int book)
+{
+  return filter_url_create_path ({export_logic::usfm_directory (bible, 1), export_logic::base_book_filename (bible, book) + ".usfm"});
+}
+
+
 void export_text_usfm_book (std::string bible, int book, bool log)
 {
-  // Create folders for the clear text and the basic USFM exports.
-  std::string usfmDirectory = export_logic::usfm_directory (bible, 1);
-  if (!file_or_dir_exists (usfmDirectory)) filter_url_mkdir (usfmDirectory);
-  std::string textDirectory = filter_url_create_path ({export_logic::bible_directory (bible), "text"});
-  if (!file_or_dir_exists (textDirectory)) filter_url_mkdir (textDirectory);
-  
-  
-  // Filenames for text and usfm.
-  std::string usfmFilename = filter_url_create_path ({usfmDirectory, export_logic::base_book_filename (bible, book) + ".usfm"});
-  std::string textFilename = filter_url_create_path ({textDirectory, export_logic::base_book_filename (bible, book) + ".txt"});
-  
-  
   const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
   
   
   Filter_Text filter_text_book = Filter_Text (bible);
-  filter_text_book.text_text = new Text_Text ();
-  
-  
-  // Basic USFM.
-  if (file_or_dir_exists (usfmFilename)) filter_url_unlink (usfmFilename);
-  std::string basicUsfm = "\\id " + database::books::get_usfm_from_id (static_cast<book_id>(book)) + "\n";
-  filter_url_file_put_contents_append (usfmFilename, basicUsfm);
+  export_text_usfm_attach (filter_text_book, bible, book);
   
   
   std::vector <int> chapters = database::bibles::get_chapters (bible, book);
   for (auto chapter : chapters) {
     
     
-    // The text filter for this chapter.
-    Filter_Text filter_text_chapter = Filter_Text (bible);
-    
-    
-    // Basic USFM for this chapter.
-    filter_text_chapter.initializeHeadingsAndTextPerVerse (false);
-    
-    
     // Get the USFM code for the current chapter.
     std::string chapter_data = database::bibles::get_chapter (bible, book, chapter);
     chapter_data = filter::string::trim (chapter_data);
@@ -83,27 +63,7 @@ void export_text_usfm_book (std::string bible, int book, bool log)
     // Add the chapter's USFM code to the Text_* filter for the book, and for the chapter.
     // Use small chunks of USFM at a time. This provides much better performance.
     filter_text_book.add_usfm_code (chapter_data);
-    filter_text_chapter.add_usfm_code (chapter_data);
-    
-    
-    // Convert the chapter
-    filter_text_chapter.run (stylesheet);
-    
-    
-    // Deal with basic USFM.
-    if (chapter > 0) {
-      std::map <int, std::string> verses_text = filter_text_chapter.getVersesText ();
-      basicUsfm = "\\c " + std::to_string (chapter) + "\n";
-      basicUsfm += "\\p\n";
-      for (auto element : verses_text) {
-        int verse = element.first;
-        std::string text = element.second;
-        basicUsfm += "\\v " + std::to_string (verse) + " " + text + "\n";
-      }
-      filter_url_file_put_contents_append (usfmFilename, basicUsfm);
-    }
-    
-    
+    export_text_usfm_chapter (bible, book, chapter, chapter_data, stylesheet);
   }
   
   
@@ -111,8 +71,71 @@ void export_text_usfm_book (std::string bible, int book, bool log)
   filter_text_book.run (stylesheet);
   
   
+  export_text_usfm_save (filter_text_book, bible, book, log);
+}
+
+
+// Attaches the plain text output to the text filter for the book,
+// and starts the basic USFM file for that book.
+void export_text_usfm_attach (Filter_Text& filter_text, const std::string& bible, const int book)
+{
+  // Create folders for the clear text and the basic USFM exports.
+  std::string usfmDirectory = export_logic::usfm_directory (bible, 1);
+  if (!file_or_dir_exists (usfmDirectory)) filter_url_mkdir (usfmDirectory);
+  std::string textDirectory = filter_url_create_path ({export_logic::bible_directory (bible), "text"});
+  if (!file_or_dir_exists (textDirectory)) filter_url_mkdir (textDirectory);
+  
+  
+  filter_text.text_text = new Text_Text ();
+  
+  
+  // Basic USFM.
+  std::string usfmFilename = export_text_usfm_basic_filename (bible, book);
+  if (file_or_dir_exists (usfmFilename)) filter_url_unlink (usfmFilename);
+  std::string basicUsfm = "\\id " + database::books::get_usfm_from_id (static_cast<book_id>(book)) + "\n";
+  filter_url_file_put_contents_append (usfmFilename, basicUsfm);
+}
+
+
+// Appends one chapter to the basic USFM file of the book.
+void export_text_usfm_chapter (const std::string& bible, const int book, const int chapter, const std::string& usfm, const std::string& stylesheet)
+{
+  // The text filter for this chapter.
+  Filter_Text filter_text_chapter = Filter_Text (bible);
+  
+  
+  // Basic USFM for this chapter.
+  filter_text_chapter.initializeHeadingsAndTextPerVerse (false);
+  filter_text_chapter.add_usfm_code (usfm);
+  
+  
+  // Convert the chapter
+  filter_text_chapter.run (stylesheet);
+  
+  
+  // Deal with basic USFM.
+  if (chapter > 0) {
+    std::map <int, std::string> verses_text = filter_text_chapter.getVersesText ();
+    std::string basicUsfm = "\\c " + std::to_string (chapter) + "\n";
+    basicUsfm += "\\p\n";
+    for (auto element : verses_text) {
+      int verse = element.first;
+      std::string text = element.second;
+      basicUsfm += "\\v " + std::to_string (verse) + " " + text + "\n";
+    }
+    filter_url_file_put_contents_append (export_text_usfm_basic_filename (bible, book), basicUsfm);
+  }
+}
+
+
+// Saves the plain text produced by the text filter for the book that has run.
+void export_text_usfm_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log)
+{
+  std::string textFilename = filter_url_create_path ({export_logic::bible_directory (bible), "text", export_logic::base_book_filename (bible, book) + ".txt"});
+  
+  
   // Save the text export.
-  filter_text_book.text_text->save (textFilename);
+  filter_text.text_text->save (textFilename);
   
   
   // Clear the flag that indicated this export.
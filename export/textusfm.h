@@ -21,4 +21,9 @@
 
 #include <config/libraries.h>
 
+class Filter_Text;
+
 void export_text_usfm_book (std::string bible, int book, bool log);
+void export_text_usfm_attach (Filter_Text& filter_text, const std::string& bible, const int book);
+void export_text_usfm_chapter (const std::string& bible, const int book, const int chapter, const std::string& usfm, const std::string& stylesheet);
+void export_text_usfm_save (const Filter_Text& filter_text, const std::string& bible, const int book, const bool log);
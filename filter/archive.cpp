@@ -38,12 +38,16 @@ namespace filter::archive {
 // Returns the path to the compressed archive it created.
 std::string zip_folder (std::string folder)
 {
-#ifdef HAVE_CLOUD
-  return zip_folder_shell_internal (folder);
-#endif
-#ifdef HAVE_CLIENT
-  return zip_folder_miniz_internal (folder);
-#endif
+  if (!file_or_dir_exists (folder)) return std::string();
+  std::string zippedfile = filter_url_tempfile () + ".zip";
+  const int fd = open (zippedfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  bool success = (fd >= 0) && zip_folder_to_fd (folder, fd);
+  if ((fd >= 0) && (close (fd) != 0)) success = false;
+  if (!success) {
+    filter_url_unlink (zippedfile);
+    zippedfile.clear();
+  }
+  return zippedfile;
 }
 
 
@@ -242,6 +246,65 @@ std::string unzip_miniz_internal (std::string zipfile)
 // Compresses a file identified by $filename into gzipped tar format.
 // Returns the path to the compressed archive it created.
 std::string tar_gzip_file (std::string filename)
+{
+  if (!file_or_dir_exists (filename)) return std::string();
+  std::string tarball = filter_url_tempfile () + ".tar.gz";
+  const int fd = open (tarball.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  bool success = (fd >= 0) && tar_gzip_to_fd (filter_url_dirname (filename), {filter_url_basename (filename)}, fd);
+  if ((fd >= 0) && (close (fd) != 0)) success = false;
+  if (!success) {
+    filter_url_unlink (tarball);
+    tarball.clear();
+  }
+  return tarball;
+}
+
+
+// Compresses a $folder into gzipped tar format.
+// Returns the path to the compressed archive it created.
+std::string tar_gzip_folder (std::string folder)
+{
+  if (!file_or_dir_exists (folder)) return std::string();
+  std::vector <std::string> files;
+  filter_url_recursive_scandir (folder, files);
+  for (auto& file : files) {
+    file.erase (0, folder.size () + 1);
+  }
+  std::string tarball = filter_url_tempfile () + ".tar.gz";
+  const int fd = open (tarball.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  bool success = (fd >= 0) && tar_gzip_to_fd (folder, files, fd);
+  if ((fd >= 0) && (close (fd) != 0)) success = false;
+  if (!success) {
+    filter_url_unlink (tarball);
+    tarball.clear();
+  }
+  return tarball;
+}
+
+
+// Uncompresses a .tar.gz archive identified by $file.
+// Returns the path to the folder it created.
+std::string untar_gzip (std::string file)
+{
+  const int fd = open (file.c_str(), O_RDONLY);
+  if (fd < 0) return std::string();
+  std::string folder = filter_url_tempfile ();
+  filter_url_mkdir (folder);
+  folder.append (DIRECTORY_SEPARATOR);
+  const bool success = untar_gzip_from_fd (fd, folder);
+  close (fd);
+  if (!success) {
+    filter_url_rmdir (folder);
+    folder.clear();
+    database::logs::log ("Failed to uncompress " + file);
+  }
+  return folder;
+}
+
+
+// Compresses a file identified by $filename into gzipped tar format.
+// Returns the path to the compressed archive it created.
+std::string tar_gzip_file_shell_internal (std::string filename)
 {
   std::string tarball = filter_url_tempfile () + ".tar.gz";
   const std::string dirname = filter_url_escape_shell_argument (filter_url_dirname (filename));
@@ -268,7 +331,7 @@ std::string tar_gzip_file (std::string filename)
 
 // Compresses a $folder into gzipped tar format.
 // Returns the path to the compressed archive it created.
-std::string tar_gzip_folder (std::string folder)
+std::string tar_gzip_folder_shell_internal (std::string folder)
 {
   std::string tarball = filter_url_tempfile () + ".tar.gz";
   folder = filter_url_escape_shell_argument (folder);
@@ -294,7 +357,7 @@ std::string tar_gzip_folder (std::string folder)
 
 // Uncompresses a .tar.gz archive identified by $file.
 // Returns the path to the folder it created.
-std::string untar_gzip (std::string file)
+std::string untar_gzip_shell_internal (std::string file)
 {
   file = filter_url_escape_shell_argument (file);
   std::string folder = filter_url_tempfile ();
@@ -450,6 +513,577 @@ std::string microtar_unpack (std::string tarball, std::string directory)
 }
 
 
+// The size of the chunks in which the streaming archivers read and write data.
+// This bounds their memory usage, whatever the size of the archive.
+constexpr size_t stream_chunk_size {65536};
+
+
+// Writes all $size bytes of $data to file descriptor $fd, which may also be a pipe or a socket.
+static bool write_to_fd (const int fd, const void* data, size_t size)
+{
+  const char* bytes = static_cast<const char*>(data);
+  while (size) {
+    const auto written = write (fd, bytes, std::min (size, stream_chunk_size));
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+
+// Reads up to $size bytes from file descriptor $fd into $data.
+// Returns the number of bytes read, 0 at the end of the input, or -1 on failure.
+static long read_from_fd (const int fd, void* data, const size_t size)
+{
+  while (true) {
+    const auto count = read (fd, data, std::min (size, stream_chunk_size));
+    if ((count < 0) && (errno == EINTR))
+      continue;
+    return static_cast<long>(count);
+  }
+}
+
+
+// Compresses data into gzip format and writes it to a file descriptor as it goes.
+// It keeps one chunk of input plus the state of the compressor in memory.
+class gzip_writer final
+{
+public:
+  explicit gzip_writer (const int fd) : m_fd (fd)
+  {
+    // The gzip header: Magic, deflate, no flags, no time, no extra flags, Unix.
+    constexpr unsigned char header [10] {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+    m_ok = write_to_fd (m_fd, header, sizeof (header));
+    // Raw deflate, as the gzip format has its own header and trailer.
+    const mz_uint flags = tdefl_create_comp_flags_from_zip_params (MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    if (tdefl_init (m_compressor.get(), put_buf, this, static_cast<int>(flags)) != TDEFL_STATUS_OKAY)
+      m_ok = false;
+    m_buffer.reserve (stream_chunk_size);
+  }
+  gzip_writer(const gzip_writer&) = delete;
+  gzip_writer& operator=(const gzip_writer&) = delete;
+  bool write (const void* data, const size_t size)
+  {
+    m_crc = static_cast<mz_uint32>(mz_crc32 (m_crc, static_cast<const unsigned char*>(data), size));
+    m_size += static_cast<mz_uint32>(size);
+    // Collect small writes into a chunk before compressing them.
+    if (m_buffer.size () + size > stream_chunk_size)
+      compress (TDEFL_NO_FLUSH);
+    if (size >= stream_chunk_size) {
+      if (tdefl_compress_buffer (m_compressor.get(), data, size, TDEFL_NO_FLUSH) != TDEFL_STATUS_OKAY)
+        m_ok = false;
+    }
+    else
+      m_buffer.append (static_cast<const char*>(data), size);
+    return m_ok;
+  }
+  bool finish ()
+  {
+    compress (TDEFL_FINISH);
+    // The gzip trailer: The CRC32 and the size of the input, both little endian.
+    unsigned char trailer [8];
+    for (int i = 0; i < 4; i++) {
+      trailer [i] = static_cast<unsigned char>(m_crc >> (8 * i));
+      trailer [i + 4] = static_cast<unsigned char>(m_size >> (8 * i));
+    }
+    if (m_ok)
+      m_ok = write_to_fd (m_fd, trailer, sizeof (trailer));
+    return m_ok;
+  }
+private:
+  int m_fd {-1};
+  bool m_ok {false};
+  std::unique_ptr<tdefl_compressor> m_compressor {std::make_unique<tdefl_compressor>()};
+  std::string m_buffer {};
+  mz_uint32 m_crc {MZ_CRC32_INIT};
+  mz_uint32 m_size {0};
+  void compress (const tdefl_flush flush)
+  {
+    const tdefl_status status = tdefl_compress_buffer (m_compressor.get(), m_buffer.data (), m_buffer.size (), flush);
+    if ((status != TDEFL_STATUS_OKAY) && (status != TDEFL_STATUS_DONE))
+      m_ok = false;
+    m_buffer.clear ();
+  }
+  static mz_bool put_buf (const void* buffer, int length, void* user)
+  {
+    auto* writer = static_cast<gzip_writer*>(user);
+    if (writer->m_ok)
+      writer->m_ok = write_to_fd (writer->m_fd, buffer, static_cast<size_t>(length));
+    return writer->m_ok;
+  }
+};
+
+
+// Reads data in gzip format from a file descriptor and decompresses it as it goes.
+// It keeps one chunk of input plus the 32 kbytes deflate dictionary in memory.
+// It reads forward only, so the input can also be a pipe or a socket.
+class gzip_reader final
+{
+public:
+  explicit gzip_reader (const int fd) : m_fd (fd)
+  {
+    tinfl_init (m_inflator.get());
+    m_ok = read_header ();
+  }
+  gzip_reader(const gzip_reader&) = delete;
+  gzip_reader& operator=(const gzip_reader&) = delete;
+  // Reads up to $size decompressed bytes into $data.
+  // Returns the number of bytes read, which is less than $size only at the end or on failure.
+  size_t read (void* data, const size_t size)
+  {
+    char* bytes = static_cast<char*>(data);
+    size_t done {0};
+    while (m_ok && (done < size)) {
+      if (m_pending) {
+        const size_t count = std::min (m_pending, size - done);
+        memcpy (bytes + done, m_dictionary.get() + m_pending_offset, count);
+        m_pending_offset += count;
+        m_pending -= count;
+        done += count;
+        continue;
+      }
+      if (m_end)
+        break;
+      inflate ();
+    }
+    return done;
+  }
+  // Whether all input so far was valid, including the checksum in the trailer once at the end.
+  bool ok () const
+  {
+    return m_ok;
+  }
+private:
+  int m_fd {-1};
+  bool m_ok {false};
+  bool m_end {false};
+  std::unique_ptr<tinfl_decompressor> m_inflator {std::make_unique<tinfl_decompressor>()};
+  std::unique_ptr<mz_uint8[]> m_dictionary {std::make_unique<mz_uint8[]>(TINFL_LZ_DICT_SIZE)};
+  size_t m_dictionary_offset {0};
+  size_t m_pending_offset {0};
+  size_t m_pending {0};
+  std::unique_ptr<mz_uint8[]> m_input {std::make_unique<mz_uint8[]>(stream_chunk_size)};
+  size_t m_input_offset {0};
+  size_t m_input_size {0};
+  bool m_input_end {false};
+  mz_uint32 m_crc {MZ_CRC32_INIT};
+  mz_uint32 m_size {0};
+  bool fill_input ()
+  {
+    if (m_input_offset < m_input_size)
+      return true;
+    if (m_input_end)
+      return false;
+    const long count = read_from_fd (m_fd, m_input.get(), stream_chunk_size);
+    if (count < 0)
+      m_ok = false;
+    if (count <= 0) {
+      m_input_end = true;
+      return false;
+    }
+    m_input_offset = 0;
+    m_input_size = static_cast<size_t>(count);
+    return true;
+  }
+  bool read_byte (mz_uint8& byte)
+  {
+    if (!fill_input ())
+      return false;
+    byte = m_input [m_input_offset++];
+    return true;
+  }
+  bool skip_string ()
+  {
+    mz_uint8 byte {1};
+    while (byte)
+      if (!read_byte (byte))
+        return false;
+    return true;
+  }
+  bool read_header ()
+  {
+    mz_uint8 header [10];
+    for (auto& byte : header)
+      if (!read_byte (byte))
+        return false;
+    if ((header [0] != 0x1f) || (header [1] != 0x8b) || (header [2] != 8))
+      return false;
+    const mz_uint8 flags = header [3];
+    mz_uint8 byte {0};
+    // Skip the extra field.
+    if (flags & 4) {
+      mz_uint8 low {0}, high {0};
+      if (!read_byte (low) || !read_byte (high))
+        return false;
+      for (int i = 0; i < (low | (high << 8)); i++)
+        if (!read_byte (byte))
+          return false;
+    }
+    // Skip the original file name and the comment.
+    if ((flags & 8) && !skip_string ())
+      return false;
+    if ((flags & 16) && !skip_string ())
+      return false;
+    // Skip the header CRC.
+    if (flags & 2)
+      if (!read_byte (byte) || !read_byte (byte))
+        return false;
+    return true;
+  }
+  void inflate ()
+  {
+    const bool more_input = fill_input ();
+    size_t in_bytes = m_input_size - m_input_offset;
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - m_dictionary_offset;
+    const tinfl_status status = tinfl_decompress (m_inflator.get(), m_input.get() + m_input_offset, &in_bytes, m_dictionary.get(), m_dictionary.get() + m_dictionary_offset, &out_bytes, more_input ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+    m_input_offset += in_bytes;
+    m_crc = static_cast<mz_uint32>(mz_crc32 (m_crc, m_dictionary.get() + m_dictionary_offset, out_bytes));
+    m_size += static_cast<mz_uint32>(out_bytes);
+    m_pending_offset = m_dictionary_offset;
+    m_pending = out_bytes;
+    m_dictionary_offset = (m_dictionary_offset + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+    if (status == TINFL_STATUS_DONE) {
+      m_end = true;
+      m_ok = read_trailer ();
+    }
+    else if (status < TINFL_STATUS_DONE)
+      m_ok = false;
+    else if ((status == TINFL_STATUS_NEEDS_MORE_INPUT) && !more_input)
+      m_ok = false;
+  }
+  bool read_trailer ()
+  {
+    mz_uint8 trailer [8];
+    for (auto& byte : trailer)
+      if (!read_byte (byte))
+        return false;
+    mz_uint32 crc {0}, size {0};
+    for (int i = 3; i >= 0; i--) {
+      crc = (crc << 8) | trailer [i];
+      size = (size << 8) | trailer [i + 4];
+    }
+    return (crc == m_crc) && (size == m_size);
+  }
+};
+
+
+// The place where the zip writer sends its output.
+struct zip_output final
+{
+  int fd {-1};
+  mz_uint64 offset {0};
+};
+
+
+// Sends zip data to a file descriptor.
+// The writer of miniz adds files with data descriptors, so it writes sequentially.
+static size_t zip_write (void* opaque, mz_uint64 offset, const void* buffer, size_t size)
+{
+  auto* output = static_cast<zip_output*>(opaque);
+  // The output can be a pipe or a socket, so it cannot go back.
+  if (offset != output->offset)
+    return 0;
+  if (!write_to_fd (output->fd, buffer, size))
+    return 0;
+  output->offset += size;
+  return size;
+}
+
+
+// Compresses a $folder into zip format and writes the archive to file descriptor $fd.
+// It streams each file in chunks, so memory usage does not depend on the size of the files.
+// Returns true on success.
+bool zip_folder_to_fd (const std::string& folder, const int fd)
+{
+  if (!file_or_dir_exists (folder))
+    return false;
+  zip_output output {.fd = fd, .offset = 0};
+  mz_zip_archive zip_archive;
+  memset (&zip_archive, 0, sizeof (zip_archive));
+  zip_archive.m_pWrite = zip_write;
+  zip_archive.m_pIO_opaque = &output;
+  if (!mz_zip_writer_init (&zip_archive, 0)) {
+    database::logs::log ("mz_zip_writer_init failed");
+    return false;
+  }
+  bool success {true};
+  std::vector <std::string> paths;
+  filter_url_recursive_scandir (folder, paths);
+  for (const auto& path : paths) {
+    std::string file = path.substr (folder.size () + 1);
+#ifdef HAVE_WINDOWS
+    // The mzip library works with forward slashes.
+    file = filter::string::replace (DIRECTORY_SEPARATOR, "/", file);
+#endif
+    if (filter_url_is_dir (path)) {
+      file.append ("/");
+      success = mz_zip_writer_add_mem (&zip_archive, file.c_str(), nullptr, 0, MZ_DEFAULT_LEVEL);
+    } else {
+      struct stat file_status {};
+      FILE* input = fopen (path.c_str(), "rb");
+      if (input && (stat (path.c_str(), &file_status) == 0)) {
+        const MZ_TIME_T modified = file_status.st_mtime;
+        success = mz_zip_writer_add_cfile (&zip_archive, file.c_str(), input, static_cast<mz_uint64>(file_status.st_size), &modified, nullptr, 0, MZ_DEFAULT_LEVEL, nullptr, 0, nullptr, 0);
+      }
+      else success = false;
+      if (input) fclose (input);
+    }
+    if (!success) {
+      database::logs::log ("Failed to add " + path + " to zip archive");
+      break;
+    }
+  }
+  if (success)
+    success = mz_zip_writer_finalize_archive (&zip_archive);
+  mz_zip_writer_end (&zip_archive);
+  return success;
+}
+
+
+// Writes to the gzip writer on behalf of the microtar library.
+static int tar_write (mtar_t* tar, const void* data, unsigned size)
+{
+  auto* writer = static_cast<gzip_writer*>(tar->stream);
+  return writer->write (data, size) ? MTAR_ESUCCESS : MTAR_EWRITEFAIL;
+}
+
+
+// The maximum length of a name in a plain tar header, without the terminating null.
+constexpr size_t tar_name_length {99};
+
+
+// Writes a GNU long name record, for names that do not fit in a plain tar header.
+static int tar_write_long_name (mtar_t* tar, const std::string& name)
+{
+  mtar_header_t header {};
+  snprintf (header.name, sizeof (header.name), "%s", "././@LongLink");
+  header.size = static_cast<unsigned>(name.size () + 1);
+  header.type = 'L';
+  header.mode = 0644;
+  int result = mtar_write_header (tar, &header);
+  if (result == MTAR_ESUCCESS)
+    result = mtar_write_data (tar, name.c_str(), header.size);
+  return result;
+}
+
+
+// Compresses $files, relative to $directory, into gzipped tar format.
+// It writes the archive to file descriptor $fd.
+// It streams each file in chunks, so memory usage does not depend on the size of the files.
+// Returns true on success.
+bool tar_gzip_to_fd (const std::string& directory, const std::vector <std::string>& files, const int fd)
+{
+  gzip_writer writer (fd);
+  mtar_t tar {};
+  tar.write = tar_write;
+  tar.stream = &writer;
+  std::vector <char> buffer (stream_chunk_size);
+  int result {MTAR_ESUCCESS};
+  for (const auto& file : files) {
+    const std::string path = filter_url_create_path ({directory, file});
+    std::string name = file;
+#ifdef HAVE_WINDOWS
+    name = filter::string::replace (DIRECTORY_SEPARATOR, "/", name);
+#endif
+    const bool is_dir = filter_url_is_dir (path);
+    if (is_dir)
+      name.append ("/");
+    if (name.size () > tar_name_length)
+      result = tar_write_long_name (&tar, name);
+    if (result != MTAR_ESUCCESS)
+      break;
+    if (is_dir) {
+      result = mtar_write_dir_header (&tar, name.c_str());
+      if (result != MTAR_ESUCCESS)
+        break;
+      continue;
+    }
+    struct stat file_status {};
+    if ((stat (path.c_str(), &file_status) != 0) || (file_status.st_size > std::numeric_limits<unsigned>::max ())) {
+      database::logs::log ("Cannot add " + path + " to tarball");
+      result = MTAR_EFAILURE;
+      break;
+    }
+    const int input = open (path.c_str(), O_RDONLY);
+    if (input < 0) {
+      result = MTAR_EOPENFAIL;
+      break;
+    }
+    result = mtar_write_file_header (&tar, name.c_str(), static_cast<unsigned>(file_status.st_size));
+    auto remaining = static_cast<size_t>(file_status.st_size);
+    while ((result == MTAR_ESUCCESS) && remaining) {
+      const long count = read_from_fd (input, buffer.data (), std::min (buffer.size (), remaining));
+      if (count <= 0)
+        result = MTAR_EREADFAIL;
+      else {
+        result = mtar_write_data (&tar, buffer.data (), static_cast<unsigned>(count));
+        remaining -= static_cast<size_t>(count);
+      }
+    }
+    close (input);
+    if (result != MTAR_ESUCCESS)
+      break;
+  }
+  if (result == MTAR_ESUCCESS)
+    result = mtar_finalize (&tar);
+  if (result != MTAR_ESUCCESS)
+    database::logs::log (std::string("Failed to create tarball: ") + mtar_strerror (result));
+  const bool success = writer.finish ();
+  return success && (result == MTAR_ESUCCESS);
+}
+
+
+// The size of a tar record.
+constexpr size_t tar_record_size {512};
+
+
+// Returns the value of a numeric field in a tar header.
+static uint64_t tar_number (const char* field, const size_t size)
+{
+  uint64_t value {0};
+  // GNU tar stores large numbers in base-256.
+  if (static_cast<unsigned char>(field [0]) & 0x80) {
+    value = static_cast<unsigned char>(field [0]) & 0x7f;
+    for (size_t i = 1; i < size; i++)
+      value = (value << 8) | static_cast<unsigned char>(field [i]);
+    return value;
+  }
+  for (size_t i = 0; i < size; i++) {
+    if (field [i] == ' ')
+      continue;
+    if ((field [i] < '0') || (field [i] > '7'))
+      break;
+    value = (value << 3) | static_cast<uint64_t>(field [i] - '0');
+  }
+  return value;
+}
+
+
+// Returns a text field in a tar header, which may lack the terminating null.
+static std::string tar_text (const char* field, const size_t size)
+{
+  return std::string (field, strnlen (field, size));
+}
+
+
+// Whether a $name from a tarball stays within the folder where the tarball gets unpacked.
+static bool tar_name_is_safe (const std::string& name)
+{
+  if (name.empty () || (name.front () == '/'))
+    return false;
+  for (const auto& bit : filter::string::explode (name, '/'))
+    if (bit == "..")
+      return false;
+  return true;
+}
+
+
+// Unpacks gzipped tar data read from file descriptor $fd into $directory.
+// It reads forward only, and streams each file in chunks,
+// so memory usage does not depend on the size of the archive.
+// Returns true on success.
+bool untar_gzip_from_fd (const int fd, const std::string& directory)
+{
+  gzip_reader reader (fd);
+  std::vector <char> buffer (stream_chunk_size);
+  char record [tar_record_size];
+  std::string long_name {};
+  bool success {true};
+  while (success) {
+    if (reader.read (record, tar_record_size) != tar_record_size) {
+      success = false;
+      break;
+    }
+    // A null record marks the end of the archive.
+    if (record [148] == '\0')
+      break;
+    // Verify the checksum, which counts its own field as spaces.
+    uint64_t checksum {0};
+    for (size_t i = 0; i < tar_record_size; i++)
+      checksum += ((i >= 148) && (i < 156)) ? ' ' : static_cast<unsigned char>(record [i]);
+    if (checksum != tar_number (record + 148, 8)) {
+      success = false;
+      break;
+    }
+    const uint64_t size = tar_number (record + 124, 12);
+    const char type = record [156];
+    std::string name = tar_text (record, 100);
+    const std::string prefix = tar_text (record + 345, 155);
+    if ((memcmp (record + 257, "ustar", 5) == 0) && !prefix.empty ())
+      name = prefix + "/" + name;
+    if (!long_name.empty ()) {
+      name = long_name;
+      long_name.clear ();
+    }
+    while (name.find ("./") == 0)
+      name.erase (0, 2);
+    while (!name.empty () && (name.back () == '/'))
+      name.pop_back ();
+    // Regular files are written to disk, and long names are kept for the next record.
+    int output {-1};
+    std::string data {};
+    const bool is_file = (type == '0') || (type == '\0');
+    const bool is_long_name = (type == 'L') || (type == 'x');
+    if ((is_file || (type == '5')) && !name.empty ()) {
+      if (!tar_name_is_safe (name))
+        database::logs::log ("Skipping unsafe path in tarball: " + name);
+      else {
+        const std::string path = filter_url_update_directory_separator_if_windows (filter_url_create_path ({directory, name}));
+        if (is_file) {
+          const std::string dirname = filter_url_dirname (path);
+          if (!file_or_dir_exists (dirname))
+            filter_url_mkdir (dirname);
+          output = open (path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+          if (output < 0) {
+            database::logs::log ("Cannot create " + path);
+            success = false;
+          }
+        }
+        else if (!file_or_dir_exists (path))
+          filter_url_mkdir (path);
+      }
+    }
+    // Read the data of this entry, including the padding up to the next record.
+    uint64_t remaining = (size + tar_record_size - 1) / tar_record_size * tar_record_size;
+    uint64_t payload = size;
+    while (success && remaining) {
+      const size_t count = static_cast<size_t>(std::min <uint64_t> (remaining, buffer.size ()));
+      if (reader.read (buffer.data (), count) != count) {
+        success = false;
+        break;
+      }
+      const size_t useful = static_cast<size_t>(std::min <uint64_t> (payload, count));
+      if (output >= 0)
+        success = write_to_fd (output, buffer.data (), useful);
+      if (is_long_name)
+        data.append (buffer.data (), useful);
+      remaining -= count;
+      payload -= useful;
+    }
+    if (output >= 0)
+      close (output);
+    if (type == 'L')
+      long_name = tar_text (data.c_str (), data.size ());
+    // A pax extended header may carry the path: Records like "30 path=very/long/name\n".
+    if (type == 'x') {
+      for (const auto& line : filter::string::explode (data, '\n')) {
+        const size_t pos = line.find (" path=");
+        if (pos != std::string::npos)
+          long_name = line.substr (pos + 6);
+      }
+    }
+  }
+  // Read up to the end, so that the gzip trailer gets verified.
+  while (success && reader.read (buffer.data (), buffer.size ())) { }
+  return success && reader.ok ();
+}
+
+
 } // Namespace.
 
 
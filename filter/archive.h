@@ -30,11 +30,17 @@ std::string unzip (std::string file);
 std::string unzip_shell_internal (std::string file);
 std::string unzip_miniz_internal (std::string zipfile);
 std::string tar_gzip_file (std::string filename);
+std::string tar_gzip_file_shell_internal (std::string filename);
 std::string tar_gzip_folder (std::string folder);
+std::string tar_gzip_folder_shell_internal (std::string folder);
 std::string untar_gzip (std::string file);
+std::string untar_gzip_shell_internal (std::string file);
 std::string decompress (std::string file);
 int is_archive (std::string file);
 std::string microtar_pack (std::string tarball, std::string directory, std::vector <std::string> files);
 std::string microtar_unpack (std::string tarball, std::string directory);
+bool zip_folder_to_fd (const std::string& folder, const int fd);
+bool tar_gzip_to_fd (const std::string& directory, const std::vector <std::string>& files, const int fd);
+bool untar_gzip_from_fd (const int fd, const std::string& directory);
 
 }
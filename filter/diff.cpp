@@ -43,7 +43,50 @@
 #include <database/bibles.h>
 
 
-static std::mutex filter_diff_mutex;
+// Runs the diff engine on the $old_sequence and the $new_sequence.
+// Returns the shortest edit script, one element per entry,
+// each prefixed with a space if common to both, a + if added, or a - if removed.
+// The elements both sequences have in common at the start and at the end do not go through the diff engine,
+// as that would only take time to find what is already known.
+// The state is local to the call, so this can run on many threads at once.
+static std::vector <std::string> filter_diff_edit_script (const std::vector <std::string>& old_sequence,
+                                                         const std::vector <std::string>& new_sequence)
+{
+  size_t prefix {0};
+  while ((prefix < old_sequence.size ()) && (prefix < new_sequence.size ()) && (old_sequence [prefix] == new_sequence [prefix]))
+    prefix++;
+  size_t suffix {0};
+  while ((suffix < old_sequence.size () - prefix) && (suffix < new_sequence.size () - prefix)
+         && (old_sequence [old_sequence.size () - 1 - suffix] == new_sequence [new_sequence.size () - 1 - suffix]))
+    suffix++;
+
+  std::vector <std::string> script;
+  script.reserve (old_sequence.size () + new_sequence.size () - prefix - suffix);
+  for (size_t i = 0; i < prefix; i++)
+    script.push_back (" " + old_sequence [i]);
+
+  // Run the diff engine on what remains in between.
+  const auto old_end = old_sequence.cend () - static_cast<long>(suffix);
+  const auto new_end = new_sequence.cend () - static_cast<long>(suffix);
+  std::vector <std::string> old_middle (old_sequence.cbegin () + static_cast<long>(prefix), old_end);
+  std::vector <std::string> new_middle (new_sequence.cbegin () + static_cast<long>(prefix), new_end);
+  if (!old_middle.empty () || !new_middle.empty ()) {
+    dtl::Diff <std::string> diff (old_middle, new_middle);
+    diff.compose();
+    for (const auto& [element, info] : diff.getSes ().getSequence ()) {
+      if (info.type == dtl::SES_ADD)
+        script.push_back ("+" + element);
+      else if (info.type == dtl::SES_DELETE)
+        script.push_back ("-" + element);
+      else
+        script.push_back (" " + element);
+    }
+  }
+
+  for (auto iter = old_end; iter != old_sequence.cend (); ++iter)
+    script.push_back (" " + *iter);
+  return script;
+}
 
 
 // This filter returns the diff of two input strings.
@@ -66,24 +109,10 @@ std::string filter_diff_diff (std::string oldstring, std::string newstring,
   std::vector <std::string> old_sequence = filter::string::explode (oldstring, ' ');
   std::vector <std::string> new_sequence = filter::string::explode (newstring, ' ');
   
-  // See issue https://github.com/bibledit/cloud/issues/419
-  // It is unclear at this time whether the code below
-  // to find the differences between texts, is thread-safe.
-  // So just to be sure, a mutex is placed around it.
-  filter_diff_mutex.lock();
-
-  // Run the diff engine.
-  dtl::Diff <std::string> diff (old_sequence, new_sequence);
-  diff.compose();
-  
   // Get the shortest edit distance.
-  std::stringstream result;
-  diff.printSES (result);
-
-  filter_diff_mutex.unlock();
+  std::vector <std::string> output = filter_diff_edit_script (old_sequence, new_sequence);
   
   // Add html markup for bold and strikethrough.
-  std::vector <std::string> output = filter::string::explode (result.str (), '\n');
   for (auto & line : output) {
     if (line.empty ()) continue;
     char indicator = line.front ();
@@ -164,16 +193,10 @@ void filter_diff_diff_utf16 (const std::vector <std::string> & oldinput, const s
     s = filter::string::replace ("\n", newline, s);
   }
 
-  // Run the diff engine.
-  dtl::Diff <std::string> diff (old_sequence, new_sequence);
-  diff.compose();
-  
   // Get the shortest edit distance.
-  std::stringstream result;
-  diff.printSES (result);
+  std::vector <std::string> differences = filter_diff_edit_script (old_sequence, new_sequence);
 
   // Convert the new line place holder back to the original new line.
-  std::vector <std::string> differences = filter::string::explode (result.str (), '\n');
   for (auto & s : differences) {
     s = filter::string::replace (newline, "\n", s);
   }
@@ -243,26 +266,12 @@ int filter_diff_character_similarity (std::string oldstring, std::string newstri
       new_sequence.push_back (newstring.substr (i, 1));
     }
 
-    // See issue https://github.com/bibledit/cloud/issues/419
-    // It is unclear at this time whether the code below
-    // to find the differences between texts, is thread-safe.
-    // So just to be sure, a mutex is placed around it.
-    filter_diff_mutex.lock();
-
-    // Run the diff engine.
-    dtl::Diff <std::string> diff (old_sequence, new_sequence);
-    diff.compose();
-    
     // Get the shortest edit distance.
-    std::stringstream result;
-    diff.printSES (result);
-
-    filter_diff_mutex.unlock();
+    const std::vector <std::string> output = filter_diff_edit_script (old_sequence, new_sequence);
     
     // Calculate the total elements compared, and the total differences found.
     int element_count = 0;
     int similar_count = 0;
-    std::vector <std::string> output = filter::string::explode (result.str(), '\n');
     for (auto & line : output) {
       if (line.empty ()) continue;
       element_count++;
@@ -299,26 +308,12 @@ int filter_diff_word_similarity (std::string oldstring, std::string newstring)
   old_sequence = filter::string::explode (oldstring, ' ');
   new_sequence = filter::string::explode (newstring, ' ');
   
-  // See issue https://github.com/bibledit/cloud/issues/419
-  // It is unclear at this time whether the code below
-  // to find the differences between texts, is thread-safe.
-  // So just to be sure, a mutex is placed around it.
-  filter_diff_mutex.lock();
-
-  // Run the diff engine.
-  dtl::Diff <std::string> diff (old_sequence, new_sequence);
-  diff.compose();
-  
   // Get the shortest edit distance.
-  std::stringstream result;
-  diff.printSES (result);
-
-  filter_diff_mutex.unlock();
+  const std::vector <std::string> output = filter_diff_edit_script (old_sequence, new_sequence);
   
   // Calculate the total elements compared, and the total differences found.
   int element_count = 0;
   int similar_count = 0;
-  std::vector <std::string> output = filter::string::explode (result.str(), '\n');
   for (auto & line : output) {
     if (line.empty ()) continue;
     element_count++;
@@ -368,9 +363,11 @@ void filter_diff_produce_verse_level (std::string bible, std::string directory)
       verses.insert (verses.end (), new_verse_numbers.begin (), new_verse_numbers.end ());
       verses = filter::string::array_unique (verses);
       sort (verses.begin(), verses.end());
+      const filter::usfm::ChapterVerses old_chapter_verses (old_chapter_usfm);
+      const filter::usfm::ChapterVerses new_chapter_verses (new_chapter_usfm);
       for (auto verse : verses) {
-        std::string old_verse_text = filter::usfm::get_verse_text (old_chapter_usfm, verse);
-        std::string new_verse_text = filter::usfm::get_verse_text (new_chapter_usfm, verse);
+        std::string old_verse_text = old_chapter_verses.get_verse_text (verse);
+        std::string new_verse_text = new_chapter_verses.get_verse_text (verse);
         if (old_verse_text != new_verse_text) {
           std::string usfmCode = "\\p " + bookname + " " + std::to_string(chapter) + "." + std::to_string(verse) + ": " + old_verse_text;
           old_vs_usfm.push_back (usfmCode);
@@ -261,13 +261,17 @@ std::string filter_merge_run_clever (std::string base, std::string change, std::
   
   std::string previous_change;
 
+  const filter::usfm::ChapterVerses base_verses (base);
+  const filter::usfm::ChapterVerses change_verses (change);
+  const filter::usfm::ChapterVerses prioritized_change_verses (prioritized_change);
+
   // Go through the verses.
   for (auto verse : verses) {
     
     // Gets the texts to merge for this verse.
-    std::string base_text = filter::usfm::get_verse_text (base, verse);
-    std::string change_text = filter::usfm::get_verse_text (change, verse);
-    std::string prioritized_change_text = filter::usfm::get_verse_text (prioritized_change, verse);
+    std::string base_text = base_verses.get_verse_text (verse);
+    std::string change_text = change_verses.get_verse_text (verse);
+    std::string prioritized_change_text = prioritized_change_verses.get_verse_text (verse);
     
     // Check for combined verses.
     if (change_text == previous_change) continue;
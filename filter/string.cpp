@@ -436,6 +436,41 @@ std::string narrow_non_breaking_space_u202F ()
 }
 
 
+// Returns whether the string $s is plain ASCII.
+// It looks at eight bytes at a time.
+static bool is_ascii (const std::string_view s)
+{
+  constexpr uint64_t high_bits {0x8080808080808080};
+  size_t pos {0};
+  for (; pos + sizeof (uint64_t) <= s.size (); pos += sizeof (uint64_t)) {
+    uint64_t block {};
+    memcpy (&block, s.data () + pos, sizeof (uint64_t));
+    if (block & high_bits)
+      return false;
+  }
+  for (; pos < s.size (); pos++) {
+    if (static_cast<unsigned char>(s[pos]) & 0x80)
+      return false;
+  }
+  return true;
+}
+
+
+// Returns the byte offset of Unicode point $pos in string $s.
+// Returns npos if the string has fewer points.
+static size_t unicode_byte_offset (const std::string& s, size_t pos)
+{
+  auto iter = s.cbegin ();
+  while (pos > 0) {
+    if (iter == s.cend ())
+      return std::string::npos;
+    utf8::next (iter, s.cend ());
+    pos--;
+  }
+  return static_cast<size_t>(iter - s.cbegin ());
+}
+
+
 // Returns the length of string s in unicode points, not in bytes.
 size_t unicode_string_length (const std::string& s)
 {
@@ -448,117 +483,111 @@ size_t unicode_string_length (const std::string& s)
 // If len = 0, the string from start till end is returned.
 std::string unicode_string_substr (std::string s, size_t pos, size_t len)
 {
-  char * input = const_cast<char *>(s.c_str());
-  char * startiter = input;
-  size_t length = strlen (input);
-  char * veryend = input + length + 1;
   // Iterate forward pos times.
-  while (pos > 0) {
-    if (strlen (startiter)) {
-      utf8::next (startiter, veryend);
-    } else {
-      // End reached: Return empty result.
-      return std::string();
-    }
-    pos--;
-  }
+  // If the end is reached, the result is empty.
+  const size_t start = unicode_byte_offset (s, pos);
+  if (start == std::string::npos)
+    return std::string();
   // Zero len: Return result till the end of the string.
   if (len == 0) {
-    s.assign (startiter);
+    s.erase (0, start);
     return s;
   }
-  
-  // Iterate forward len times.
-  char * enditer = startiter;
-  while (len > 0) {
-    if (strlen (enditer)) {
-      utf8::next (enditer, veryend);
-    } else {
-      // End reached: Return result.
-      s.assign (startiter);
-      return s;
-    }
+  // Iterate forward len times, or till the end.
+  auto iter = s.cbegin () + static_cast<std::ptrdiff_t>(start);
+  while ((len > 0) && (iter != s.cend ())) {
+    utf8::next (iter, s.cend ());
     len--;
   }
   // Return substring.
-  size_t startpos = static_cast <size_t> (startiter - input);
-  size_t lenpos = static_cast <size_t> (enditer - startiter);
-  s = s.substr (startpos, lenpos);
-  return s;
+  return s.substr (start, static_cast<size_t>(iter - s.cbegin ()) - start);
 }
 
 
 // Equivalent to PHP's mb_strpos function.
+// It searches the bytes in one pass.
+// In valid UTF-8 a match always starts at the start of a Unicode point,
+// so only the part before the match needs counting in Unicode points.
 size_t unicode_string_strpos (const std::string& haystack, const std::string& needle, const size_t offset)
 {
-  const int haystack_length = static_cast<int>( filter::string::unicode_string_length (haystack));
-  const int needle_length = static_cast<int>( filter::string::unicode_string_length (needle));
-  for (int pos = static_cast<int>(offset); pos <= haystack_length - needle_length; pos++) {
-    const std::string substring = filter::string::unicode_string_substr (haystack, static_cast <size_t> (pos), static_cast <size_t> (needle_length));
-    if (substring == needle) return static_cast <size_t> (pos);
-  }
-  return std::string::npos;
+  const size_t start = unicode_byte_offset (haystack, offset);
+  if (start == std::string::npos)
+    return std::string::npos;
+  // An empty needle is found at the end of the haystack.
+  if (needle.empty ())
+    return filter::string::unicode_string_length (haystack);
+  const size_t found = haystack.find (needle, start);
+  if (found == std::string::npos)
+    return std::string::npos;
+  const auto begin = haystack.cbegin ();
+  return offset + static_cast<size_t>(utf8::distance (begin + static_cast<std::ptrdiff_t>(start), begin + static_cast<std::ptrdiff_t>(found)));
 }
 
 
 // Case-insensitive version of "filter::string::unicode_string_strpos".
+// Case folding changes the bytes but not the number of Unicode points,
+// so the position in the folded haystack is the position in the original.
 size_t unicode_string_strpos_case_insensitive (std::string haystack, std::string needle, size_t offset)
 {
   haystack = filter::string::unicode_string_casefold (haystack);
   needle = filter::string::unicode_string_casefold (needle);
-  
-  const int haystack_length = static_cast<int>( filter::string::unicode_string_length (haystack));
-  const int needle_length = static_cast<int>( filter::string::unicode_string_length (needle));
-  for (int pos = static_cast<int>(offset); pos <= haystack_length - needle_length; pos++) {
-    const std::string substring = filter::string::unicode_string_substr (haystack, static_cast<size_t> (pos), static_cast<size_t> (needle_length));
-    if (substring == needle) return static_cast<size_t>(pos);
-  }
-  return std::string::npos;
+  return filter::string::unicode_string_strpos (haystack, needle, offset);
 }
 
 
-// Converts string to lowercase.
-std::string unicode_string_casefold (const std::string& s)
+// Converts the case of each Unicode point in string $s, to upper case or to lower case.
+// Plain ASCII gets converted right away.
+// Other points go through the tables of the UTF8 processor.
+// Bytes that are no valid UTF-8 are copied as they are.
+static std::string unicode_string_convert_case (const std::string& s, const bool upper)
 {
-  std::string casefolded {};
-  // The conversion routine below is slow.
-  // There was a case that a user tried to put a whole Bible into one chapter.
-  // As a result, the Cloud choked on converting this chapter to lower case.
-  // So measurements were done as to the time the routine below takes to convert data.
-  // Processor 1,2 GHz Intel Core m3 took 1.5 minutes to convert 35 kbytes of data.
-  // So a limit had to be introduced below,
-  // that is the input text is larger than this limit,
-  // the routine won't fold it.
-  if (s.size () > 35000) {
-    return s;
+  const auto convert_ascii = [upper] (const char c) {
+    if (upper)
+      return ((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : c;
+    return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  std::string result (s.size (), '\0');
+  if (is_ascii (s)) {
+    std::transform (s.cbegin (), s.cend (), result.begin (), convert_ascii);
+    return result;
   }
-  // Do the case folding.
-  try {
-    // The UTF8 processor works with one Unicode point at a time.
-    size_t string_length = filter::string::unicode_string_length (s);
-    for (unsigned int pos = 0; pos < string_length; pos++) {
-      // Get one UTF-8 character.
-      const std::string character = filter::string::unicode_string_substr (s, pos, 1);
-      // Convert it to a Unicode point.
-      const utf8proc_uint8_t *str = reinterpret_cast<const unsigned char *> (character.c_str ());
-      utf8proc_ssize_t len = static_cast<utf8proc_ssize_t> (character.length ());
-      utf8proc_int32_t dst;
-      [[maybe_unused]] utf8proc_ssize_t output = utf8proc_iterate (str, len, &dst);
-      // Convert the Unicode point to lower case.
-      utf8proc_int32_t luc = utf8proc_tolower (dst);
-      // Convert the Unicode point back to a UTF-8 string.
-      utf8proc_uint8_t buffer [10];
-      output = utf8proc_encode_char (luc, buffer);
-      buffer [output] = 0;
-      std::stringstream ss {};
-      ss << buffer;
-      // Add the casefolded UTF-8 character to the result.
-      casefolded.append (ss.str ());
+  result.clear ();
+  const utf8proc_uint8_t* data = reinterpret_cast<const utf8proc_uint8_t*>(s.data ());
+  const utf8proc_ssize_t size = static_cast<utf8proc_ssize_t>(s.size ());
+  utf8proc_ssize_t pos {0};
+  while (pos < size) {
+    const utf8proc_uint8_t byte = data [pos];
+    if (byte < 0x80) {
+      result.push_back (convert_ascii (static_cast<char>(byte)));
+      pos++;
+      continue;
+    }
+    utf8proc_int32_t codepoint {};
+    const utf8proc_ssize_t length = utf8proc_iterate (data + pos, size - pos, &codepoint);
+    if (length <= 0) {
+      result.push_back (static_cast<char>(byte));
+      pos++;
+      continue;
     }
+    codepoint = upper ? utf8proc_toupper (codepoint) : utf8proc_tolower (codepoint);
+    utf8proc_uint8_t buffer [4];
+    const utf8proc_ssize_t output = utf8proc_encode_char (codepoint, buffer);
+    result.append (reinterpret_cast<const char*>(buffer), static_cast<size_t>(output));
+    pos += length;
   }
-  catch (...) { }
-  // Done.
-  return casefolded;
+  return result;
+}
+
+
+// Converts string to lowercase.
+std::string unicode_string_casefold (const std::string& s)
+{
+  // This used to take 1.5 minutes for 35 kbytes of data on a 1,2 GHz Intel Core m3,
+  // because it took the Unicode points one by one from the start of the string again.
+  // There was a case that a user tried to put a whole Bible into one chapter,
+  // and the Cloud choked on converting this chapter to lower case.
+  // It now goes through the string once, so it no longer needs a limit on the size of the input.
+  return unicode_string_convert_case (s, false);
   /*
    The code below shows how to do it through the ICU library.
    But the ICU library could not be compiled properly for Android.
@@ -579,32 +608,7 @@ std::string unicode_string_casefold (const std::string& s)
 
 std::string unicode_string_uppercase (const std::string& s)
 {
-  std::string uppercase {};
-  try {
-    // The UTF8 processor works with one Unicode point at a time.
-    const size_t string_length = filter::string::unicode_string_length (s);
-    for (unsigned int pos = 0; pos < string_length; pos++) {
-      // Get one UTF-8 character.
-      const std::string character = filter::string::unicode_string_substr (s, pos, 1);
-      // Convert it to a Unicode point.
-      const utf8proc_uint8_t *str = reinterpret_cast<const unsigned char *> (character.c_str ());
-      utf8proc_ssize_t len = static_cast<utf8proc_ssize_t> (character.length ());
-      utf8proc_int32_t dst;
-      [[maybe_unused]] utf8proc_ssize_t output = utf8proc_iterate (str, len, &dst);
-      // Convert the Unicode point to lower case.
-      utf8proc_int32_t luc = utf8proc_toupper (dst);
-      // Convert the Unicode point back to a UTF-8 string.
-      utf8proc_uint8_t buffer [10];
-      output = utf8proc_encode_char (luc, buffer);
-      buffer [output] = 0;
-      std::stringstream ss {};
-      ss << buffer;
-      // Add the casefolded UTF-8 character to the result.
-      uppercase.append (ss.str ());
-    }
-  } catch (...) { }
-  // Done.
-  return uppercase;
+  return unicode_string_convert_case (s, true);
   /*
    How to do the above through the ICU library.
    UnicodeString source = UnicodeString::fromUTF8 (StringPiece (s));
@@ -620,9 +624,12 @@ std::string unicode_string_transliterate (const std::string& s)
 {
   std::string transliteration {};
   try {
-    const size_t string_length = filter::string::unicode_string_length (s);
-    for (unsigned int pos = 0; pos < string_length; pos++) {
-      const std::string character {unicode_string_substr (s, pos, 1)};
+    // Go through the string one Unicode point at a time.
+    auto iter = s.cbegin ();
+    while (iter != s.cend ()) {
+      const auto start = iter;
+      utf8::next (iter, s.cend ());
+      const std::string character (start, iter);
       const utf8proc_uint8_t *str = reinterpret_cast<const unsigned char *> (character.c_str ());
       utf8proc_ssize_t len = static_cast<utf8proc_ssize_t> (character.length ());
       uint8_t *dest;
@@ -719,19 +726,23 @@ std::string unicode_string_str_replace (const std::string& search, const std::st
 {
   // The needle to look for should not be empty.
   if (!search.empty ()) {
-    // Do the replacing.
-    const size_t searchlength = filter::string::unicode_string_length (search);
-    size_t offposition = filter::string::unicode_string_strpos (subject, search);
-    while (offposition != std::string::npos) {
-      std::string subject_before {};
-      // Due to the nature of the substr finder, it needs special handling for search position zero.
-      if (offposition != 0) subject_before = filter::string::unicode_string_substr (subject, 0, offposition);
-      // Continue with the splitting and joining.
-      const std::string subject_after = filter::string::unicode_string_substr (subject, offposition + searchlength, subject.length());
-      subject = subject_before + replace + subject_after;
-      // Prepare for next iteration.
-      offposition = filter::string::unicode_string_strpos (subject, search, offposition + filter::string::unicode_string_length (replace));
+    // Do the replacing in one pass.
+    // In valid UTF-8 a match always starts at the start of a Unicode point,
+    // so the bytes can be searched and replaced as they are.
+    size_t position = subject.find (search);
+    if (position == std::string::npos)
+      return subject;
+    std::string result {};
+    result.reserve (subject.size ());
+    size_t done {0};
+    while (position != std::string::npos) {
+      result.append (subject, done, position - done);
+      result.append (replace);
+      done = position + search.size ();
+      position = subject.find (search, done);
     }
+    result.append (subject, done);
+    return result;
   }
   // Ready.
   return subject;
@@ -1055,11 +1066,16 @@ std::string markup_words (const std::vector<std::string>& words, std::string tex
 std::vector <std::string> search_needles (const std::string& search, const std::string& text)
 {
   std::vector <std::string> needles {};
-  size_t position = filter::string::unicode_string_strpos_case_insensitive (text, search, 0);
+  // Case folding keeps the number of Unicode points,
+  // so the positions found in the folded text are the positions in the original text.
+  const std::string folded_text = filter::string::unicode_string_casefold (text);
+  const std::string folded_search = filter::string::unicode_string_casefold (search);
+  const size_t search_length = filter::string::unicode_string_length (search);
+  size_t position = filter::string::unicode_string_strpos (folded_text, folded_search, 0);
   while (position != std::string::npos) {
-    const std::string needle = unicode_string_substr (text, position, filter::string::unicode_string_length (search));
+    const std::string needle = unicode_string_substr (text, position, search_length);
     needles.push_back (needle);
-    position = filter::string::unicode_string_strpos_case_insensitive (text, search, position + 1);
+    position = filter::string::unicode_string_strpos (folded_text, folded_search, position + 1);
   }
   needles = filter::string::array_unique (needles);
   return needles;
@@ -68,6 +68,73 @@ Filter_Text::~Filter_Text()
 }
 
 
+// This function prepares the object for converting the next bit of USFM of the same Bible.
+// It clears everything left by a previous run, yet the containers keep their memory,
+// so converting verse after verse with one object does not allocate them over and over again.
+// The plain text output gets emptied and remains attached.
+// Any other output objects hold a whole document and are removed.
+void Filter_Text::reset()
+{
+    m_usfm_markers_and_text.clear();
+    usfm_markers_and_text_ptr = 0;
+    m_stylesheet.clear();
+    m_styles.reset();
+    chapter_usfm_markers_and_text.clear();
+    chapter_usfm_markers_and_text_pointer = 0;
+    created_styles.clear();
+    m_current_book_identifier = 0;
+    m_current_chapter_number = 0;
+    m_current_verse_number.clear();
+    m_number_of_chapters_per_book.clear();
+    running_headers.clear();
+    long_TOCs.clear();
+    short_TOCs.clear();
+    book_abbreviations.clear();
+    chapter_labels.clear();
+    published_chapter_markers.clear();
+    alternate_chapter_numbers.clear();
+    published_verse_markers.clear();
+    m_output_chapter_text_at_first_verse.clear();
+    info.clear();
+    fallout.clear();
+    word_lists.clear();
+    note_citations = filter::note::citations();
+    standard_content_marker_foot_end_note.clear();
+    standard_content_marker_cross_reference.clear();
+    verses_headings.clear();
+    paragraph_starting_markers.clear();
+    verses_paragraphs.clear();
+    headings_text_per_verse_active = false;
+    heading_started = false;
+    m_verses_text.clear();
+    text_started = false;
+    actual_verses_paragraph.clear();
+    book_has_chapter_label.clear();
+    notes_plain_text.clear();
+    verses_text_note_positions.clear();
+    note_open_now = false;
+    notes_plain_text_buffer.clear();
+    image_sources.clear();
+    is_within_figure_markup = false;
+    figure_marker.clear();
+
+    const auto remove = [](auto*& output) {
+        delete output;
+        output = nullptr;
+    };
+    remove(odf_text_standard);
+    remove(odf_text_text_only);
+    remove(odf_text_text_and_note_citations);
+    remove(odf_text_notes);
+    remove(html_text_standard);
+    remove(html_text_linked);
+    remove(onlinebible_text);
+    remove(esword_text);
+    if (text_text)
+        text_text->clear();
+}
+
+
 // This function adds USFM code to the class.
 // $code: USFM code.
 void Filter_Text::add_usfm_code(std::string usfm)
@@ -161,7 +228,9 @@ void Filter_Text::get_styles()
         odf_text_text_and_note_citations->create_page_break_style();
     if (odf_text_text_and_note_citations)
         odf_text_text_and_note_citations->create_superscript_style();
-    for (const stylesv2::Style& style : database::styles::get_styles(m_stylesheet))
+    // Take the current snapshot of the stylesheet, and use that throughout the run.
+    m_styles = database::styles::get_snapshot(m_stylesheet);
+    for (const stylesv2::Style& style : m_styles->styles())
     {
         if (style.type == stylesv2::Type::note_standard_content)
             standard_content_marker_foot_end_note = style.marker;
@@ -189,7 +258,7 @@ void Filter_Text::pre_process_usfm()
                 marker = marker.substr(1); // Remove the initial backslash, e.g. '\id' becomes 'id'.
                 if (filter::usfm::is_opening_marker(marker))
                 {
-                    if (const stylesv2::Style* style{database::styles::get_marker_data(m_stylesheet, marker)}; style)
+                    if (const stylesv2::Style* style{m_styles->find(marker)}; style)
                     {
                         switch (style->type)
                         {
@@ -391,7 +460,7 @@ void Filter_Text::process_usfm()
                 if (is_opening_marker)
                     filter::usfm::remove_word_level_attributes(marker, chapter_usfm_markers_and_text,
                                                                chapter_usfm_markers_and_text_pointer);
-                if (const stylesv2::Style* style{database::styles::get_marker_data(m_stylesheet, marker)}; style)
+                if (const stylesv2::Style* style{m_styles->find(marker)}; style)
                 {
                     switch (style->type)
                     {
@@ -704,8 +773,7 @@ void Filter_Text::process_usfm()
                             // Open a paragraph for the notes.
                             // It takes the style of the footnote content marker, usually 'ft'.
                             // This is done specifically for the version that has the notes only.
-                            const stylesv2::Style* ft_style = database::styles::get_marker_data(
-                                m_stylesheet, standard_content_marker_foot_end_note);
+                            const stylesv2::Style* ft_style = m_styles->find(standard_content_marker_foot_end_note);
                             ensure_note_paragraph_style(standard_content_marker_foot_end_note, ft_style);
                             if (odf_text_notes)
                                 odf_text_notes->new_paragraph(standard_content_marker_foot_end_note);
@@ -1343,7 +1411,7 @@ void Filter_Text::processNote()
             bool is_embedded_marker = filter::usfm::is_embedded_marker(current_item);
             // Clean up the marker, so we remain with the basic version, e.g. 'f'.
             const std::string marker = filter::usfm::get_marker(current_item);
-            if (const stylesv2::Style* style{database::styles::get_marker_data(m_stylesheet, marker)}; style)
+            if (const stylesv2::Style* style{m_styles->find(marker)}; style)
             {
                 switch (style->type)
                 {
@@ -1384,8 +1452,7 @@ void Filter_Text::processNote()
                     {
                         if (is_opening_marker)
                         {
-                            const stylesv2::Style* ft_style = database::styles::get_marker_data(
-                                m_stylesheet, standard_content_marker_foot_end_note);
+                            const stylesv2::Style* ft_style = m_styles->find(standard_content_marker_foot_end_note);
                             ensure_note_paragraph_style(marker, ft_style);
                             const std::string citation = get_note_citation(marker);
                             if (odf_text_standard)
@@ -1434,8 +1501,7 @@ void Filter_Text::processNote()
                     {
                         if (is_opening_marker)
                         {
-                            const stylesv2::Style* ft_style = database::styles::get_marker_data(
-                                m_stylesheet, standard_content_marker_foot_end_note);
+                            const stylesv2::Style* ft_style = m_styles->find(standard_content_marker_foot_end_note);
                             ensure_note_paragraph_style(marker, ft_style);
                             const std::string citation = get_note_citation(marker);
                             if (odf_text_standard)
@@ -1545,8 +1611,7 @@ void Filter_Text::processNote()
                     {
                         if (is_opening_marker)
                         {
-                            const stylesv2::Style* xt_style = database::styles::get_marker_data(
-                                m_stylesheet, standard_content_marker_cross_reference);
+                            const stylesv2::Style* xt_style = m_styles->find(standard_content_marker_cross_reference);
                             ensure_note_paragraph_style(marker, xt_style);
                             std::string citation = get_note_citation(style->marker);
                             if (odf_text_standard)
@@ -1940,8 +2005,7 @@ void Filter_Text::apply_drop_caps_to_current_paragraph(const int drop_caps_lengt
             std::to_string(drop_caps_length);
         if (std::ranges::find(created_styles, combined_style) == created_styles.end())
         {
-            const stylesv2::Style* style = database::styles::get_marker_data(
-                m_stylesheet, odf_text_standard->m_current_paragraph_style);
+            const stylesv2::Style* style = m_styles->find(odf_text_standard->m_current_paragraph_style);
             if (!style)
                 return;
             if (!style->paragraph)
@@ -1994,7 +2058,7 @@ void Filter_Text::apply_drop_caps_to_current_paragraph(const int drop_caps_lengt
 void Filter_Text::put_chapter_number_in_frame(const std::string& chapter_text) const
 {
     // Get the chapter marker, that is \c.
-    const stylesv2::Style* style{database::styles::get_marker_data(m_stylesheet, chapter_marker)};
+    const stylesv2::Style* style{m_styles->find(chapter_marker)};
     // In the unlikely case the chapter style is not valid, take defaults as fallback options.
     const float font_size = style->paragraph ? static_cast<float>(style->paragraph.value().font_size) : 12.0f;
     const auto italic = style->paragraph ? style->paragraph.value().italic : stylesv2::TwoState::off;
@@ -52,6 +52,7 @@ public:
   ~Filter_Text ();
   Filter_Text(const Filter_Text&) = delete;
   Filter_Text operator=(const Filter_Text&) = delete;
+  void reset ();
   
 private:
   std::string m_bible {};
@@ -70,6 +71,8 @@ public:
 private:
   // The stylesheet.
   std::string m_stylesheet{};
+  // The snapshot of the stylesheet being used.
+  std::shared_ptr<const database::styles::snapshot> m_styles{};
   // Container holding a chapter of USFM code, alternating between USFM and text.
   std::vector <std::string> chapter_usfm_markers_and_text {};
   unsigned int chapter_usfm_markers_and_text_pointer {0};
@@ -30,8 +30,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <filter/date.h>
 #include <database/books.h>
 #include <database/logs.h>
+#include <unordered_set>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 #ifdef HAVE_CLOUD
 #include <curl/curl.h>
+#include <array>
 #endif
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
@@ -602,8 +607,9 @@ bool filter_url_is_dir(const std::string& path)
 }
 #else
 {
-    struct stat sb;
-    stat(path.c_str(), &sb);
+    struct stat sb {};
+    if (stat(path.c_str(), &sb) != 0)
+        return false;
     return (sb.st_mode & S_IFMT) == S_IFDIR;
 }
 #endif
@@ -706,6 +712,200 @@ void filter_url_file_put_contents_append(const std::string& filename, const std:
 }
 
 
+// A file written to a temporary file next to it,
+// waiting for the group commit that makes it durable and puts it in place.
+struct durable_write
+{
+  std::string temporary {};
+  std::string filename {};
+  bool done {false};
+  bool ok {false};
+};
+
+
+static std::mutex durable_mutex {};
+static std::condition_variable durable_condition {};
+static std::vector <durable_write*> durable_pending {};
+static bool durable_committing {false};
+static std::atomic <size_t> durable_counter {0};
+static std::atomic <size_t> durable_writes {0};
+static std::atomic <size_t> durable_bytes {0};
+static std::atomic <size_t> durable_batches {0};
+static std::atomic <size_t> durable_syncs {0};
+static std::atomic <size_t> durable_failures {0};
+
+
+// Flushes the file or folder at the path to storage.
+// For a file, only its data and the metadata needed to read that data back are flushed, where supported.
+static bool durable_sync ([[maybe_unused]] const std::string& path, [[maybe_unused]] const bool data)
+{
+#ifdef HAVE_WINDOWS
+  return true;
+#else
+  const int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+    return false;
+#ifdef __linux__
+  const int result = data ? fdatasync (fd) : fsync (fd);
+#else
+  const int result = fsync (fd);
+#endif
+  close (fd);
+  durable_syncs++;
+  return result == 0;
+#endif
+}
+
+
+// The temporary files of this run have this number in their names,
+// so they can be told apart from the ones an earlier run left behind.
+static const std::string& durable_run ()
+{
+  static const std::string run {std::to_string (std::random_device {} ())};
+  return run;
+}
+
+
+// The folders in which stale temporary files have been looked for.
+// The set gets cleared once it holds many folders, after which they are looked in again.
+static std::mutex durable_folders_mutex {};
+static std::unordered_set <std::string> durable_folders {};
+constexpr size_t durable_folders_limit {10000};
+
+
+// Removes the temporary files that a crash during a durable write left in the folder.
+// It does so before the first durable write into it.
+// Temporary files of this run belong to writers in progress, so only those of earlier runs are stale.
+static void durable_remove_stale (const std::string& folder)
+{
+  {
+    std::lock_guard lock (durable_folders_mutex);
+    if (durable_folders.size () >= durable_folders_limit)
+      durable_folders.clear ();
+    if (!durable_folders.insert (folder).second)
+      return;
+  }
+  constexpr std::string_view marker {".durable"};
+  const std::string own = durable_run () + "_";
+  for (const auto& file : filter_url_scandir (folder)) {
+    const size_t pos = file.rfind (marker);
+    if (pos == std::string::npos)
+      continue;
+    const std::string suffix = file.substr (pos + marker.size ());
+    if (suffix.empty () || suffix.starts_with (own))
+      continue;
+    if (!std::ranges::all_of (suffix, [](const char c) noexcept { return std::isdigit (static_cast<unsigned char>(c)) || (c == '_'); }))
+      continue;
+    filter_url_unlink (filter_url_create_path ({folder, file}));
+  }
+}
+
+
+// Flushes the files in the batch to storage, and moves them in place.
+// After the renames, each folder involved gets flushed once, so the renames are durable too.
+static void durable_commit (const std::vector <durable_write*>& batch)
+{
+  durable_batches++;
+  for (durable_write* write : batch) {
+    write->ok = durable_sync (write->temporary, true);
+    if (!write->ok) {
+      filter_url_unlink (write->temporary);
+      durable_failures++;
+    }
+  }
+  std::set <std::string> folders {};
+  for (durable_write* write : batch) {
+    if (!write->ok)
+      continue;
+#ifdef HAVE_WINDOWS
+    try {
+      std::filesystem::rename (filter::string::string2wstring (write->temporary), filter::string::string2wstring (write->filename));
+      write->ok = true;
+    } catch (...) {
+      write->ok = false;
+    }
+#else
+    write->ok = (rename (write->temporary.c_str (), write->filename.c_str ()) == 0);
+#endif
+    if (write->ok)
+      folders.insert (filter_url_dirname (write->filename));
+    else {
+      filter_url_unlink (write->temporary);
+      durable_failures++;
+    }
+  }
+  for (const auto& folder : folders)
+    durable_sync (folder, false);
+}
+
+
+// Writes the contents to the file such that after a crash the file has either the old or the new contents.
+// It writes a temporary file, flushes it to storage, and renames it over the file.
+// Concurrent writers commit together (group commit):
+// The first writer to come in flushes the batch of files waiting so far,
+// renames them, and then flushes each of their folders once,
+// while the writers coming in meanwhile form the next batch.
+// Returns whether the write succeeded.
+bool filter_url_file_put_contents_durable (const std::string& filename, const std::string& contents)
+{
+  durable_remove_stale (filter_url_dirname (filename));
+  durable_write write {
+    .temporary = filename + ".durable" + durable_run () + "_" + std::to_string (++durable_counter),
+    .filename = filename,
+  };
+  filter_url_file_put_contents (write.temporary, contents);
+  if (!file_or_dir_exists (write.temporary)
+      || (static_cast<size_t>(filter_url_filesize (write.temporary)) != contents.size ())) {
+    filter_url_unlink (write.temporary);
+    durable_failures++;
+    return false;
+  }
+  durable_writes++;
+  durable_bytes += contents.size ();
+
+  std::unique_lock lock (durable_mutex);
+  durable_pending.push_back (&write);
+  while (!write.done) {
+    if (durable_committing) {
+      durable_condition.wait (lock);
+      continue;
+    }
+    durable_committing = true;
+    std::vector <durable_write*> batch {};
+    batch.swap (durable_pending);
+    // Whatever happens during the commit, hand over to the waiting writers afterwards.
+    struct commit_guard {
+      std::unique_lock <std::mutex>& lock;
+      const std::vector <durable_write*>& batch;
+      ~commit_guard () {
+        if (!lock.owns_lock ())
+          lock.lock ();
+        for (durable_write* committed : batch)
+          committed->done = true;
+        durable_committing = false;
+        durable_condition.notify_all ();
+      }
+    } guard {lock, batch};
+    lock.unlock ();
+    durable_commit (batch);
+  }
+  return write.ok;
+}
+
+
+// Returns the counters of the durable writes so far.
+filter_url_durable_statistics filter_url_durable_metrics ()
+{
+  return {
+    .writes = durable_writes,
+    .bytes = durable_bytes,
+    .batches = durable_batches,
+    .syncs = durable_syncs,
+    .failures = durable_failures,
+  };
+}
+
+
 // Copies the contents of file named "input" to file named "output".
 // It is assumed that the folder where "output" will reside exists.
 bool filter_url_file_cp(const std::string& input, const std::string& output)
@@ -824,6 +1024,183 @@ std::vector<std::string> filter_url_scandir(const std::string& folder)
 #endif
 
 
+// A cached listing of a folder.
+struct scandir_listing
+{
+  std::shared_ptr <const std::vector <std::string>> files {};
+  // The identity of the folder at the time it was listed, to notice it was replaced or moved.
+  dev_t device {};
+  ino_t inode {};
+  time_t modified {};
+  int watch {-1};
+};
+
+
+// The cache holds the listings of this many folders at most.
+constexpr size_t scandir_cache_size {1000};
+static std::mutex scandir_mutex {};
+static std::unordered_map <std::string, scandir_listing> scandir_cache {};
+static size_t scandir_hits {0};
+static size_t scandir_misses {0};
+static size_t scandir_invalidations {0};
+#ifdef __linux__
+static int scandir_inotify {-1};
+// The folders in the cache per inotify watch.
+static std::unordered_map <int, std::set <std::string>> scandir_watches {};
+#endif
+
+
+#ifdef __linux__
+// Removes the listings of the folders of the inotify watch from the cache, and removes the watch.
+// The mutex should be locked.
+static void scandir_forget_watch (const int watch)
+{
+  const auto iterator = scandir_watches.find (watch);
+  if (iterator == scandir_watches.end ())
+    return;
+  for (const auto& folder : iterator->second) {
+    if (scandir_cache.erase (folder))
+      scandir_invalidations++;
+  }
+  scandir_watches.erase (iterator);
+  inotify_rm_watch (scandir_inotify, watch);
+}
+#endif
+
+
+// Removes the listing of the folder from the cache.
+// The mutex should be locked.
+static void scandir_forget (const std::string& folder)
+{
+  const auto iterator = scandir_cache.find (folder);
+  if (iterator == scandir_cache.end ())
+    return;
+#ifdef __linux__
+  scandir_forget_watch (iterator->second.watch);
+#endif
+  if (scandir_cache.erase (folder))
+    scandir_invalidations++;
+}
+
+
+// Empties the listing cache.
+// The mutex should be locked.
+static void scandir_forget_all ()
+{
+  scandir_invalidations += scandir_cache.size ();
+  scandir_cache.clear ();
+#ifdef __linux__
+  for (const auto& [watch, folders] : scandir_watches)
+    inotify_rm_watch (scandir_inotify, watch);
+  scandir_watches.clear ();
+#endif
+}
+
+
+#ifdef __linux__
+// Reads the pending inotify events and removes the listings of changed folders from the cache.
+// The kernel queues the event before the call that changed the folder returns,
+// so after this, no listing in the cache is older than the last change made to its folder.
+// The mutex should be locked.
+static void scandir_process_events ()
+{
+  alignas (inotify_event) char buffer [4096];
+  ssize_t length {0};
+  while ((length = read (scandir_inotify, buffer, sizeof (buffer))) > 0) {
+    for (ssize_t offset {0}; offset < length; ) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      if (event->mask & IN_Q_OVERFLOW)
+        scandir_forget_all ();
+      else
+        scandir_forget_watch (event->wd);
+      offset += static_cast<ssize_t>(sizeof (inotify_event) + event->len);
+    }
+  }
+}
+#endif
+
+
+// Returns the sorted listing of the folder, as filter_url_scandir does.
+// The listing is shared and should not be changed.
+// Listings are cached. On Linux, inotify removes listings of changed folders from the cache.
+// Elsewhere a listing is valid as long as the modification time of its folder stays the same.
+std::shared_ptr <const std::vector <std::string>> filter_url_scandir_shared (const std::string& folder)
+{
+  std::lock_guard lock (scandir_mutex);
+
+#ifdef __linux__
+  if (scandir_inotify < 0)
+    scandir_inotify = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if (scandir_inotify >= 0)
+    scandir_process_events ();
+#endif
+
+  // A folder that cannot be accessed is not cached.
+  struct stat status {};
+  if (stat (folder.c_str (), &status) != 0) {
+    scandir_forget (folder);
+    scandir_misses++;
+    return std::make_shared <const std::vector <std::string>> (filter_url_scandir (folder));
+  }
+
+  if (const auto iterator = scandir_cache.find (folder); iterator != scandir_cache.end ()) {
+    const scandir_listing& listing = iterator->second;
+    bool valid = (listing.device == status.st_dev) && (listing.inode == status.st_ino);
+#ifndef __linux__
+    valid &= (listing.modified == status.st_mtime);
+#endif
+    if (valid) {
+      scandir_hits++;
+      return listing.files;
+    }
+    scandir_forget (folder);
+  }
+
+  scandir_misses++;
+  if (scandir_cache.size () >= scandir_cache_size)
+    scandir_forget_all ();
+
+  scandir_listing listing {
+    .device = status.st_dev,
+    .inode = status.st_ino,
+    .modified = status.st_mtime,
+  };
+  bool cacheable {true};
+#ifdef __linux__
+  // Watch the folder before listing it, so a change made during the listing gets noticed.
+  if (scandir_inotify >= 0)
+    listing.watch = inotify_add_watch (scandir_inotify, folder.c_str (), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+  cacheable = (listing.watch >= 0);
+#else
+  // The modification time has a granularity of up to two seconds.
+  // A folder changed shortly before could change once more without a change in its modification time.
+  // So only cache the listing once the folder has been left alone for longer than that.
+  cacheable = (std::time (nullptr) - status.st_mtime > 2);
+#endif
+  listing.files = std::make_shared <const std::vector <std::string>> (filter_url_scandir (folder));
+  if (cacheable) {
+#ifdef __linux__
+    scandir_watches [listing.watch].insert (folder);
+#endif
+    scandir_cache [folder] = listing;
+  }
+  return listing.files;
+}
+
+
+// Returns the counters of the listing cache so far.
+filter_url_scandir_statistics filter_url_scandir_metrics ()
+{
+  std::lock_guard lock (scandir_mutex);
+  return {
+    .hits = scandir_hits,
+    .misses = scandir_misses,
+    .invalidations = scandir_invalidations,
+    .folders = scandir_cache.size (),
+  };
+}
+
+
 // Recursively scans a directory for directories and files.
 void filter_url_recursive_scandir(const std::string& folder, std::vector<std::string>& paths)
 {
@@ -862,10 +1239,37 @@ int filter_url_file_modification_time(std::string filename)
 
 
 // A C++ near equivalent for PHP's urldecode function.
+// It decodes in place, without allocating a buffer.
 std::string filter_url_urldecode(std::string url)
 {
-    url = UriDecode(url);
-    std::replace(url.begin(), url.end(), '+', ' ');
+    const auto hex_value = [](const char c) -> int {
+        if ((c >= '0') && (c <= '9'))
+            return c - '0';
+        if ((c >= 'A') && (c <= 'F'))
+            return c - 'A' + 10;
+        if ((c >= 'a') && (c <= 'f'))
+            return c - 'a' + 10;
+        return -1;
+    };
+    size_t length {0};
+    for (size_t i {0}; i < url.size(); ++i, ++length)
+    {
+        char c = url[i];
+        // Sequences that start with a percent sign but are not followed by two hexadecimal characters
+        // are left as they are (RFC1630).
+        if ((c == '%') && (i + 2 < url.size()))
+        {
+            if (const int high = hex_value(url[i + 1]), low = hex_value(url[i + 2]); (high >= 0) && (low >= 0))
+            {
+                c = static_cast<char>(high * 16 + low);
+                i += 2;
+            }
+        }
+        if (c == '+')
+            c = ' ';
+        url[length] = c;
+    }
+    url.resize(length);
     return url;
 }
 
@@ -978,31 +1382,129 @@ static size_t filter_url_curl_write_function(void* ptr, size_t size, size_t coun
 }
 
 
-// Sends a http GET request to the $url.
-// It returns the response from the server.
-// It writes any error to $error.
-std::string filter_url_http_get(std::string url, std::string& error, [[maybe_unused]] bool check_certificate)
+#ifdef HAVE_CLOUD
+
+
+// A pool of libcurl easy handles, shared by all threads.
+// A handle taken from the pool keeps the connections it made before,
+// so sequential requests to the same host skip the TCP and TLS handshakes.
+// All handles share the DNS cache, the TLS sessions, and the connection cache.
+class filter_url_curl_pool final
 {
-    std::string response;
-#ifdef HAVE_CLIENT
-    response = filter_url_http_request_mbed(url, error, {}, "", check_certificate);
-#else
-    CURL* curl = curl_easy_init();
-    if (curl)
+public:
+    filter_url_curl_pool() = default;
+    ~filter_url_curl_pool()
     {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, filter_url_curl_write_function);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        //curl_easy_setopt (curl, CURLOPT_VERBOSE, 1L);
-        // Because a Bibledit client should work even over very bad networks,
-        // pass some timeout options to curl so it properly deals with such networks.
-        filter_url_curl_set_timeout(curl);
-        // Some websites may prevent simple scrapers from getting their content.
-        // If the request comes from a real browser, they may accept the request and give an appropriate response.
-        // Here is how to mimic a request coming from a real browser:
-        // https://stackoverflow.com/questions/28760694/how-to-use-curl-to-get-a-get-request-exactly-same-as-using-chrome
-        // The code below mimics the Chrome browser in October 2024.
+        for (CURL* handle : m_idle)
+            curl_easy_cleanup(handle);
+        if (m_share)
+            curl_share_cleanup(m_share);
+    }
+    filter_url_curl_pool(const filter_url_curl_pool&) = delete;
+    filter_url_curl_pool& operator=(const filter_url_curl_pool&) = delete;
+
+    // Returns a handle with the default options, or nullptr on failure.
+    CURL* acquire()
+    {
+        CURL* handle{nullptr};
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_idle.empty())
+            {
+                handle = m_idle.back();
+                m_idle.pop_back();
+            }
+        }
+        if (!handle)
+            handle = curl_easy_init();
+        if (!handle)
+            return nullptr;
+        if (CURLSH* share = get_share(); share)
+            curl_easy_setopt(handle, CURLOPT_SHARE, share);
+        // Keep idle connections alive, and use HTTP/2 over TLS where the server offers it.
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        return handle;
+    }
+
+    // Takes the handle back.
+    // Resetting it clears the options that point to the caller's data, but keeps its connections.
+    void release(CURL* handle)
+    {
+        curl_easy_reset(handle);
+        std::lock_guard lock(m_mutex);
+        if (m_idle.size() < maximum_idle_handles)
+        {
+            m_idle.push_back(handle);
+            return;
+        }
+        curl_easy_cleanup(handle);
+    }
+
+private:
+    static constexpr size_t maximum_idle_handles{16};
+    std::mutex m_mutex{};
+    std::vector<CURL*> m_idle{};
+    CURLSH* m_share{nullptr};
+    bool m_share_tried{false};
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> m_share_mutexes{};
+
+    // The share gets created after the first handle, which initializes libcurl if needed.
+    CURLSH* get_share()
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_share_tried)
+        {
+            m_share_tried = true;
+            m_share = curl_share_init();
+            if (m_share)
+            {
+                curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lock_share);
+                curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+                curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+                curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+                curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+                curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+            }
+        }
+        return m_share;
+    }
+
+    static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* pool)
+    {
+        static_cast<filter_url_curl_pool*>(pool)->m_share_mutexes.at(static_cast<size_t>(data)).lock();
+    }
+
+    static void unlock_share(CURL*, curl_lock_data data, void* pool)
+    {
+        static_cast<filter_url_curl_pool*>(pool)->m_share_mutexes.at(static_cast<size_t>(data)).unlock();
+    }
+};
+
+
+static filter_url_curl_pool curl_pool{};
+
+
+// Gives a pooled curl handle back to the pool once it goes out of scope.
+struct filter_url_curl_releaser
+{
+    void operator()(CURL* handle) const noexcept
+    {
+        curl_pool.release(handle);
+    }
+};
+using filter_url_curl_handle = std::unique_ptr<CURL, filter_url_curl_releaser>;
+
+
+// Some websites may prevent simple scrapers from getting their content.
+// If the request comes from a real browser, they may accept the request and give an appropriate response.
+// Here is how to mimic a request coming from a real browser:
+// https://stackoverflow.com/questions/28760694/how-to-use-curl-to-get-a-get-request-exactly-same-as-using-chrome
+// The headers below mimic the Chrome browser in October 2024.
+// The list is built once and used by every GET request.
+static curl_slist* filter_url_curl_browser_headers()
+{
+    static const std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> headers = []() {
         curl_slist* extra_headers{nullptr};
         extra_headers = curl_slist_append(extra_headers,
                                           "accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7");
@@ -1021,13 +1523,48 @@ std::string filter_url_http_get(std::string url, std::string& error, [[maybe_unu
         extra_headers = curl_slist_append(extra_headers, R"(upgrade-insecure-requests: 1)");
         extra_headers = curl_slist_append(extra_headers,
                                           R"(user-agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/129.0.0.0 Safari/537.36)");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, extra_headers);
+        return std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)>(extra_headers, curl_slist_free_all);
+    }();
+    return headers.get();
+}
+
+
+#endif
+
+
+// Sends a http GET request to the $url.
+// It returns the response from the server.
+// It writes any error to $error.
+// If $response_code is given, it receives the http response code, or 0 if there was no response.
+std::string filter_url_http_get(std::string url, std::string& error, [[maybe_unused]] bool check_certificate, int* response_code)
+{
+    std::string response;
+    if (response_code)
+        *response_code = 0;
+#ifdef HAVE_CLIENT
+    response = filter_url_http_request_mbed(url, error, {}, "", check_certificate, response_code);
+#else
+    filter_url_curl_handle handle(curl_pool.acquire());
+    if (CURL* curl = handle.get(); curl)
+    {
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, filter_url_curl_write_function);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        //curl_easy_setopt (curl, CURLOPT_VERBOSE, 1L);
+        // Because a Bibledit client should work even over very bad networks,
+        // pass some timeout options to curl so it properly deals with such networks.
+        filter_url_curl_set_timeout(curl);
+        // Look like a real browser.
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, filter_url_curl_browser_headers());
         CURLcode res = curl_easy_perform(curl);
         if (res == CURLE_OK)
         {
             error.clear();
             long http_code = 0;
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+            if (response_code)
+                *response_code = static_cast<int>(http_code);
             if (http_code != 200)
             {
                 response.append("http code " + std::to_string(http_code));
@@ -1038,8 +1575,6 @@ std::string filter_url_http_get(std::string url, std::string& error, [[maybe_unu
             response.clear();
             error = curl_easy_strerror(res);
         }
-        curl_slist_free_all(extra_headers);
-        curl_easy_cleanup(curl);
     }
 #endif
     return response;
@@ -1139,9 +1674,9 @@ std::string filter_url_http_post(const std::string& url, [[maybe_unused]] std::s
 #ifdef HAVE_CLIENT
     response = filter_url_http_request_mbed(url, error, post_values, "", check_certificate);
 #else
-    // Get a curl handle.
-    CURL* curl = curl_easy_init();
-    if (curl)
+    // Get a curl handle from the pool.
+    filter_url_curl_handle handle(curl_pool.acquire());
+    if (CURL* curl = handle.get(); curl)
     {
         // First set the URL that is about to receive the POST.
         // This can be http or https.
@@ -1201,8 +1736,8 @@ std::string filter_url_http_post(const std::string& url, [[maybe_unused]] std::s
             error = curl_easy_strerror(res);
         }
         // Always cleanup.
+        // The handle goes back to the pool for the next request.
         if (list) curl_slist_free_all(list);
-        curl_easy_cleanup(curl);
     }
 #endif
     return response;
@@ -1321,8 +1856,8 @@ void filter_url_download_file(std::string url, std::string filename, std::string
 #ifdef HAVE_CLIENT
     filter_url_http_request_mbed(url, error, {}, filename, check_certificate);
 #else
-    CURL* curl = curl_easy_init();
-    if (curl)
+    filter_url_curl_handle handle(curl_pool.acquire());
+    if (CURL* curl = handle.get(); curl)
     {
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         FILE* file = fopen(filename.c_str(), "w");
@@ -1345,7 +1880,6 @@ void filter_url_download_file(std::string url, std::string filename, std::string
         {
             error = curl_easy_strerror(res);
         }
-        curl_easy_cleanup(curl);
         fclose(file);
     }
 #endif
@@ -1495,10 +2029,15 @@ std::string filter_url_remove_username_password(std::string url)
 // $post: Value pairs for a POST request.
 // $filename: The filename to save the data to.
 // $check_certificate: Whether to check the server certificate in case of secure http.
+// $response_code: If given, it receives the http response code, or 0 if there was no response.
 std::string filter_url_http_request_mbed(std::string url, std::string& error,
                                          const std::map<std::string, std::string>& post,
-                                         const std::string& filename, bool check_certificate)
+                                         const std::string& filename, bool check_certificate,
+                                         int* response_code)
 {
+    if (response_code)
+        *response_code = 0;
+
     // The "http" scheme is used to locate network resources via the HTTP protocol.
     // url = "http(s):" "//" host [ ":" port ] [ abs_path [ "?" query ]]
 
@@ -1993,8 +2532,10 @@ std::string filter_url_http_request_mbed(std::string url, std::string& error,
             if (pos2 != std::string::npos)
             {
                 line.erase(0, pos2 + 1);
-                int response_code = filter::string::convert_to_int(line);
-                if (response_code != 200)
+                const int code = filter::string::convert_to_int(line);
+                if (response_code)
+                    *response_code = code;
+                if (code != 200)
                 {
                     error = "Response code: " + line;
                     return std::string();
@@ -44,10 +44,29 @@ void filter_url_set_write_permission (const std::string& path);
 std::string filter_url_file_get_contents (const std::string& filename);
 void filter_url_file_put_contents (const std::string& filename, const std::string& contents);
 void filter_url_file_put_contents_append (const std::string& filename, const std::string& contents);
+struct filter_url_durable_statistics
+{
+  size_t writes {0};
+  size_t bytes {0};
+  size_t batches {0};
+  size_t syncs {0};
+  size_t failures {0};
+};
+bool filter_url_file_put_contents_durable (const std::string& filename, const std::string& contents);
+filter_url_durable_statistics filter_url_durable_metrics ();
 bool filter_url_file_cp (const std::string& input, const std::string& output);
 void filter_url_dir_cp (const std::string & input, const std::string & output);
 int filter_url_filesize (const std::string& filename);
 std::vector <std::string> filter_url_scandir (const std::string& folder);
+struct filter_url_scandir_statistics
+{
+  size_t hits {0};
+  size_t misses {0};
+  size_t invalidations {0};
+  size_t folders {0};
+};
+std::shared_ptr <const std::vector <std::string>> filter_url_scandir_shared (const std::string& folder);
+filter_url_scandir_statistics filter_url_scandir_metrics ();
 void filter_url_recursive_scandir (const std::string& folder, std::vector <std::string> & paths);
 int filter_url_file_modification_time (std::string filename);
 std::string filter_url_urldecode (std::string url);
@@ -58,7 +77,7 @@ std::string filter_url_escape_shell_argument (std::string argument);
 std::string filter_url_unique_path (std::string path);
 bool filter_url_email_is_valid (std::string email);
 std::string filter_url_build_http_query (std::string url, const std::vector<std::pair<std::string,std::string>> parameters_values);
-std::string filter_url_http_get (std::string url, std::string& error, bool check_certificate);
+std::string filter_url_http_get (std::string url, std::string& error, bool check_certificate, int* response_code = nullptr);
 std::string filter_url_http_post (const std::string & url, std::string post_data, const std::map <std::string, std::string> & post_values, std::string& error, bool burst, bool check_certificate, const std::vector <std::pair <std::string, std::string> > & headers);
 std::string filter_url_http_response_code_text (int code);
 void filter_url_download_file (std::string url, std::string filename, std::string& error, bool check_certificate);
@@ -70,7 +89,8 @@ std::string filter_url_tag_to_plus (std::string data);
 std::string filter_url_remove_username_password (std::string url);
 std::string filter_url_http_request_mbed (std::string url, std::string& error, 
                                           const std::map <std::string, std::string>& post,
-                                          const std::string& filename, bool check_certificate);
+                                          const std::string& filename, bool check_certificate,
+                                          int* response_code = nullptr);
 void filter_url_ssl_tls_initialize ();
 void filter_url_ssl_tls_finalize ();
 void filter_url_display_mbed_tls_error (int& ret, std::string* error, bool server, const std::string& remote_ip_address);
@@ -92,17 +92,35 @@ std::string one_string (const std::string& usfm)
 // If $code does not start with a marker, this becomes visible in the output too.
 std::vector <std::string> get_markers_and_text (std::string code)
 {
-  std::vector <std::string> markers_and_text;
-  // New line followed by backslash: leave new line out.
-  code = filter::string::replace ("\n\\", "\\", code);
-  // New line only: change to space, according to the USFM specification.
-  code = filter::string::replace ("\n", " ", code);
+  // Normalize the new lines in one pass over the code:
+  // - New line followed by backslash: leave new line out.
+  // - New line only: change to space, according to the USFM specification.
   // No removal of double spaces, because it would remove an opening marker
   // (which already has its own space), followed by a space.
-  code = filter::string::trim (code);
-  while (!code.empty ()) {
-    size_t pos = code.find ("\\");
-    if (pos == 0) {
+  size_t length {0};
+  for (size_t i = 0; i < code.size (); i++) {
+    char character = code [i];
+    if (character == '\n') {
+      if ((i + 1 < code.size ()) && (code [i + 1] == '\\'))
+        continue;
+      character = ' ';
+    }
+    code [length++] = character;
+  }
+  code.resize (length);
+
+  // Trim the code, and tokenize what remains, in one pass, without copying the remaining code.
+  const std::string_view whitespace {" \t\n\r"};
+  const size_t begin = code.find_first_not_of (whitespace);
+  if (begin == std::string::npos)
+    return {};
+  const size_t end = code.find_last_not_of (whitespace) + 1;
+  std::vector <std::string> markers_and_text;
+  markers_and_text.reserve ((end - begin) / 8);
+  size_t pos {begin};
+  while (pos < end) {
+    size_t next {pos + 1};
+    if (code [pos] == '\\') {
       // Marker found.
       // The marker ends
       // - after the first space, or
@@ -110,31 +128,21 @@ std::vector <std::string> get_markers_and_text (std::string code)
       // - at the first backslash (\), or
       // - at the end of the string,
       // whichever comes first.
-      std::vector <size_t> positions;
-      pos = code.find (" ");
-      if (pos != std::string::npos)
-        positions.push_back (pos + 1);
-      pos = code.find ("*");
-      if (pos != std::string::npos)
-        positions.push_back (pos + 1);
-      pos = code.find (R"(\)", 1);
-      if (pos != std::string::npos)
-        positions.push_back (pos);
-      positions.push_back (code.length());
-      sort (positions.begin (), positions.end());
-      pos = positions.at(0);
-      const std::string marker = code.substr (0, pos);
-      markers_and_text.push_back (marker);
-      code = code.substr (pos);
+      while (next < end) {
+        const char character = code [next];
+        if (character == '\\')
+          break;
+        next++;
+        if ((character == ' ') || (character == '*'))
+          break;
+      }
     } else {
       // Text found. It ends at the next backslash or at the end of the string.
-      pos = code.find (R"(\)");
-      if (pos == std::string::npos)
-        pos = code.length();
-      std::string text = code.substr (0, pos);
-      markers_and_text.push_back (text);
-      code = code.substr (pos);
+      while ((next < end) && (code [next] != '\\'))
+        next++;
     }
+    markers_and_text.emplace_back (code, pos, next - pos);
+    pos = next;
   }
   return markers_and_text;
 }
@@ -197,6 +205,7 @@ std::vector <BookChapterData> usfm_import (std::string input, std::string styles
   std::vector <std::string> markers_and_text = get_markers_and_text (input);
   bool retrieve_book_number_on_next_iteration = false;
   bool retrieve_chapter_number_on_next_iteration = false;
+  const auto styles = database::styles::get_snapshot (stylesheet);
 
   for (std::string& marker_or_text : markers_and_text) {
     if (retrieve_book_number_on_next_iteration) {
@@ -232,7 +241,7 @@ std::vector <BookChapterData> usfm_import (std::string input, std::string styles
       // Only opening markers can start on a new line.
       // Closing markers never do.
       if (opener) {
-        if (const stylesv2::Style* style {database::styles::get_marker_data (stylesheet, marker)}; style) {
+        if (const stylesv2::Style* style {styles->find (marker)}; style) {
           if (stylesv2::starts_new_line_in_usfm (style))
             chapter_data.append ("\n");
         }
@@ -390,6 +399,73 @@ std::string get_verse_text (std::string usfm, int verse_number)
 }
 
 
+ChapterVerses::ChapterVerses (std::string usfm) : m_usfm (std::move (usfm))
+{
+  // The verses of the most recent line that has verse markers.
+  // Lines without verse markers belong to those verses too.
+  std::vector <int> current_verses {};
+  bool in_verse_zero {true};
+  size_t offset {0};
+  // Split the lines the way filter::string::explode does: No empty line after a final new line.
+  while (offset < m_usfm.size ()) {
+    size_t end = m_usfm.find ('\n', offset);
+    if (end == std::string::npos)
+      end = m_usfm.size ();
+    const size_t line = m_lines.size ();
+    m_lines.emplace_back (offset, end - offset);
+    const std::string_view text (m_usfm.data () + offset, end - offset);
+    if (text.find ('\\') != std::string_view::npos) {
+      std::vector <int> verses = get_verse_numbers (std::string (text));
+      if (verses.size () != 1) {
+        in_verse_zero = false;
+        current_verses = std::move (verses);
+      }
+    }
+    if (in_verse_zero)
+      m_verse_zero_lines++;
+    for (const int verse : current_verses) {
+      std::vector <size_t>& lines = m_verse_lines [verse];
+      // A verse may occur more than once in a line, yet the line belongs to it once.
+      if (lines.empty () || (lines.back () != line))
+        lines.push_back (line);
+    }
+    offset = end + 1;
+  }
+}
+
+
+// Returns the same as filter::usfm::get_verse_text on the USFM of the chapter.
+std::string ChapterVerses::get_verse_text (const int verse) const
+{
+  // Verse 0 consists of the lines before the first verse.
+  if (verse == 0) {
+    if (!m_verse_zero_lines)
+      return std::string();
+    const auto& [offset, length] = m_lines [m_verse_zero_lines - 1];
+    return m_usfm.substr (0, offset + length);
+  }
+  const auto iter = m_verse_lines.find (verse);
+  if (iter == m_verse_lines.cend ())
+    return std::string();
+  const std::vector <size_t>& lines = iter->second;
+  std::string text {};
+  // Consecutive lines are a contiguous slice of the USFM, including the new lines between them.
+  size_t i {0};
+  while (i < lines.size ()) {
+    size_t j {i};
+    while ((j + 1 < lines.size ()) && (lines [j + 1] == lines [j] + 1))
+      j++;
+    const size_t begin = m_lines [lines [i]].first;
+    const size_t end = m_lines [lines [j]].first + m_lines [lines [j]].second;
+    if (i > 0)
+      text.append ("\n");
+    text.append (m_usfm, begin, end - begin);
+    i = j + 1;
+  }
+  return text;
+}
+
+
 // Gets the USFM for the $verse number for a Quill-based verse editor.
 // This means that preceding empty paragraphs will be included also.
 // And that empty paragraphs at the end will be omitted.
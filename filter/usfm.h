@@ -33,6 +33,23 @@ struct BookChapterData
   std::string m_data {};
 };
 
+// Splits the USFM of a chapter once into lines and the verses they belong to,
+// so that the text of each verse can be retrieved without parsing the chapter again.
+class ChapterVerses final
+{
+public:
+  explicit ChapterVerses (std::string usfm);
+  std::string get_verse_text (const int verse) const;
+private:
+  std::string m_usfm {};
+  // The offset and length of each line in the USFM.
+  std::vector <std::pair <size_t, size_t>> m_lines {};
+  // The number of lines before the first verse, which make up verse 0.
+  size_t m_verse_zero_lines {0};
+  // The indices of the lines that make up each verse.
+  std::unordered_map <int, std::vector <size_t>> m_verse_lines {};
+};
+
 std::string one_string (const std::string& usfm);
 std::vector <std::string> get_markers_and_text (std::string code);
 std::string get_marker (std::string usfm);
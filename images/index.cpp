@@ -60,9 +60,7 @@ std::string images_index (Webserver_Request& webserver_request)
     const std::string& folder = filter_url_tempfile ();
     filter_url_mkdir (folder);
     const std::string file = filter_url_create_path ({folder, webserver_request.post_get("filename")});
-    const std::string data = webserver_request.post_get("data");
-    if (!data.empty ()) {
-      filter_url_file_put_contents (file, data);
+    if (webserver_request.post_save("data", file)) {
       const bool background_import = filter::archive::is_archive (file);
       std::string extension = filter_url_get_extension (file);
       extension = filter::string::unicode_string_casefold (extension);
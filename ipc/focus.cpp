@@ -20,11 +20,15 @@
 #include <ipc/focus.h>
 #include <webserver/request.h>
 #include <database/cache.h>
+#include <database/ipc.h>
 #include <filter/string.h>
 
 
 namespace ipc_focus {
 
+// The command of the message that indicates a change of the focused passage.
+constexpr const char* focus_command {"focus"};
+
 // Check whether the focusgroup was added to the query.
 // If so return the passed group number.
 // If the group number is out of bounds, return the default group 0.
@@ -55,21 +59,42 @@ void set_passage (Webserver_Request& webserver_request, const int book, const in
   const int group {get_focus_group(webserver_request)};
   // Only set book if it was changed. Same for chapter and verse.
 //  const auto books = get_book(webserver_request);
+  bool changed {false};
   if (book != get_book(webserver_request)) {
     auto books = webserver_request.database_config_user()->get_focused_books();
     store_value_for_focus_group(books, group, book);
     webserver_request.database_config_user()->set_focused_books(books);
+    changed = true;
   }
   if (chapter != get_chapter(webserver_request)) {
     auto chapters = webserver_request.database_config_user()->get_focused_chapters();
     store_value_for_focus_group(chapters, group, chapter);
     webserver_request.database_config_user()->set_focused_chapters(chapters);
+    changed = true;
   }
   if (verse != get_verse(webserver_request)) {
     auto verses = webserver_request.database_config_user()->get_focused_verses();
     store_value_for_focus_group(verses, group, verse);
     webserver_request.database_config_user()->set_focused_verses(verses);
+    changed = true;
   }
+  // Wake up any requests waiting for the focus to change.
+  if (changed)
+    database_ipc::store_message(webserver_request.session_logic()->get_username(), "", focus_command, std::to_string(group));
+}
+
+
+// Returns the identifier of the most recent change of the focused passage of the user, or 0.
+int get_change (Webserver_Request& webserver_request)
+{
+  return database_ipc::retrieve_message(0, webserver_request.session_logic()->get_username(), "", focus_command).id;
+}
+
+
+// Waits till the focused passage of the user changes after the identifier passed, or till the timeout.
+void wait_change (Webserver_Request& webserver_request, const int change, const std::chrono::milliseconds timeout)
+{
+  database_ipc::wait_message(change, webserver_request.session_logic()->get_username(), focus_command, timeout);
 }
 
 
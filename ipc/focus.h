@@ -36,4 +36,7 @@ int get_book (Webserver_Request&);
 int get_chapter (Webserver_Request&);
 int get_verse (Webserver_Request&);
 
+int get_change (Webserver_Request&);
+void wait_change (Webserver_Request&, int change, std::chrono::milliseconds timeout);
+
 }
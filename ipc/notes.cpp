@@ -40,14 +40,24 @@ int get(Webserver_Request& webserver_request)
 }
 
 
+// Waits till there is a note to be opened, or till the timeout.
+// Returns the identifier of the note, or 0 if there was none.
+int wait(Webserver_Request& webserver_request, const std::chrono::milliseconds timeout)
+{
+    const std::string& user = webserver_request.session_logic()->get_username();
+    const database_ipc::Message data = database_ipc::wait_message(0, user, "opennote", timeout);
+    return filter::string::convert_to_int(data.message);
+}
+
+
 void erase(Webserver_Request& webserver_request)
 {
-    const database_ipc::Message data = database_ipc::get_note(webserver_request);
+    database_ipc::Message data = database_ipc::get_note(webserver_request);
     int counter = 0;
     while (data.id && counter < 100)
     {
-        const int id = data.id;
-        database_ipc::delete_message(id);
+        database_ipc::delete_message(data.id);
+        data = database_ipc::get_note(webserver_request);
         counter++;
     }
 }
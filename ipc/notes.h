@@ -27,6 +27,7 @@ namespace ipc_notes
 {
 void open (Webserver_Request& webserver_request, int identifier);
 int get (Webserver_Request& webserver_request);
+int wait (Webserver_Request& webserver_request, std::chrono::milliseconds timeout);
 void erase (Webserver_Request& webserver_request);
 bool alive (Webserver_Request& webserver_request, bool set, bool alive = false);
 }
@@ -62,9 +62,8 @@ std::string render_journal_entry (std::string filename, [[maybe_unused]] int use
   // The first 10 characters are the number of seconds past the Unix epoch,
   // followed by the number of microseconds within the current second.
 
-  // Get the contents of the file.
-  std::string path = filter_url_create_path ({database::logs::folder (), filename});
-  std::string entry = filter_url_file_get_contents (path);
+  // Get the contents of the entry.
+  std::string entry = database::logs::get_entry (filename);
   
   // Deal with the user-level of the entry.
   [[maybe_unused]] int entryLevel = filter::string::convert_to_int (entry);
@@ -131,11 +130,9 @@ std::string journal_index (Webserver_Request& webserver_request)
   
   std::string expansion = webserver_request.query ["expansion"];
   if (!expansion.empty ()) {
-    // Get file path.
-    expansion = filter_url_basename_web (expansion);
-    std::string path = filter_url_create_path ({database::logs::folder (), expansion});
     // Get contents of the record.
-    expansion = filter_url_file_get_contents (path);
+    expansion = filter_url_basename_web (expansion);
+    expansion = database::logs::get_entry (expansion);
     // Remove the user's level.
     expansion.erase (0, 2);
     // The only formatting currently allowed in the journal is new lines.
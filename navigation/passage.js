@@ -25,6 +25,7 @@ var navigationVerse;
 
 var navigatorContainer;
 var navigatorTimeout;
+var navigatorPollController;
 
 
 document.addEventListener("DOMContentLoaded", function(e) {
@@ -594,10 +595,18 @@ function navigationPollPassage ()
   if (navigatorTimeout) {
     clearTimeout (navigatorTimeout);
   }
-  const url = "/navigation/poll?focusgroup=" + focusGroup;
+  // The server holds the poll till the passage changes, so have one poll at a time.
+  if (navigatorPollController) {
+    navigatorPollController.abort ();
+  }
+  const controller = new AbortController ();
+  navigatorPollController = controller;
+  const started = Date.now ();
+  const url = "/navigation/poll?focusgroup=" + focusGroup + "&passage=" + navigationBook + "." + navigationChapter + "." + navigationVerse;
   fetch(url, {
     method: "GET",
-    cache: "no-cache"
+    cache: "no-cache",
+    signal: controller.signal
   })
   .then((response) => {
     if (!response.ok) {
@@ -619,10 +628,15 @@ function navigationPollPassage ()
     }
   })
   .catch((error) => {
-    console.log(error);
+    if (!controller.signal.aborted) console.log(error);
   })
   .finally(() => {
-    navigatorTimeout = setTimeout (navigationPollPassage, 1000);
+    // A newer poll replaced this one.
+    if (controller.signal.aborted) return;
+    navigatorPollController = null;
+    // Poll again right away, or after a second if the server replied straightaway.
+    const elapsed = Date.now () - started;
+    navigatorTimeout = setTimeout (navigationPollPassage, Math.max (0, 1000 - elapsed));
   });
 }
 
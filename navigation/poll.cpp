@@ -22,6 +22,7 @@
 #include <webserver/request.h>
 #include <navigation/passage.h>
 #include <ipc/focus.h>
+#include <database/ipc.h>
 
 
 std::string navigation_poll_url ()
@@ -38,12 +39,23 @@ bool navigation_poll_acl (Webserver_Request& webserver_request)
 
 std::string navigation_poll (Webserver_Request& webserver_request)
 {
-  int book = ipc_focus::get_book (webserver_request);
-  int chapter = ipc_focus::get_chapter (webserver_request);
-  int verse = ipc_focus::get_verse (webserver_request);
-  std::vector <std::string> passage;
-  passage.push_back (std::to_string (book));
-  passage.push_back (std::to_string (chapter));
-  passage.push_back (std::to_string (verse));
-  return filter::string::implode (passage, "\n");
+  const auto get_passage = [&webserver_request] () {
+    return std::vector <int> {ipc_focus::get_book (webserver_request), ipc_focus::get_chapter (webserver_request), ipc_focus::get_verse (webserver_request)};
+  };
+  // Take the most recent change before reading the passage, so no change gets missed.
+  const int change = ipc_focus::get_change (webserver_request);
+  std::vector <int> passage = get_passage ();
+  // The browser passes the passage it displays, like "1.2.3".
+  // If that is still the focused passage, hold the request till the focus changes.
+  if (const std::string_view displayed = webserver_request.query_get ("passage"); !displayed.empty ()) {
+    const std::string focused = std::to_string (passage.at(0)) + "." + std::to_string (passage.at(1)) + "." + std::to_string (passage.at(2));
+    if (displayed == focused) {
+      ipc_focus::wait_change (webserver_request, change, database_ipc::long_poll_timeout);
+      passage = get_passage ();
+    }
+  }
+  std::vector <std::string> lines;
+  for (const int number : passage)
+    lines.push_back (std::to_string (number));
+  return filter::string::implode (lines, "\n");
 }
@@ -27,6 +27,7 @@
 #include <locale/translate.h>
 #include <database/notes.h>
 #include <ipc/notes.h>
+#include <database/ipc.h>
 #include <access/logic.h>
 #include <developer/logic.h>
 
@@ -48,7 +49,8 @@ std::string notes_poll (Webserver_Request& webserver_request)
   const std::string action = webserver_request.query ["action"];
   if (action == "alive") {
     ipc_notes::alive (webserver_request, true, true);
-    const int identifier = ipc_notes::get (webserver_request);
+    // Hold the request till there is a note to be opened.
+    const int identifier = ipc_notes::wait (webserver_request, database_ipc::long_poll_timeout);
     if (identifier) {
       ipc_notes::erase (webserver_request);
       const std::string url = "note?id=" + std::to_string (identifier);
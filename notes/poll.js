@@ -30,8 +30,16 @@ document.addEventListener("DOMContentLoaded", function(e) {
 });
 
 
+// Whether a poll is underway.
+var notesPolling = false;
+
+
 function notesPoll ()
 {
+  // The server holds the poll till a note is to be opened, so one poll at a time is enough.
+  if (notesPolling) return;
+  notesPolling = true;
+  const started = Date.now ();
   const url = "poll?action=alive";
   fetch(url, {
     method: "GET",
@@ -54,7 +62,10 @@ function notesPoll ()
     console.log(error);
   })
   .finally(() => {
-    setTimeout (notesPoll, 1000);
+    notesPolling = false;
+    // Poll again right away, or after a second if the server replied straightaway.
+    const elapsed = Date.now () - started;
+    setTimeout (notesPoll, Math.max (0, 1000 - elapsed));
   });
 }
 
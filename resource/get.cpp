@@ -126,13 +126,6 @@ std::string resource_get (Webserver_Request& webserver_request)
       verses_before.erase (verses_before.begin ());
     }
   }
-  for (unsigned int i = 0; i < chapters_before.size (); i++) {
-    bits.push_back (resource_logic_get_html (webserver_request, s_resource, book, chapters_before[i], verses_before[i], add_verse_numbers));
-  }
-  
-  
-  // Focused verse.
-  bits.push_back (resource_logic_get_html (webserver_request, s_resource, book, chapter, verse, add_verse_numbers));
   
   
   // Context after the focused verse.
@@ -158,9 +151,17 @@ std::string resource_get (Webserver_Request& webserver_request)
       verses_after.pop_back ();
     }
   }
-  for (unsigned int i = 0; i < chapters_after.size (); i++) {
-    bits.push_back (resource_logic_get_html (webserver_request, s_resource, book, chapters_after[i], verses_after[i], add_verse_numbers));
-  }
+  
+  
+  // Fetch the context before, the focused verse, and the context after, in one go.
+  // This fetches the resource text per chapter rather than per verse.
+  std::vector <std::pair <int, int>> passages {};
+  for (unsigned int i = 0; i < chapters_before.size (); i++)
+    passages.emplace_back (chapters_before[i], verses_before[i]);
+  passages.emplace_back (chapter, verse);
+  for (unsigned int i = 0; i < chapters_after.size (); i++)
+    passages.emplace_back (chapters_after[i], verses_after[i]);
+  bits = resource_logic_get_html (webserver_request, s_resource, book, passages, add_verse_numbers);
   
 
   return prefix_resource_number(filter::string::implode (bits, std::string())); // <br>
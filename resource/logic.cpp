@@ -37,6 +37,7 @@
 #include <filter/roles.h>
 #include <filter/diff.h>
 #include <filter/google.h>
+#include <filter/date.h>
 #include <resource/external.h>
 #include <locale/translate.h>
 #include <client/logic.h>
@@ -44,11 +45,13 @@
 #include <sword/logic.h>
 #include <demo/logic.h>
 #include <sync/resources.h>
+#include <sync/logic.h>
 #include <tasks/logic.h>
 #include <related/logic.h>
 #include <developer/logic.h>
 #include <database/logic.h>
 #include <pugixml/utils.h>
+#include <nlohmann/json.hpp>
 
 #include <database/bibles.h>
 
@@ -133,6 +136,17 @@ std::vector <std::string> resource_logic_get_names (Webserver_Request& webserver
 std::string resource_logic_get_html (Webserver_Request& webserver_request,
                                      std::string resource, int book, int chapter, int verse,
                                      bool add_verse_numbers)
+{
+  return resource_logic_get_html (webserver_request, resource, book, {{chapter, verse}}, add_verse_numbers).front ();
+}
+
+
+// Gets the html of a $resource for each of the $passages, given as chapter and verse.
+// It fetches the text of the resource per chapter rather than per verse.
+std::vector <std::string> resource_logic_get_html (Webserver_Request& webserver_request,
+                                                   const std::string& resource, const int book,
+                                                   const std::vector <std::pair <int, int>>& passages,
+                                                   const bool add_verse_numbers)
 {
   // Determine the type of the resource.
   bool is_bible = resource_logic_is_bible (resource);
@@ -145,29 +159,36 @@ std::string resource_logic_get_html (Webserver_Request& webserver_request,
   bool is_comparative = resource_logic_is_comparative (resource);
   bool is_translated = resource_logic_is_translated(resource);
 
+  std::vector <std::string> htmls {};
+
   // Handle a comparative resource.
   // This type of resource is special.
   // It is not one resource, but made out of two resources.
   // It fetches data from two resources and combines that into one.
-  if (is_comparative) {
-#ifdef HAVE_CLOUD
-    return resource_logic_cloud_get_comparison (webserver_request, resource, book, chapter, verse, add_verse_numbers);
-#endif
-#ifdef HAVE_CLIENT
-    return resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verse);
-#endif
-  }
-
   // Handle a translated resource.
   // This type of resource is special.
   // It consists of any of the other types of resources, as the base resource.
   // It gets that data, and then has that translated.
-  if (is_translated) {
+  if (is_comparative || is_translated) {
 #ifdef HAVE_CLOUD
-    return resource_logic_cloud_get_translation (webserver_request, resource, book, chapter, verse, add_verse_numbers);
+    for (const auto& [chapter, verse] : passages) {
+      if (is_comparative)
+        htmls.push_back (resource_logic_cloud_get_comparison (webserver_request, resource, book, chapter, verse, add_verse_numbers));
+      else
+        htmls.push_back (resource_logic_cloud_get_translation (webserver_request, resource, book, chapter, verse, add_verse_numbers));
+    }
+    return htmls;
 #endif
 #ifdef HAVE_CLIENT
-    return resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verse);
+    std::map <int, std::vector <int>> chapters_verses {};
+    for (const auto& [chapter, verse] : passages)
+      chapters_verses [chapter].push_back (verse);
+    std::map <int, std::map <int, std::string>> texts {};
+    for (const auto& [chapter, verses] : chapters_verses)
+      texts [chapter] = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verses);
+    for (const auto& [chapter, verse] : passages)
+      htmls.push_back (texts [chapter] [verse]);
+    return htmls;
 #endif
   }
   
@@ -195,63 +216,122 @@ std::string resource_logic_get_html (Webserver_Request& webserver_request,
   } else {
   }
 
-  // If the resource versification system differs from the Bible's versification system,
-  // map the focused verse of the Bible to a verse in the Resource.
-  // There are resources without versification system: Do nothing about them.
-  std::vector <Passage> passages;
-  if ((bible_versification != resource_versification) && !resource_versification.empty ()) {
-    passages = database_mappings.translate (bible_versification, resource_versification, book, chapter, verse);
-  } else {
-    passages.push_back (Passage ("", book, chapter, std::to_string (verse)));
-  }
-
-  // If there's been a mapping, the resource should include the verse number for clarity.
-  if (passages.size () != 1) add_verse_numbers = true;
-  for (auto passage : passages) {
-    if (verse != filter::string::convert_to_int (passage.verse())) {
-      add_verse_numbers = true;
+  // The passages in the resource to display per requested passage,
+  // each with the text to put before it.
+  std::vector <std::vector <std::pair <Passage, std::string>>> displays {};
+  // The verses to fetch from the resource, per book and chapter.
+  std::map <std::pair <int, int>, std::set <int>> chapters_verses {};
+
+  for (const auto& [chapter, verse] : passages) {
+
+    // If the resource versification system differs from the Bible's versification system,
+    // map the focused verse of the Bible to a verse in the Resource.
+    // There are resources without versification system: Do nothing about them.
+    std::vector <Passage> mapped_passages;
+    if ((bible_versification != resource_versification) && !resource_versification.empty ()) {
+      mapped_passages = database_mappings.translate (bible_versification, resource_versification, book, chapter, verse);
+    } else {
+      mapped_passages.push_back (Passage ("", book, chapter, std::to_string (verse)));
     }
-  }
-  
-  // Flag for whether to add the full passage (e.g. Matthew 1:1) to the text of that passage.
-  bool add_passages_in_full = false;
 
-  // Deal with user's preference whether to include related passages.
-  if (webserver_request.database_config_user ()->get_include_related_passages ()) {
-    
-    // Take the Bible's active passage and mapping, and translate that to the original mapping.
-    std::vector <Passage> related_passages = database_mappings.translate (bible_versification, database_mappings.original (), book, chapter, verse);
-    
-    // Look for related passages.
-    related_passages = related_logic_get_verses (related_passages);
-    
-    add_passages_in_full = !related_passages.empty ();
+    // If there's been a mapping, the resource should include the verse number for clarity.
+    bool add_numbers = add_verse_numbers;
+    if (mapped_passages.size () != 1) add_numbers = true;
+    for (const auto& passage : mapped_passages) {
+      if (verse != filter::string::convert_to_int (passage.verse())) {
+        add_numbers = true;
+      }
+    }
     
-    // If there's any related passages, map them to the resource's versification system.
-    if (!related_passages.empty ()) {
-      if (!resource_versification.empty ()) {
-        if (resource_versification != database_mappings.original ()) {
-          passages.clear ();
-          for (auto & related_passage : related_passages) {
-            std::vector <Passage> mapped_passages = database_mappings.translate (database_mappings.original (), resource_versification, related_passage.book(), related_passage.chapter(), filter::string::convert_to_int (related_passage.verse()));
-            passages.insert (passages.end (), mapped_passages.begin (), mapped_passages.end ());
+    // Flag for whether to add the full passage (e.g. Matthew 1:1) to the text of that passage.
+    bool add_passages_in_full = false;
+
+    // Deal with user's preference whether to include related passages.
+    if (webserver_request.database_config_user ()->get_include_related_passages ()) {
+      
+      // Take the Bible's active passage and mapping, and translate that to the original mapping.
+      std::vector <Passage> related_passages = database_mappings.translate (bible_versification, database_mappings.original (), book, chapter, verse);
+      
+      // Look for related passages.
+      related_passages = related_logic_get_verses (related_passages);
+      
+      add_passages_in_full = !related_passages.empty ();
+      
+      // If there's any related passages, map them to the resource's versification system.
+      if (!related_passages.empty ()) {
+        if (!resource_versification.empty ()) {
+          if (resource_versification != database_mappings.original ()) {
+            mapped_passages.clear ();
+            for (auto & related_passage : related_passages) {
+              std::vector <Passage> related_mapped_passages = database_mappings.translate (database_mappings.original (), resource_versification, related_passage.book(), related_passage.chapter(), filter::string::convert_to_int (related_passage.verse()));
+              mapped_passages.insert (mapped_passages.end (), related_mapped_passages.begin (), related_mapped_passages.end ());
+            }
           }
         }
       }
     }
+
+    std::vector <std::pair <Passage, std::string>> display {};
+    for (const auto& passage : mapped_passages) {
+      std::string possible_included_passage;
+      if (add_numbers) possible_included_passage = passage.verse ()+ " ";
+      if (add_passages_in_full) possible_included_passage = filter_passage_display (passage.book(), passage.chapter(), passage.verse()) + " ";
+      display.emplace_back (passage, possible_included_passage);
+      chapters_verses [{passage.book (), passage.chapter ()}].insert (filter::string::convert_to_int (passage.verse ()));
+    }
+    displays.push_back (std::move (display));
   }
 
-  std::string html {};
+  // Fetch the text of the resource, a chapter at a time.
+  std::map <std::pair <int, int>, std::map <int, std::string>> texts {};
+  for (const auto& [book_chapter, verses] : chapters_verses) {
+    texts [book_chapter] = resource_logic_get_verses (webserver_request, resource, book_chapter.first, book_chapter.second, std::vector <int> (verses.begin (), verses.end ()));
+  }
 
-  for (auto passage : passages) {
-    std::string possible_included_passage;
-    if (add_verse_numbers) possible_included_passage = passage.verse ()+ " ";
-    if (add_passages_in_full) possible_included_passage = filter_passage_display (passage.book(), passage.chapter(), passage.verse()) + " ";
-    html.append (possible_included_passage);
-    html.append (resource_logic_get_verse (webserver_request, resource, passage.book(), passage.chapter(), filter::string::convert_to_int (passage.verse())));
+  for (const auto& display : displays) {
+    std::string html {};
+    for (const auto& [passage, possible_included_passage] : display) {
+      html.append (possible_included_passage);
+      html.append (texts [{passage.book (), passage.chapter ()}] [filter::string::convert_to_int (passage.verse ())]);
+    }
+    htmls.push_back (std::move (html));
   }
   
-  return html;
+  return htmls;
+}
+
+
+// Any font size given in a paragraph style may interfere with the font size setting for the resources
+// as given in Bibledit. For that reason remove the class name from a paragraph style.
+static std::string resource_logic_clean_verse (std::string data)
+{
+  for (unsigned int i = 0; i < 5; i++) {
+    std::string fragment = "p class=\"";
+    size_t pos = data.find (fragment);
+    if (pos != std::string::npos) {
+      size_t pos2 = data.find ("\"", pos + fragment.length () + 1);
+      if (pos2 != std::string::npos) {
+        data.erase (pos + 1, pos2 - pos);
+      }
+    }
+  }
+  
+  // NET Bible updates.
+  data = filter::string::replace ("<span class=\"s ", "<span class=\"", data);
+
+  return data;
+}
+
+
+// Converts the USFM of one verse of a resource to html.
+static std::string resource_logic_usfm_verse_html (const std::string& resource, const std::string& verse_usfm)
+{
+  std::string stylesheet = stylesv2::standard_sheet ();
+  Filter_Text filter_text = Filter_Text (resource);
+  filter_text.html_text_standard = new HtmlText ("");
+  filter_text.add_usfm_code (verse_usfm);
+  filter_text.run (stylesheet);
+  return filter_text.html_text_standard->get_inner_html ();
 }
 
 
@@ -260,7 +340,18 @@ std::string resource_logic_get_html (Webserver_Request& webserver_request,
 // It uses the cache.
 std::string resource_logic_get_verse (Webserver_Request& webserver_request, std::string resource, int book, int chapter, int verse)
 {
-  std::string data {};
+  return resource_logic_get_verses (webserver_request, resource, book, chapter, {verse}) [verse];
+}
+
+
+// Fetches the text of the $verses in one $chapter of a $resource.
+// It determines the type of the resource once,
+// reads a chapter of USFM once,
+// and on a client, it queries the cache once.
+// Returns the text per verse.
+std::map <int, std::string> resource_logic_get_verses (Webserver_Request& webserver_request, const std::string& resource, const int book, const int chapter, const std::vector <int>& verses)
+{
+  std::map <int, std::string> texts {};
 
   // Determine the type of the current resource.
   bool isBible = resource_logic_is_bible (resource);
@@ -282,54 +373,41 @@ std::string resource_logic_get_verse (Webserver_Request& webserver_request, std:
     if (isBible) 
       chapter_usfm = database::bibles::get_chapter (resource, book, chapter);
     if (isLocalUsfm) chapter_usfm = database::usfm_resources::get_usfm (resource, book, chapter);
-    std::string verse_usfm = filter::usfm::get_verse_text (chapter_usfm, verse);
-    std::string stylesheet = stylesv2::standard_sheet ();
-    Filter_Text filter_text = Filter_Text (resource);
-    filter_text.html_text_standard = new HtmlText ("");
-    filter_text.add_usfm_code (verse_usfm);
-    filter_text.run (stylesheet);
-    data = filter_text.html_text_standard->get_inner_html ();
+    for (const int verse : verses)
+      texts [verse] = resource_logic_usfm_verse_html (resource, filter::usfm::get_verse_text (chapter_usfm, verse));
   } else if (isRemoteUsfm) {
-    data = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verse);
+    texts = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verses);
   } else if (isExternal) {
 #ifdef HAVE_CLIENT
     // A client fetches it from the cache or from the Cloud.
-    data = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verse);
+    texts = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verses);
 #else
     // The server fetches it from the web, via the http cache.
-    data.append (resource_external_cloud_fetch_cache_extract (resource, book, chapter, verse));
+    for (const int verse : verses)
+      texts [verse] = resource_external_cloud_fetch_cache_extract (resource, book, chapter, verse);
 #endif
   } else if (isLexicon) {
-    data = lexicon_logic_get_html (webserver_request, resource, book, chapter, verse);
+    for (const int verse : verses)
+      texts [verse] = lexicon_logic_get_html (webserver_request, resource, book, chapter, verse);
   } else if (isSword) {
     const std::string sword_module = sword_logic_get_remote_module (resource);
     const std::string sword_source = sword_logic_get_source (resource);
-    data = sword_logic_get_text (sword_source, sword_module, book, chapter, verse);
+    for (const int verse : verses)
+      texts [verse] = sword_logic_get_text (sword_source, sword_module, book, chapter, verse);
   } else if (isBibleGateway) {
-    data = resource_logic_bible_gateway_get (resource, book, chapter, verse);
+    for (const int verse : verses)
+      texts [verse] = resource_logic_bible_gateway_get (resource, book, chapter, verse);
   } else if (isStudyLight) {
-    data = resource_logic_study_light_get (resource, book, chapter, verse);
+    for (const int verse : verses)
+      texts [verse] = resource_logic_study_light_get (resource, book, chapter, verse);
   } else {
     // Nothing found.
   }
   
-  // Any font size given in a paragraph style may interfere with the font size setting for the resources
-  // as given in Bibledit. For that reason remove the class name from a paragraph style.
-  for (unsigned int i = 0; i < 5; i++) {
-    std::string fragment = "p class=\"";
-    size_t pos = data.find (fragment);
-    if (pos != std::string::npos) {
-      size_t pos2 = data.find ("\"", pos + fragment.length () + 1);
-      if (pos2 != std::string::npos) {
-        data.erase (pos + 1, pos2 - pos);
-      }
-    }
-  }
-  
-  // NET Bible updates.
-  data = filter::string::replace ("<span class=\"s ", "<span class=\"", data);
+  for (const int verse : verses)
+    texts [verse] = resource_logic_clean_verse (std::move (texts [verse]));
 
-  return data;
+  return texts;
 }
 
 
@@ -460,13 +538,7 @@ std::string resource_logic_get_contents_for_client (std::string resource, int bo
   if (is_usfm) {
     // Fetch from database and convert to html.
     std::string chapter_usfm = database::usfm_resources::get_usfm (resource, book, chapter);
-    std::string verse_usfm = filter::usfm::get_verse_text (chapter_usfm, verse);
-    std::string stylesheet = stylesv2::standard_sheet ();
-    Filter_Text filter_text = Filter_Text (resource);
-    filter_text.html_text_standard = new HtmlText ("");
-    filter_text.add_usfm_code (verse_usfm);
-    filter_text.run (stylesheet);
-    return filter_text.html_text_standard->get_inner_html ();
+    return resource_logic_usfm_verse_html (resource, filter::usfm::get_verse_text (chapter_usfm, verse));
   }
   
   if (is_sword) {
@@ -507,6 +579,24 @@ std::string resource_logic_get_contents_for_client (std::string resource, int bo
 }
 
 
+// Fetches the contents of the $verses in a $chapter of a $resource for a client.
+// For a USFM resource it reads the chapter once.
+// Returns the contents per verse.
+std::map <int, std::string> resource_logic_get_contents_for_client (const std::string& resource, const int book, const int chapter, const std::vector <int>& verses)
+{
+  std::map <int, std::string> contents {};
+  if (resource_logic_is_usfm (resource) && !resource_logic_is_external (resource)) {
+    const std::string chapter_usfm = database::usfm_resources::get_usfm (resource, book, chapter);
+    for (const int verse : verses)
+      contents [verse] = resource_logic_usfm_verse_html (resource, filter::usfm::get_verse_text (chapter_usfm, verse));
+    return contents;
+  }
+  for (const int verse : verses)
+    contents [verse] = resource_logic_get_contents_for_client (resource, book, chapter, verse);
+  return contents;
+}
+
+
 // The client runs this function to fetch a general resource $name from the Cloud,
 // or from its local cache,
 // and to update the local cache with the fetched content, if needed,
@@ -562,6 +652,93 @@ std::string resource_logic_client_fetch_cache_from_cloud (std::string resource,
 }
 
 
+// Whether the Cloud can serve several verses of a resource at once.
+// Older Cloud versions cannot.
+static std::atomic <bool> resource_logic_cloud_serves_verses {true};
+
+
+// The client runs this function to fetch the $verses in a $chapter of a resource from the Cloud,
+// or from its local cache.
+// It reads the verses available in the cache in one query,
+// and fetches the verses not yet in the cache from the Cloud in one request.
+// Returns the contents per verse.
+std::map <int, std::string> resource_logic_client_fetch_cache_from_cloud (const std::string& resource, const int book, const int chapter, const std::vector <int>& verses)
+{
+  // Whether the client should cache this resource.
+  const bool cache = !filter::string::in_array(resource, client_logic_no_cache_resources_get ());
+  
+  // Ensure that the cache for this resource exists on the client.
+  if (cache && !database::cache::sql::exists (resource, book)) {
+    database::cache::sql::create (resource, book);
+  }
+  
+  // Take the content that exists in the cache.
+  std::map <int, std::string> contents {};
+  std::vector <int> missing {};
+  std::map <int, std::string> cached {};
+  if (cache)
+    cached = database::cache::sql::retrieve (resource, book, chapter);
+  for (const int verse : verses) {
+    if (const auto iterator = cached.find (verse); iterator != cached.end ())
+      contents [verse] = iterator->second;
+    else
+      missing.push_back (verse);
+  }
+  
+  // Fetch the verses missing from the cache from Bibledit Cloud in one go.
+  if ((missing.size () > 1) && resource_logic_cloud_serves_verses) {
+    std::string address = database::config::general::get_server_address ();
+    int port = database::config::general::get_server_port ();
+    if (!client_logic_client_enabled ()) {
+      address = demo_address ();
+      port = demo_port ();
+    }
+    std::vector <std::string> numbers {};
+    for (const int verse : missing)
+      numbers.push_back (std::to_string (verse));
+    const std::string url = filter_url_build_http_query (client_logic_url(address, port, sync_resources_url ()), {
+      {"a", std::to_string (Sync_Logic::resources_request_verses)},
+      {"r", filter_url_urlencode (resource)},
+      {"b", std::to_string (book)},
+      {"c", std::to_string (chapter)},
+      {"vs", filter::string::implode (numbers, " ")},
+    });
+    std::string error {};
+    int response_code {0};
+    const std::string response = filter_url_http_get (url, error, false, &response_code);
+    if (error.empty () && (response_code == 200)) {
+      try {
+        const nlohmann::json json = nlohmann::json::parse (response);
+        if (!json.is_object ())
+          throw std::runtime_error ("Expected a JSON object");
+        std::vector <int> remaining {};
+        for (const int verse : missing) {
+          const std::string key = std::to_string (verse);
+          if (!json.contains (key)) {
+            remaining.push_back (verse);
+            continue;
+          }
+          const std::string content = json [key].get <std::string> ();
+          if (cache && database::cache::can_cache (error, content))
+            database::cache::sql::cache (resource, book, chapter, verse, content);
+          contents [verse] = content;
+        }
+        missing = std::move (remaining);
+      } catch (...) { }
+    } else if (response_code == 400) {
+      // A Cloud that does not know this request responds with a bad request.
+      // Fetch the verses one by one from now on.
+      resource_logic_cloud_serves_verses = false;
+    }
+  }
+
+  // Fetch any remaining verses one by one.
+  for (const int verse : missing)
+    contents [verse] = resource_logic_client_fetch_cache_from_cloud (resource, book, chapter, verse);
+
+  return contents;
+}
+
 std::string resource_logic_yellow_divider ()
 {
   return "Yellow Divider";
@@ -669,25 +846,98 @@ std::string resource_logic_get_divider (std::string resource)
 }
 
 
-// In Cloud mode, this function wraps around http GET.
-// It fetches existing content from the cache, and caches new content.
-std::string resource_logic_web_or_cache_get (std::string url, std::string& error)
+// The web pages fetched most recently, kept in memory above the file cache.
+// A scraper fetches the same chapter page once for every verse in it,
+// so this tier makes one download serve all the verses.
+// It holds the pages from most to least recently used, up to a total size.
+// A page expires after the shortest time the file cache keeps a page that is not used,
+// so a changed page gets fetched again, and the client, which has no file cache, gets it too.
+constexpr size_t web_memory_capacity {16 * 1024 * 1024};
+constexpr int web_memory_seconds {2 * 3600};
+struct web_page {
+  std::string url {};
+  std::shared_ptr <const std::string> html {};
+  int expiry {0};
+};
+static std::list <web_page> web_memory {};
+static std::unordered_map <std::string, std::list <web_page>::iterator> web_memory_index {};
+static size_t web_memory_size {0};
+
+
+// A fetch of a web page that is in progress.
+// Other callers that need the same URL wait for it, rather than fetching it again.
+struct web_fetch {
+  bool done {false};
+  std::string html {};
+  std::string error {};
+};
+static std::unordered_map <std::string, std::shared_ptr <web_fetch>> web_fetches {};
+static std::mutex web_mutex {};
+static std::condition_variable web_condition {};
+
+
+// Returns the page at the $url from memory, or nullptr if it's not there or has expired.
+// The caller should hold the web mutex.
+static std::shared_ptr <const std::string> web_memory_get (const std::string& url)
+{
+  const auto iter = web_memory_index.find (url);
+  if (iter == web_memory_index.end ())
+    return nullptr;
+  if (iter->second->expiry < filter::date::get_seconds_since_epoch ()) {
+    web_memory_size -= iter->second->html->size ();
+    web_memory.erase (iter->second);
+    web_memory_index.erase (iter);
+    return nullptr;
+  }
+  web_memory.splice (web_memory.begin (), web_memory, iter->second);
+  return iter->second->html;
+}
+
+
+// Stores the page at the $url in memory, and removes the least recently used pages if needed.
+// The caller should hold the web mutex.
+static void web_memory_put (const std::string& url, const std::string& html)
 {
+  if (html.size () > web_memory_capacity / 4)
+    return;
+  if (const auto iter = web_memory_index.find (url); iter != web_memory_index.end ()) {
+    web_memory_size -= iter->second->html->size ();
+    web_memory.erase (iter->second);
+    web_memory_index.erase (iter);
+  }
+  web_memory.push_front ({url, std::make_shared <const std::string> (html), filter::date::get_seconds_since_epoch () + web_memory_seconds});
+  web_memory_index [url] = web_memory.begin ();
+  web_memory_size += html.size ();
+  while (web_memory_size > web_memory_capacity) {
+    const web_page& page = web_memory.back ();
+    web_memory_size -= page.html->size ();
+    web_memory_index.erase (page.url);
+    web_memory.pop_back ();
+  }
+}
+
+
+// Fetches the $url from the file cache or else from the network.
+static std::string web_fetch_get (const std::string& url, std::string& error, bool& cacheable)
+{
+  error.clear ();
+
 #ifndef HAVE_CLIENT
   // On the Cloud, check if the URL is in the cache.
   if (database::cache::file::exists (url)) {
+    cacheable = true;
     return database::cache::file::get (url);
   }
 #endif
 
   // Fetch the URL from the network.
-  error.clear ();
   std::string html = filter_url_http_get (url, error, false);
 
+  // Cache the response based on certain criteria.
+  cacheable = database::cache::can_cache (error, html);
 #ifdef HAVE_CLOUD
-  // In the Cloud, cache the response based on certain criteria.
-  const bool cache = database::cache::can_cache (error, html);
-  if (cache) {
+  // In the Cloud, cache it in a file too.
+  if (cacheable) {
     database::cache::file::put (url, html);
   }
 #endif
@@ -697,6 +947,59 @@ std::string resource_logic_web_or_cache_get (std::string url, std::string& error
 }
 
 
+// Gets the page at the $url from memory, the file cache, or the network.
+// When several callers need the same page at once, only one of them fetches it.
+std::string resource_logic_web_or_cache_get (std::string url, std::string& error)
+{
+  std::shared_ptr <web_fetch> fetch {};
+  {
+    std::unique_lock lock (web_mutex);
+    if (const auto html = web_memory_get (url); html)
+      return *html;
+    if (const auto iter = web_fetches.find (url); iter != web_fetches.end ()) {
+      // Another caller fetches this page already: Wait for the result.
+      fetch = iter->second;
+      web_condition.wait (lock, [&fetch] { return fetch->done; });
+      error = fetch->error;
+      return fetch->html;
+    }
+    fetch = std::make_shared <web_fetch> ();
+    web_fetches [url] = fetch;
+  }
+
+  bool cacheable {false};
+  std::string html {};
+  try {
+    html = web_fetch_get (url, error, cacheable);
+  }
+  catch (...) {
+    error = "Failure to fetch " + url;
+  }
+
+  {
+    std::lock_guard lock (web_mutex);
+    if (cacheable)
+      web_memory_put (url, html);
+    fetch->html = html;
+    fetch->error = error;
+    fetch->done = true;
+    web_fetches.erase (url);
+  }
+  web_condition.notify_all ();
+  return html;
+}
+
+
+// Clears the web pages kept in memory.
+void resource_logic_web_cache_clear ()
+{
+  std::lock_guard lock (web_mutex);
+  web_memory.clear ();
+  web_memory_index.clear ();
+  web_memory_size = 0;
+}
+
+
 // Returns the page type for the resource selector.
 std::string resource_logic_selector_page (Webserver_Request& webserver_request)
 {
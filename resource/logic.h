@@ -26,7 +26,12 @@ class Webserver_Request;
 std::string resource_logic_get_html (Webserver_Request& webserver_request,
                                      std::string resource, int book, int chapter, int verse,
                                      bool add_verse_numbers);
+std::vector <std::string> resource_logic_get_html (Webserver_Request& webserver_request,
+                                                   const std::string& resource, int book,
+                                                   const std::vector <std::pair <int, int>>& passages,
+                                                   bool add_verse_numbers);
 std::string resource_logic_get_verse (Webserver_Request& webserver_request, std::string resource, int book, int chapter, int verse);
+std::map <int, std::string> resource_logic_get_verses (Webserver_Request& webserver_request, const std::string& resource, int book, int chapter, const std::vector <int>& verses);
 std::string resource_logic_cloud_get_comparison (Webserver_Request& webserver_request,
                                                  std::string resource, int book, int chapter, int verse,
                                                  bool add_verse_numbers);
@@ -34,7 +39,9 @@ std::string resource_logic_cloud_get_translation (Webserver_Request& webserver_r
                                                   const std::string & resource, int book, int chapter, int verse,
                                                   bool add_verse_numbers);
 std::string resource_logic_get_contents_for_client (std::string resource, int book, int chapter, int verse);
+std::map <int, std::string> resource_logic_get_contents_for_client (const std::string& resource, int book, int chapter, const std::vector <int>& verses);
 std::string resource_logic_client_fetch_cache_from_cloud (std::string resource, int book, int chapter, int verse);
+std::map <int, std::string> resource_logic_client_fetch_cache_from_cloud (const std::string& resource, int book, int chapter, const std::vector <int>& verses);
 
 std::vector <std::string> resource_logic_get_names (Webserver_Request& webserver_request, bool bibles_only);
 
@@ -51,6 +58,7 @@ std::string resource_logic_assemble_rich_divider (std::string title, std::string
                                                   std::string foreground, std::string background);
 
 std::string resource_logic_web_or_cache_get (std::string url, std::string & error);
+void resource_logic_web_cache_clear ();
 
 std::string resource_logic_selector_page (Webserver_Request& webserver_request);
 std::string resource_logic_selector_caller (Webserver_Request& webserver_request);
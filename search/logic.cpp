@@ -81,10 +81,15 @@ void search_logic_index_chapter (std::string bible, int book, int chapter)
   std::set <std::string> already_processed;
   
   std::vector <int> verses = filter::usfm::get_verse_numbers (usfm);
+  const filter::usfm::ChapterVerses chapter_verses (usfm);
+
+  // Text filter for getting the plain text.
+  // The one object gets reset for every verse.
+  Filter_Text filter_text = Filter_Text (bible);
   
   for (auto verse : verses) {
 
-    std::string raw_usfm = filter::string::trim (filter::usfm::get_verse_text (usfm, verse));
+    std::string raw_usfm = filter::string::trim (chapter_verses.get_verse_text (verse));
 
     // In case of combined verses, the bit of USFM may have been indexed already.
     // Skip it in that case.
@@ -103,9 +108,9 @@ void search_logic_index_chapter (std::string bible, int book, int chapter)
 
     index.push_back (usfm_lower);
     
-    // Text filter for getting the plain text.
-    Filter_Text filter_text = Filter_Text (bible);
-    filter_text.text_text = new Text_Text ();
+    filter_text.reset ();
+    if (!filter_text.text_text)
+      filter_text.text_text = new Text_Text ();
     filter_text.initializeHeadingsAndTextPerVerse (true);
     filter_text.add_usfm_code (raw_usfm);
     filter_text.run (stylesheet);
@@ -23,52 +23,154 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <filter/roles.h>
 #include <filter/usfm.h>
 #include <database/logs.h>
+#include <database/logic.h>
 #include <database/bibles.h>
+#include <database/jobs.h>
 #include <database/config/general.h>
 #include <search/logic.h>
 #include <locale/translate.h>
 
 
-bool search_reindex_bibles_running = false;
+static std::atomic <bool> search_reindex_bibles_running {false};
 
 
-void search_reindex_bibles (bool force)
+// The file that lists the chapters done so far in a forced reindex.
+// While it exists, a forced reindex is in progress.
+// After a restart, the reindex resumes with the chapters not listed here.
+static std::string search_reindex_bibles_checkpoint ()
 {
-  if (!database::config::general::get_index_bibles ()) return;
+  return filter_url_create_root_path ({database_logic_databases (), "search_reindex_bibles.txt"});
+}
+
+
+// The chapters of one Bible to be indexed, and how far the indexing is.
+struct search_reindex_bible {
+  std::string bible {};
+  std::vector <std::pair <int, int>> chapters {};
+  std::atomic <size_t> done {0};
+};
+
+
+// Indexes the Bibles.
+// $force: Index all chapters, not only those without an index.
+// $job_id: If not zero, the job that shows the progress to the user.
+void search_reindex_bibles (bool force, const int job_id)
+{
+  // The job page waits for a result, so give it one when not indexing.
+  if (!database::config::general::get_index_bibles ()) {
+    if (job_id)
+      database_jobs::set_result (job_id, translate ("Indexing Bibles is off"));
+    return;
+  }
   
   
   // One simultaneous instance.
-  if (search_reindex_bibles_running) {
+  if (search_reindex_bibles_running.exchange (true)) {
     database::logs::log (translate ("Still indexing Bibles"), roles::manager);
+    if (job_id)
+      database_jobs::set_result (job_id, translate ("Still indexing Bibles"));
     return;
   }
-  search_reindex_bibles_running = true;
 
   
-  std::string indexing_bible = translate ("Indexing Bible:");
+  const std::string indexing_bible = translate ("Indexing Bible:");
+  if (job_id) {
+    database_jobs::set_start (job_id, indexing_bible + " " + translate ("Checking"));
+  }
+
+  
+  // A forced reindex starts a new checkpoint.
+  // A normal reindex continues a forced one that was interrupted.
+  const std::string checkpoint = search_reindex_bibles_checkpoint ();
+  std::set <std::string> checkpointed {};
+  if (force) {
+    filter_url_file_put_contents (checkpoint, std::string());
+  } else if (file_or_dir_exists (checkpoint)) {
+    force = true;
+    for (auto& file : filter::string::explode (filter_url_file_get_contents (checkpoint), '\n'))
+      checkpointed.insert (std::move (file));
+    database::logs::log (indexing_bible + " " + translate ("Resuming after") + " " + std::to_string (checkpointed.size ()) + " " + translate ("chapters"), roles::manager);
+  }
 
   
   // This checks whether the data in the search index exists for all chapters in all Bibles.
   // If it does not exist for a certain chapter, the index will be created.
-  std::vector <std::string> bibles = database::bibles::get_bibles ();
-  for (auto & bible : bibles) {
+  std::vector <std::unique_ptr <search_reindex_bible>> bibles {};
+  std::vector <std::pair <search_reindex_bible*, size_t>> work {};
+  for (const auto& bible : database::bibles::get_bibles ()) {
     database::logs::log (indexing_bible + " " + translate ("Checking") + " " + bible, roles::manager);
-    std::vector <int> books = database::bibles::get_books (bible);
-    for (auto book : books) {
-      std::vector <int> chapters = database::bibles::get_chapters (bible, book);
-      for (auto chapter : chapters) {
-        std::string index = search_logic_chapter_file (bible, book, chapter);
-        if (!file_or_dir_exists (index) || force) {
-          std::string msg = indexing_bible + " " + bible + " " + filter_passage_display (book, chapter, "");
-          database::logs::log (msg, roles::manager);
-          search_logic_index_chapter (bible, book, chapter);
-        }
+    auto& item = bibles.emplace_back (std::make_unique <search_reindex_bible> ());
+    item->bible = bible;
+    for (const int book : database::bibles::get_books (bible)) {
+      for (const int chapter : database::bibles::get_chapters (bible, book)) {
+        const std::string index = search_logic_chapter_file (bible, book, chapter);
+        const bool needed = force ? !checkpointed.count (index) : !file_or_dir_exists (index);
+        if (needed)
+          item->chapters.emplace_back (book, chapter);
       }
     }
+    for (size_t i {0}; i < item->chapters.size (); i++)
+      work.emplace_back (item.get (), i);
   }
+
   
+  // Progress goes to the job, and to the Journal per Bible.
+  std::mutex progress_mutex {};
+  std::vector <std::string> completed {};
+  size_t completed_count {0};
+  const auto flush_checkpoint = [&] () {
+    if (!completed.empty ()) {
+      filter_url_file_put_contents_append (checkpoint, filter::string::implode (completed, "\n") + "\n");
+      completed.clear ();
+    }
+  };
+  const auto report = [&] (search_reindex_bible& item, const int book, const int chapter) {
+    const std::string index = search_logic_chapter_file (item.bible, book, chapter);
+    const size_t done = ++item.done;
+    std::lock_guard lock (progress_mutex);
+    completed_count++;
+    if (force) {
+      completed.push_back (index);
+      if (completed.size () >= 100)
+        flush_checkpoint ();
+    }
+    if (done == item.chapters.size ()) {
+      database::logs::log (indexing_bible + " " + item.bible + " " + std::to_string (done) + " " + translate ("chapters"), roles::manager);
+    }
+    if (job_id && ((completed_count % 50 == 0) || (completed_count == work.size ()))) {
+      database_jobs::set_percentage (job_id, static_cast <int> (100 * completed_count / work.size ()));
+      database_jobs::set_progress (job_id, item.bible + " " + filter_passage_display (book, chapter, "") + " " + std::to_string (done) + "/" + std::to_string (item.chapters.size ()));
+    }
+  };
+
   
+  // The chapters get indexed by a bounded number of workers,
+  // leaving processor time for serving the users.
+  std::atomic <size_t> next {0};
+  const auto worker = [&] () {
+    for (size_t i = next++; i < work.size (); i = next++) {
+      const auto [item, position] = work [i];
+      const auto [book, chapter] = item->chapters [position];
+      search_logic_index_chapter (item->bible, book, chapter);
+      report (*item, book, chapter);
+    }
+  };
+  const size_t worker_count = std::min (std::max (std::thread::hardware_concurrency () / 2, 1u), 4u);
+  std::vector <std::thread> workers {};
+  for (size_t i {1}; i < std::min (worker_count, work.size ()); i++)
+    workers.emplace_back (worker);
+  worker ();
+  for (auto& thread : workers)
+    thread.join ();
+
+  
+  // The reindex is complete, so the checkpoint is no longer needed.
+  filter_url_unlink (checkpoint);
   database::logs::log (indexing_bible + " " + translate ("Ready"), roles::manager);
+  if (job_id) {
+    database_jobs::set_percentage (job_id, 100);
+    database_jobs::set_result (job_id, indexing_bible + " " + translate ("Ready") + " " + std::to_string (work.size ()) + " " + translate ("chapters"));
+  }
   database::config::general::set_index_bibles (false);
   search_reindex_bibles_running = false;
 }
@@ -21,4 +21,4 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <config/libraries.h>
 
-void search_reindex_bibles (bool force);
+void search_reindex_bibles (bool force, int job_id = 0);
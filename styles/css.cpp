@@ -60,8 +60,8 @@ void Styles_Css::generate()
     }
     std::ranges::for_each(database::styles::get_markers(m_stylesheet), [this](const auto& marker)
     {
-        const stylesv2::Style* style = database::styles::get_marker_data(m_stylesheet, marker);
-        evaluate(style);
+        const auto style = database::styles::get_marker_data(m_stylesheet, marker);
+        evaluate(style.get());
     });
 }
 
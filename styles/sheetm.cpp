@@ -90,7 +90,7 @@ std::string styles_sheetm(Webserver_Request& webserver_request)
         auto previous_category{stylesv2::Category::unknown};
         for (const auto& marker : markers_v2)
         {
-            const stylesv2::Style* style{database::styles::get_marker_data(sheet_name, marker)};
+            const auto style{database::styles::get_marker_data(sheet_name, marker)};
             if (style->category != previous_category)
             {
                 pugi::xml_node tr_node = html_block.append_child("tr");
@@ -69,7 +69,7 @@ std::string styles_view (Webserver_Request& webserver_request)
   // It means that the marker data is always set with something.
   stylesv2::Style marker_data;
   {
-    const stylesv2::Style* marker_data_ptr = database::styles::get_marker_data (sheet, style);
+    const auto marker_data_ptr = database::styles::get_marker_data (sheet, style);
     if (marker_data_ptr) {
       marker_data = *marker_data_ptr;
     } else {
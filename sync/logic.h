@@ -109,6 +109,7 @@ public:
   static constexpr int resources_request_text = 0;
   static constexpr int resources_request_database = 1;
   static constexpr int resources_request_download = 2;
+  static constexpr int resources_request_verses = 3;
 
   bool security_okay ();
   bool credentials_okay ();
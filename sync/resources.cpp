@@ -26,6 +26,7 @@
 #include <database/cache.h>
 #include <database/config/general.h>
 #include <tasks/logic.h>
+#include <nlohmann/json.hpp>
 
 
 std::string sync_resources_url ()
@@ -99,6 +100,26 @@ std::string sync_resources (Webserver_Request& webserver_request)
       {
         return database::cache::sql::path (resource, book);
       }
+
+      case Sync_Logic::resources_request_verses:
+      {
+        // Serve several verses of a chapter at once, as a JSON object keyed by verse number.
+        std::vector <int> verses {};
+        for (const auto& number : filter::string::explode (webserver_request.query ["vs"], ' ')) {
+          const int vs = filter::string::convert_to_int (number);
+          if ((vs < 0) || (vs > 200) || (verses.size () >= 200)) {
+            request_ok = false;
+            break;
+          }
+          verses.push_back (vs);
+        }
+        if (!request_ok)
+          break;
+        nlohmann::json json = nlohmann::json::object ();
+        for (const auto& [vs, contents] : resource_logic_get_contents_for_client (resource, book, chapter, verses))
+          json [std::to_string (vs)] = contents;
+        return json.dump (-1, ' ', false, nlohmann::json::error_handler_t::replace);
+      }
       
       default: {};
     }
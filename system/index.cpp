@@ -156,9 +156,7 @@ std::string system_index (Webserver_Request& webserver_request)
   if (webserver_request.query.count (importbibles)) {
     if (webserver_request.post_count("upload")) {
       const std::string datafile = filter_url_tempfile () + webserver_request.post_get("filename");
-      const std::string data = webserver_request.post_get("data");
-      if (!data.empty ()) {
-        filter_url_file_put_contents (datafile, data);
+      if (webserver_request.post_save("data", datafile)) {
         success = translate("Import has started.");
         view.set_variable ("journal", journal_logic_see_journal_for_progress ());
         tasks_logic_queue (tasks::enums::task::import_bibles_transferfile, { datafile });
@@ -180,9 +178,7 @@ std::string system_index (Webserver_Request& webserver_request)
   if (webserver_request.query.count (importnotes)) {
     if (webserver_request.post_count("upload")) {
       const std::string datafile = filter_url_tempfile () + webserver_request.post_get("filename");
-      const std::string data = webserver_request.post_get("data");
-      if (!data.empty ()) {
-        filter_url_file_put_contents (datafile, data);
+      if (webserver_request.post_save("data", datafile)) {
         success = translate("Import has started.");
         view.set_variable ("journal", journal_logic_see_journal_for_progress ());
         tasks_logic_queue (tasks::enums::task::import_notes_transferfile, { datafile });
@@ -204,9 +200,7 @@ std::string system_index (Webserver_Request& webserver_request)
   if (webserver_request.query.count (importresources)) {
     if (webserver_request.post_count("upload")) {
       const std::string datafile = filter_url_tempfile () + webserver_request.post_get("filename");
-      const std::string data = webserver_request.post_get("data");
-      if (!data.empty ()) {
-        filter_url_file_put_contents (datafile, data);
+      if (webserver_request.post_save("data", datafile)) {
         success = translate("Import has started.");
         view.set_variable ("journal", journal_logic_see_journal_for_progress ());
         tasks_logic_queue (tasks::enums::task::import_resources_transferfile, { datafile });
@@ -226,8 +220,10 @@ std::string system_index (Webserver_Request& webserver_request)
   // Force re-index Bibles.
   if (webserver_request.query ["reindex"] == "bibles") {
     database::config::general::set_index_bibles (true);
-    tasks_logic_queue (tasks::enums::task::reindex_bibles, {"1"});
-    redirect_browser (webserver_request, journal_index_url ());
+    const int job_id = database_jobs::get_new_id ();
+    database_jobs::set_level (job_id, roles::manager);
+    tasks_logic_queue (tasks::enums::task::reindex_bibles, {"1", std::to_string (job_id)});
+    redirect_browser (webserver_request, jobs_index_url () + "?id=" + std::to_string (job_id));
     return {};
   }
   
@@ -263,8 +259,7 @@ std::string system_index (Webserver_Request& webserver_request)
   if (webserver_request.post_count("uploadfont")) {
     const std::string filename = webserver_request.post_get("filename");
     const std::string path = filter_url_create_root_path ({"fonts", filename});
-    const std::string fontdata = webserver_request.post_get("fontdata");
-    filter_url_file_put_contents (path, fontdata);
+    webserver_request.post_save("fontdata", path);
     success = translate("The font has been uploaded.");
   }
   
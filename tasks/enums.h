@@ -59,6 +59,7 @@ enum class task
     export_web_index,
     export_online_bible,
     export_esword,
+    export_combined,
     setup_paratext,
     sync_paratext,
     refresh_sword_modules,
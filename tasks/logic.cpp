@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <demo/logic.h>
 #include <email/receive.h>
 #include <email/send.h>
+#include <export/combined.h>
 #include <export/esword.h>
 #include <export/html.h>
 #include <export/index.h>
@@ -115,6 +116,7 @@ std::string to_string(const tasks::enums::task& task)
     case tasks::enums::task::export_web_index: return "export web index";
     case tasks::enums::task::export_online_bible: return "export online bible";
     case tasks::enums::task::export_esword: return "export esword";
+    case tasks::enums::task::export_combined: return "export combined";
     case tasks::enums::task::setup_paratext: return "setup paratext";
     case tasks::enums::task::sync_paratext: return "sync paratext";
     case tasks::enums::task::refresh_sword_modules: return "refresh sword modules";
@@ -235,7 +237,7 @@ static void tasks_logic_run_one(Task task)
         }
     case tasks::enums::task::reindex_bibles:
         {
-            search_reindex_bibles(filter::string::convert_to_bool(parameter1));
+            search_reindex_bibles(filter::string::convert_to_bool(parameter1), filter::string::convert_to_int(parameter2));
             break;
         }
     case tasks::enums::task::reindex_notes:
@@ -398,6 +400,15 @@ static void tasks_logic_run_one(Task task)
             export_onlinebible(parameter1, filter::string::convert_to_bool(parameter2));
             break;
         }
+    case tasks::enums::task::export_combined:
+        {
+            std::vector<int> formats{};
+            for (const auto& format : filter::string::explode(parameter3, ' '))
+                formats.push_back(filter::string::convert_to_int(format));
+            export_combined(parameter1, filter::string::convert_to_int(parameter2), formats,
+                            filter::string::convert_to_bool(parameter4));
+            break;
+        }
     case tasks::enums::task::setup_paratext:
         {
             Paratext_Logic::setup(parameter1, parameter2);
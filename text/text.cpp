@@ -86,3 +86,13 @@ std::string Text_Text::getnote ()
   note ();
   return filter::string::implode (notes, "\n");
 }
+
+
+// Empties the text and the notes, for reusing the object.
+void Text_Text::clear ()
+{
+  output.clear ();
+  thisline.clear ();
+  notes.clear ();
+  thisnoteline.clear ();
+}
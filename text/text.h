@@ -32,6 +32,7 @@ public:
   void note (std::string text = "");
   void addnotetext (std::string text);
   std::string getnote ();
+  void clear ();
 private:
   std::vector <std::string> output {};
   std::string thisline {};
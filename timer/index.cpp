@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <checks/logic.h>
 #include <config/globals.h>
 #include <database/logs.h>
+#include <database/login.h>
 #include <database/state.h>
 #include <database/config/general.h>
 #include <developer/logic.h>
@@ -127,6 +128,9 @@ void timer_index()
             if (minute == previous_minute) continue;
             previous_minute = minute;
 
+            // Every minute write the timestamps of the logins used today.
+            database::login::write_timestamps();
+
             // Every minute send out queued email.
             if (!tasks_logic_queued(tasks::enums::task::send_email))
                 tasks_logic_queue(tasks::enums::task::send_email);
@@ -31,7 +31,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <database/bibleactions.h>
 #include <filter/usfm.h>
 #include <filter/string.h>
+#include <filter/url.h>
 #include <bb/logic.h>
+#include <database/login.h>
+#include <database/users.h>
+#include <filter/roles.h>
+#include <edit/update.h>
+#include <compare/compare.h>
+#include <database/jobs.h>
+#include <resource/logic.h>
+#include <database/usfmresources.h>
+#include <sync/resources.h>
+#include <sync/logic.h>
+#include <nlohmann/json.hpp>
 
 
 static constexpr const char* bible {"bible"};
@@ -884,6 +896,116 @@ TEST (bibles, entire_pipeline_for_editor_updates)
 }
 
 
+TEST (bibles, chapter_editor_verse_updates)
+{
+  refresh_sandbox (false);
+  Webserver_Request webserver_request;
+  Database_State::create ();
+  database::login::create ();
+  webserver_request.database_users ()->create ();
+  webserver_request.database_users ()->upgrade ();
+  webserver_request.database_users ()->add_user ("manager", "password", roles::manager, "");
+  webserver_request.session_logic ()->attempt_login ("manager", "password", true);
+  database::bibles::create_bible (bible);
+  database::bibles::store_chapter (bible, 1, 1, usfm_separate);
+
+  // Post the edited verses and get the response after the checksum and read-write lines.
+  const auto update = [&webserver_request] (const int revision, const std::string& loaded, const std::string& edited) {
+    webserver_request.post = {
+      {"bible", bible}, {"book", "1"}, {"chapter", "1"}, {"revision", std::to_string (revision)},
+      {"verses", "2"}, {"loaded2", loaded}, {"edited2", edited}, {"checksum", std::to_string (loaded.size () + edited.size ())}
+    };
+    std::vector <std::string> lines = filter::string::explode (edit_update (webserver_request), '\n');
+    lines.erase (lines.begin (), lines.begin () + 2);
+    return filter::string::implode (lines, "\n");
+  };
+  const std::string loaded = R"(<p><span class="i-v">2</span> Verse two two two two two two.</p>)";
+
+  // Saving a verse of a chapter the editor is in sync with needs no updates if the server has what the editor has.
+  {
+    const int revision = database::bibles::get_chapter_id (bible, 1, 1);
+    const std::string edited = R"(<p><span class="i-v">2</span> Verse two two two two two three.</p>)";
+    const std::string response = update (revision, loaded, edited);
+    EXPECT_EQ ("Saved#_be_#" + std::to_string (database::bibles::get_chapter_id (bible, 1, 1)) + "#_be_#1", response);
+    EXPECT_EQ (filter::string::replace ("two two.", "two three.", usfm_separate), database::bibles::get_chapter (bible, 1, 1));
+  }
+
+  // The server collapses the double space in the saved verse: The editor gets that update for the verse.
+  {
+    database::bibles::store_chapter (bible, 1, 1, usfm_separate);
+    const int revision = database::bibles::get_chapter_id (bible, 1, 1);
+    const std::string edited = R"(<p><span class="i-v">2</span> Verse  two two two two two two.</p>)";
+    const std::string response = update (revision, loaded, edited);
+    EXPECT_EQ ("Saved#_be_#" + std::to_string (database::bibles::get_chapter_id (bible, 1, 1)) + "#_be_#1#_be_#2#_be_#v#_be_#9#_be_#d#_be_#1", response);
+  }
+
+  // The chapter changed on the server since the revision the editor has:
+  // The verse gets merged and saved, and the editor should update the whole chapter.
+  {
+    database::bibles::store_chapter (bible, 1, 1, usfm_separate);
+    const int revision = database::bibles::get_chapter_id (bible, 1, 1);
+    database::bibles::store_chapter (bible, 1, 1, filter::string::replace ("Verse 5.", "Verse five.", usfm_separate));
+    const std::string edited = R"(<p><span class="i-v">2</span> Verse two two two two two three.</p>)";
+    const std::string response = update (revision, loaded, edited);
+    EXPECT_EQ ("Saved#_be_#" + std::to_string (database::bibles::get_chapter_id (bible, 1, 1)) + "#_be_#0", response);
+    std::string standard = filter::string::replace ("two two.", "two three.", usfm_separate);
+    standard = filter::string::replace ("Verse 5.", "Verse five.", standard);
+    EXPECT_EQ (standard, database::bibles::get_chapter (bible, 1, 1));
+  }
+
+  // Without any edits, the editor in sync with the server gets no updates.
+  {
+    const int revision = database::bibles::get_chapter_id (bible, 1, 1);
+    webserver_request.post = {{"bible", bible}, {"book", "1"}, {"chapter", "1"}, {"revision", std::to_string (revision)}, {"verses", ""}, {"checksum", "0"}};
+    const std::string response = edit_update (webserver_request);
+    EXPECT_TRUE (response.ends_with ("#_be_#" + std::to_string (revision) + "#_be_#1"));
+  }
+}
+
+
+TEST (bibles, compare)
+{
+  refresh_sandbox (false);
+  database_jobs::create ();
+  constexpr const char* other {"other"};
+  database::bibles::create_bible (bible);
+  database::bibles::create_bible (other);
+  // Many equal chapters, a few changed ones, and one chapter absent from the other Bible.
+  for (int chapter {1}; chapter <= 50; chapter++) {
+    const std::string usfm = filter::string::replace ("c 1", "c " + std::to_string (chapter), usfm_separate);
+    database::bibles::store_chapter (bible, 1, chapter, usfm);
+    if (chapter == 50)
+      continue;
+    if ((chapter == 7) || (chapter == 31))
+      database::bibles::store_chapter (other, 1, chapter, filter::string::replace ("Verse 3.", "Verse three.", usfm));
+    else
+      database::bibles::store_chapter (other, 1, chapter, usfm);
+  }
+  const int job_id = database_jobs::get_new_id ();
+  compare_compare (bible, other, job_id);
+  const std::string result = database_jobs::get_result (job_id);
+  EXPECT_EQ ("100", database_jobs::get_percentage (job_id));
+  // The differences are in the order of the chapters.
+  const std::string standard =
+  R"(<p>Bible "bible" has been compared with "other".</p>)" "\n"
+  R"(<p>Additions are in bold. Removed words are in strikethrough.</p>)" "\n"
+  R"(<br>)" "\n"
+  R"(<p>Genesis 7:3 3 Verse <span style="text-decoration: line-through;"> three. </span> <span style="font-weight: bold;"> 3. </span></p>)" "\n"
+  R"(<p>Genesis 31:3 3 Verse <span style="text-decoration: line-through;"> three. </span> <span style="font-weight: bold;"> 3. </span></p>)" "\n"
+  R"(<br>)" "\n"
+  R"(<p>Bible/Resource "other" does not contain Genesis 50.</p>)" "\n"
+  R"(<br>)" "\n"
+  R"(<p>Genesis 7:3 \v 3 Verse <span style="text-decoration: line-through;"> three. </span> <span style="font-weight: bold;"> 3. </span></p>)" "\n"
+  R"(<p>Genesis 31:3 \v 3 Verse <span style="text-decoration: line-through;"> three. </span> <span style="font-weight: bold;"> 3. </span></p>)" "\n"
+  R"(<br>)" "\n"
+  R"(<p>The texts as they are in the Bible bible</p>)" "\n"
+  R"(<br>)" "\n"
+  R"(<p>Genesis 7:3 3 Verse 3.</p>)" "\n"
+  R"(<p>Genesis 31:3 3 Verse 3.</p>)";
+  EXPECT_EQ (standard, result);
+}
+
+
 TEST (bibles, database_bibleactions)
 {
   refresh_sandbox (false);
@@ -1143,4 +1265,107 @@ TEST (bibles, database_bibles)
 }
 
 
+
+// The index of the chapters is read from disk once, and kept in step by the database.
+TEST (bibles, chapter_index)
+{
+  const std::string testbible {"testbible"};
+  refresh_sandbox (true);
+  Database_State::create ();
+  database::bibles::create_bible (testbible);
+  database::bibles::store_chapter (testbible, 2, 1, "one");
+  database::bibles::store_chapter (testbible, 2, 1, "two");
+  database::bibles::store_chapter (testbible, 1, 3, "three");
+  database::bibles::store_chapter (testbible, 1, 10, "ten");
+
+  // A revision written to disk directly is not seen till the index gets read again.
+  const std::string chapter_folder = filter_url_create_path ({database::bibles::bible_folder (testbible), "2", "1"});
+  filter_url_file_put_contents (filter_url_create_path ({chapter_folder, "100000009"}), "nine");
+  EXPECT_EQ ("two", database::bibles::get_chapter (testbible, 2, 1));
+  EXPECT_EQ (100'000'002, database::bibles::get_chapter_id (testbible, 2, 1));
+  database::bibles::clear_index ();
+  EXPECT_EQ ("nine", database::bibles::get_chapter (testbible, 2, 1));
+  EXPECT_EQ (100'000'009, database::bibles::get_chapter_id (testbible, 2, 1));
+  EXPECT_EQ ((std::vector <int>{1, 2}), database::bibles::get_books (testbible));
+  EXPECT_EQ ((std::vector <int>{3, 10}), database::bibles::get_chapters (testbible, 1));
+
+  // Storing and deleting updates the index.
+  database::bibles::store_chapter (testbible, 2, 1, "ten");
+  EXPECT_EQ ("ten", database::bibles::get_chapter (testbible, 2, 1));
+  EXPECT_EQ (100'000'010, database::bibles::get_chapter_id (testbible, 2, 1));
+  database::bibles::delete_chapter (testbible, 1, 3);
+  EXPECT_EQ ((std::vector <int>{10}), database::bibles::get_chapters (testbible, 1));
+  EXPECT_EQ (std::string(), database::bibles::get_chapter (testbible, 1, 3));
+  database::bibles::delete_book (testbible, 2);
+  EXPECT_EQ ((std::vector <int>{1}), database::bibles::get_books (testbible));
+  database::bibles::delete_bible (testbible);
+  EXPECT_EQ (std::vector <int>{}, database::bibles::get_books (testbible));
+  EXPECT_EQ (std::string(), database::bibles::get_chapter (testbible, 1, 10));
+  database::bibles::create_bible (testbible);
+  database::bibles::store_chapter (testbible, 1, 10, "new");
+  EXPECT_EQ (100'000'001, database::bibles::get_chapter_id (testbible, 1, 10));
+}
+
+
+// A Bible as a resource gives its text per chapter, and the html per passage.
+TEST (bibles, resource_verses_per_chapter)
+{
+  refresh_sandbox (false);
+  Webserver_Request webserver_request;
+  Database_State::create ();
+  database::login::create ();
+  webserver_request.database_users ()->create ();
+  webserver_request.database_users ()->upgrade ();
+  webserver_request.database_users ()->add_user ("manager", "password", roles::manager, "");
+  webserver_request.session_logic ()->attempt_login ("manager", "password", true);
+  database::bibles::create_bible (bible);
+  database::bibles::store_chapter (bible, 1, 1, usfm_separate);
+  database::bibles::store_chapter (bible, 1, 2, filter::string::replace (R"(\c 1)", R"(\c 2)", usfm_combined));
+
+  // The verses of a chapter fetched in one go are the same as when fetched one by one.
+  const std::map <int, std::string> verses = resource_logic_get_verses (webserver_request, bible, 1, 1, {2, 3, 9});
+  EXPECT_EQ (3, verses.size ());
+  for (const auto& [verse, html] : verses)
+    EXPECT_EQ (resource_logic_get_verse (webserver_request, bible, 1, 1, verse), html);
+  EXPECT_EQ (R"(<p><span class="v">2</span><span> </span><span>Verse two two two two two two.</span></p><p/>)", verses.at (2));
+
+  // The html of passages spread over two chapters, in the order requested.
+  const std::vector <std::pair <int, int>> passages {{2, 1}, {1, 5}, {2, 6}};
+  const std::vector <std::string> htmls = resource_logic_get_html (webserver_request, bible, 1, passages, true);
+  const std::vector <std::string> standard {
+    R"(1 <p><span class="v">1</span><span> </span><span>Verse 1.</span></p>)",
+    R"(5 <p><span class="v">5</span><span> </span><span>Verse 5.</span></p>)",
+    R"(6 <p><span class="v">6</span><span> </span><span>Verse 6.</span></p>)",
+  };
+  EXPECT_EQ (standard, htmls);
+  EXPECT_EQ (htmls.at (1), resource_logic_get_html (webserver_request, bible, 1, 1, 5, true));
+}
+
+
+// The Cloud serves several verses of a USFM resource to a client as one JSON object.
+TEST (bibles, sync_resources_verses)
+{
+  refresh_sandbox (false);
+  const std::string resource {"usfm"};
+  database::usfm_resources::store_chapter (resource, 1, 1, usfm_separate);
+  Webserver_Request webserver_request;
+  webserver_request.query = {
+    {"a", std::to_string (Sync_Logic::resources_request_verses)},
+    {"r", resource}, {"b", "1"}, {"c", "1"}, {"vs", "2 5"},
+  };
+  const nlohmann::json json = nlohmann::json::parse (sync_resources (webserver_request));
+  ASSERT_TRUE (json.is_object ());
+  EXPECT_EQ (2, json.size ());
+  EXPECT_EQ (resource_logic_get_contents_for_client (resource, 1, 1, 2), json ["2"].get <std::string> ());
+  EXPECT_EQ (resource_logic_get_contents_for_client (resource, 1, 1, 5), json ["5"].get <std::string> ());
+  EXPECT_NE (std::string::npos, json ["5"].get <std::string> ().find ("Verse 5."));
+  EXPECT_EQ (200, webserver_request.response_code);
+
+  // A verse out of range is a bad request.
+  webserver_request.query ["vs"] = "2 201";
+  EXPECT_TRUE (sync_resources (webserver_request).empty ());
+  EXPECT_EQ (400, webserver_request.response_code);
+}
+
+
 #endif
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #pragma GCC diagnostic pop
 #include <unittests/utilities.h>
 #include <database/cache.h>
+#include <database/logic.h>
 #include <filter/url.h>
 #include <filter/shell.h>
 #include <filter/string.h>
@@ -54,6 +55,8 @@ TEST (database, cache)
   EXPECT_EQ (true, exists);
   std::string value = database::cache::sql::retrieve ("unittests", 8, 1, 16);
   EXPECT_EQ ("And Ruth said, Entreat me not to leave you, or to return from following you; for wherever you go, I will go, and wherever you lodge, I will lodge; your people shall be my people, and your God my God.", value);
+  // The whole chapter in one go gives the same value for the verse.
+  EXPECT_EQ (value, database::cache::sql::retrieve ("unittests", 8, 1) [16]);
   
   // Now remove the (old) cache and verify that it no longer exists or contains data.
   database::cache::sql::remove ("unittests");
@@ -79,6 +82,13 @@ TEST (database, cache)
   value = database::cache::sql::retrieve ("unittests", 1, 2, 3);
   EXPECT_EQ ("cached", value);
   
+  // Retrieve all cached verses of a chapter.
+  database::cache::sql::cache ("unittests", 1, 2, 5, "five");
+  database::cache::sql::cache ("unittests", 1, 3, 3, "other chapter");
+  EXPECT_EQ ((std::map <int, std::string>{{3, "cached"}, {5, "five"}}), database::cache::sql::retrieve ("unittests", 1, 2));
+  EXPECT_TRUE (database::cache::sql::retrieve ("unittests", 1, 4).empty ());
+  EXPECT_TRUE (database::cache::sql::retrieve ("unittests", 2, 2).empty ());
+  
   // Book count check.
   count = database::cache::sql::count ("unittests");
   EXPECT_EQ (2, count);
@@ -149,5 +159,64 @@ TEST (database, cache)
   refresh_sandbox (false);
 }
 
+
+// The file-based cache removes the least recently used files once it grows beyond its budget.
+TEST (database, cache_budget)
+{
+  refresh_sandbox (false);
+  database::cache::file::trim (true);
+  database::cache::file::set_budget (3'000);
+  const std::string kilobyte (1'000, 'x');
+  const auto url = [] (const int i) { return "https://site.org/page/" + std::to_string (i); };
+  for (int i {0}; i < 3; i++)
+    database::cache::file::put (url (i), kilobyte);
+  for (int i {0}; i < 3; i++)
+    EXPECT_TRUE (database::cache::file::exists (url (i)));
+
+  // Using the first page makes the second page the least recently used one.
+  EXPECT_EQ (kilobyte, database::cache::file::get (url (0)));
+  database::cache::file::put (url (3), kilobyte);
+  EXPECT_TRUE (database::cache::file::exists (url (0)));
+  EXPECT_FALSE (database::cache::file::exists (url (1)));
+  EXPECT_TRUE (database::cache::file::exists (url (2)));
+  EXPECT_TRUE (database::cache::file::exists (url (3)));
+
+  // A smaller budget removes more files right away.
+  database::cache::file::set_budget (1'000);
+  EXPECT_FALSE (database::cache::file::exists (url (2)));
+  EXPECT_TRUE (database::cache::file::exists (url (3)));
+
+  // Clearing the cache removes all files, and sets the budget from the disk space.
+  database::cache::file::trim (true);
+  EXPECT_FALSE (database::cache::file::exists (url (3)));
+  for (int i {0}; i < 5; i++)
+    database::cache::file::put (url (i), kilobyte);
+  for (int i {0}; i < 5; i++)
+    EXPECT_TRUE (database::cache::file::exists (url (i)));
+
+  // Storing pages from several threads while they evict each other's pages
+  // leaves on disk only the page the index still holds.
+  database::cache::file::trim (true);
+  database::cache::file::set_budget (1'000);
+  {
+    std::vector <std::thread> threads {};
+    for (int t {0}; t < 4; t++) {
+      threads.emplace_back ([&url, &kilobyte, t] () {
+        for (int i {0}; i < 50; i++)
+          database::cache::file::put (url (t * 1'000 + i % 5), kilobyte);
+      });
+    }
+    for (auto& thread : threads)
+      thread.join ();
+  }
+  database::cache::file::put (url (0), kilobyte);
+  EXPECT_TRUE (database::cache::file::exists (url (0)));
+  std::vector <std::string> paths {};
+  filter_url_recursive_scandir (filter_url_create_root_path ({database_logic_databases (), "cache"}), paths);
+  EXPECT_EQ (1, std::ranges::count_if (paths, [] (const std::string& path) { return !filter_url_is_dir (path); }));
+  refresh_sandbox (false);
+}
+
+
 #endif
 
@@ -124,6 +124,26 @@ TEST(database, config_bible)
     set_line_height("b", 200);
     EXPECT_EQ(get_line_height("b"), 200);
     EXPECT_EQ(get_repeat_send_receive("test"), 0);
+
+    // Several threads reading and setting values at once, as the Bible comparison does.
+    {
+        const std::string standard = get_export_stylesheet("b");
+        std::vector<std::thread> threads{};
+        for (int t {0}; t < 4; t++) {
+            threads.emplace_back([t, &standard]() {
+                for (int i {0}; i < 100; i++) {
+                    const std::string bible = "concurrent" + std::to_string(i % 10);
+                    EXPECT_EQ(get_export_stylesheet(bible), standard);
+                    EXPECT_EQ(get_odt_space_after_verse(bible), " ");
+                    if (t == 0)
+                        set_line_height(bible, 100 + i);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        EXPECT_EQ(get_line_height("concurrent9"), 199);
+    }
 }
 
 
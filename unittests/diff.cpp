@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <unittests/utilities.h>
 #include <filter/diff.h>
 #include <filter/url.h>
+#include <filter/string.h>
 #include <webserver/request.h>
 #include <database/modifications.h>
 #include <database/state.h>
@@ -359,5 +360,71 @@ Genesis 1.3 3 And God said: "Let there be light". And there was light.
   refresh_sandbox (true);
 }
 
+
+// The diff engine keeps its state per call, so many threads can run it at once.
+// Each thread checks its results against those obtained on a single thread.
+TEST (filter, diff_multithreaded)
+{
+  const std::string usfm = filter_url_file_get_contents (filter_url_create_root_path ({"unittests", "tests", "08-Ruth.usfm"}));
+  std::vector <std::string> old_texts {}, new_texts {};
+  for (const auto& line : filter::string::explode (usfm, '\n')) {
+    old_texts.push_back (line);
+    std::string changed = filter::string::replace ("the", "THE", line);
+    changed = filter::string::replace (",", "", changed);
+    new_texts.push_back (changed);
+  }
+  struct result_type {
+    std::string html {};
+    std::vector <std::string> removals {};
+    std::vector <std::string> additions {};
+    int character_similarity {0};
+    int word_similarity {0};
+    bool operator== (const result_type&) const = default;
+  };
+  const auto run = [&old_texts, &new_texts] (const size_t i) {
+    result_type result {};
+    result.html = filter_diff_diff (old_texts [i], new_texts [i], &result.removals, &result.additions);
+    result.character_similarity = filter_diff_character_similarity (old_texts [i], new_texts [i]);
+    result.word_similarity = filter_diff_word_similarity (old_texts [i], new_texts [i]);
+    return result;
+  };
+  std::vector <result_type> standard {};
+  for (size_t i = 0; i < old_texts.size (); i++)
+    standard.push_back (run (i));
+
+  std::atomic <int> failures {0};
+  std::vector <std::thread> threads {};
+  for (int t = 0; t < 16; t++) {
+    threads.emplace_back ([&, t] {
+      for (int round = 0; round < 5; round++) {
+        for (size_t i = static_cast<size_t>(t) % old_texts.size (); i < old_texts.size (); i++) {
+          if (!(run (i) == standard [i]))
+            failures++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join ();
+  EXPECT_EQ (0, failures);
+}
+
+
+// The common start and end of the texts do not go through the diff engine, yet give the same result.
+TEST (filter, diff_common_prefix_suffix)
+{
+  std::vector <std::string> removals, additions;
+  EXPECT_EQ ("same text", filter_diff_diff ("same text", "same text", &removals, &additions));
+  EXPECT_TRUE (removals.empty ());
+  EXPECT_TRUE (additions.empty ());
+  EXPECT_EQ (R"(a <span style="font-weight: bold;"> b </span> c)", filter_diff_diff ("a c", "a b c"));
+  EXPECT_EQ (R"(a <span style="text-decoration: line-through;"> b </span> c)", filter_diff_diff ("a b c", "a c"));
+  EXPECT_EQ (R"(<span style="font-weight: bold;"> new </span>)", filter_diff_diff ("", "new"));
+  EXPECT_EQ (100, filter_diff_word_similarity ("one two three", "one two three"));
+  EXPECT_EQ (33, filter_diff_word_similarity ("one two", "one three"));
+  EXPECT_EQ (100, filter_diff_character_similarity ("abc", "abc"));
+}
+
+
 #endif
 
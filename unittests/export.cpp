@@ -31,6 +31,17 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <html/text.h>
 #include <odf/text.h>
 #include <filter/url.h>
+#include <filter/usfm.h>
+#include <database/bibles.h>
+#include <database/state.h>
+#include <export/combined.h>
+#include <export/esword.h>
+#include <export/html.h>
+#include <export/logic.h>
+#include <export/odt.h>
+#include <export/onlinebible.h>
+#include <export/textusfm.h>
+#include <styles/logic.h>
 
 
 TEST (filter, export) 
@@ -207,5 +218,53 @@ TEST (filter, export)
 }
 
 
-#endif
+// The combined export converts the USFM once for several formats.
+// It should produce the same output as the separate exports.
+TEST (filter, export_combined)
+{
+  refresh_sandbox (false);
+  Database_State::create ();
+  const std::string bible {"combined"};
+  database::bibles::create_bible (bible);
+  const std::string usfm = filter_url_file_get_contents (filter_url_create_root_path ({"unittests", "tests", "08-Ruth.usfm"}));
+  for (const auto& data : filter::usfm::usfm_import (usfm, stylesv2::standard_sheet ())) {
+    database::bibles::store_chapter (bible, data.m_book, data.m_chapter, data.m_data);
+  }
+  constexpr int ruth {8};
+
+  const std::string directory = export_logic::bible_directory (bible);
+  const std::string basename = export_logic::base_book_filename (bible, ruth);
+  const std::vector <std::string> paths {
+    filter_url_create_path ({directory, "html", basename + ".html"}),
+    filter_url_create_path ({directory, "text", basename + ".txt"}),
+    filter_url_create_path ({export_logic::usfm_directory (bible, 1), basename + ".usfm"}),
+    filter_url_create_path ({directory, "onlinebible", "bible.exp"}),
+  };
+  const auto get_exports = [&paths] () {
+    std::vector <std::string> exports {};
+    for (const auto& path : paths)
+      exports.push_back (filter_url_file_get_contents (path));
+    return exports;
+  };
 
+  // Separate exports.
+  export_html_book (bible, ruth, false);
+  export_text_usfm_book (bible, ruth, false);
+  export_odt_book (bible, ruth, false);
+  export_onlinebible (bible, false);
+  const std::vector <std::string> separate = get_exports ();
+  const std::string odt_text_only = filter_url_create_path ({directory, "opendocument", basename + "_text_only.odt"});
+  EXPECT_TRUE (file_or_dir_exists (odt_text_only));
+  for (const auto& contents : separate)
+    EXPECT_FALSE (contents.empty ());
+
+  // Combined exports.
+  filter_url_rmdir (directory);
+  export_combined (bible, ruth, {export_logic::export_html, export_logic::export_text_and_basic_usfm, export_logic::export_opendocument}, false);
+  export_combined (bible, 0, {export_logic::export_online_bible}, false);
+  EXPECT_EQ (separate, get_exports ());
+  EXPECT_TRUE (file_or_dir_exists (odt_text_only));
+}
+
+
+#endif
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <webserver/http.h>
 #include <webserver/request.h>
 #include <filter/url.h>
+#include <config/globals.h>
 
 
 TEST (http, parse_host)
@@ -290,6 +291,19 @@ TEST (http, parse_header)
     EXPECT_EQ(request.query.at("key"), "value");
     EXPECT_EQ(request.query.size(), 1);
   }
+  // Test empty fragments and fragments with more equal signs.
+  {
+    Webserver_Request request{};
+    const bool parsed = http_parse_header ("GET page?a=1&b&c=x=y&d=v=&=e&&f=%41+B HTTP/1.1", request);
+    EXPECT_TRUE(parsed);
+    const std::map<std::string, std::string, std::less<>> standard {
+      {"a", "1"}, {"b", ""}, {"d", "v"}, {"", "e"}, {"f", "A B"}
+    };
+    EXPECT_EQ(request.query, standard);
+    EXPECT_EQ(request.query_get("f"), "A B");
+    EXPECT_EQ(request.query_get("c"), "");
+    EXPECT_FALSE(request.query.contains("c"));
+  }
   // Test a few more header lines.
   {
     Webserver_Request request{};
@@ -357,6 +371,107 @@ TEST (http, parse_header)
 }
 
 
+TEST (http, post_reader)
+{
+  using container = std::vector<std::pair<std::string,std::string>>;
+  refresh_sandbox (false);
+
+  const std::string boundary {"----WebKitFormBoundary1234abcd"};
+  const std::string content_type = std::string(multipart_form_data) + "; boundary=" + boundary;
+  const container standard {
+    {"filename", "00_test1.txt"},
+    {"data", "Contents for test1.\nLine one 1.\nLine two 1.\nLine three 1."},
+    {"filename", "00_test2.txt"},
+    {"data", "Contents for test2.\nLine one 2.\nLine two 2.\nLine three 2."},
+    {"filename", "00_test3.txt"},
+    {"data", "Contents for test3.\nLine one 3.\nLine two 3.\nLine three 3."},
+    {"upload", "Upload"}
+  };
+
+  // Feeding the data in chunks of any size gives the same result as feeding it at once.
+  {
+    const std::string content = filter_url_file_get_contents("unittests/tests/http-post-2.txt");
+    for (const size_t chunk_size : {1, 2, 3, 7, 40, 64, 1000}) {
+      Webserver_Request webserver_request{};
+      webserver_request.content_type = content_type;
+      Http_Post_Reader reader (webserver_request);
+      for (size_t i {0}; i < content.size(); i += chunk_size)
+        reader.feed (content.data() + i, std::min (chunk_size, content.size() - i));
+      reader.finish ();
+      EXPECT_EQ (standard, webserver_request.post) << "chunk size " << chunk_size;
+      EXPECT_TRUE (webserver_request.post_files.empty());
+    }
+  }
+
+  // An incomplete part at the end is discarded.
+  {
+    const std::string content = filter_url_file_get_contents("unittests/tests/http-post-1.txt");
+    Webserver_Request webserver_request{};
+    webserver_request.content_type = content_type;
+    http_parse_post (content.substr (0, content.size() / 2), webserver_request);
+    EXPECT_TRUE (webserver_request.post.empty());
+  }
+
+  // A large binary value with carriage returns and line feeds goes to a temporary file.
+  {
+    const size_t threshold = config_globals_post_spill_threshold;
+    config_globals_post_spill_threshold = 50'000;
+    std::string payload {};
+    for (int i {0}; i < 200'000; i++)
+      payload.push_back (static_cast<char>(i % 256));
+    payload.append ("\r\n--" + boundary.substr(0, 10) + "\r\n");
+    std::string content {};
+    content.append ("--" + boundary + "\r\n");
+    content.append (R"(Content-Disposition: form-data; name="data"; filename="binary.bin")" "\r\n");
+    content.append ("Content-Type: application/octet-stream\r\n\r\n");
+    content.append (payload + "\r\n");
+    content.append ("--" + boundary + "\r\n");
+    content.append (R"(Content-Disposition: form-data; name="upload")" "\r\n\r\nUpload\r\n");
+    content.append ("--" + boundary + "--\r\n");
+    
+    std::string path {};
+    {
+      Webserver_Request webserver_request{};
+      webserver_request.content_type = content_type;
+      Http_Post_Reader reader (webserver_request);
+      for (size_t i {0}; i < content.size(); i += 999)
+        reader.feed (content.data() + i, std::min (static_cast<size_t>(999), content.size() - i));
+      reader.finish ();
+      const container expected {
+        {"filename", "binary.bin"},
+        {"data", ""},
+        {"upload", "Upload"}
+      };
+      EXPECT_EQ (expected, webserver_request.post);
+      ASSERT_EQ (1, webserver_request.post_files.count (1));
+      path = webserver_request.post_files.at (1);
+      EXPECT_EQ (payload, filter_url_file_get_contents (path));
+      EXPECT_EQ (payload, webserver_request.post_get ("data"));
+      const std::string saved = filter_url_tempfile ();
+      EXPECT_TRUE (webserver_request.post_save ("data", saved));
+      EXPECT_FALSE (file_or_dir_exists (path));
+      EXPECT_EQ (payload, filter_url_file_get_contents (saved));
+      EXPECT_TRUE (webserver_request.post_files.empty());
+    }
+    
+    // The temporary file is removed along with the request.
+    {
+      Webserver_Request webserver_request{};
+      webserver_request.content_type = content_type;
+      http_parse_post (content, webserver_request);
+      ASSERT_EQ (1, webserver_request.post_files.count (1));
+      path = webserver_request.post_files.at (1);
+      EXPECT_TRUE (file_or_dir_exists (path));
+    }
+    EXPECT_FALSE (file_or_dir_exists (path));
+
+    config_globals_post_spill_threshold = threshold;
+  }
+
+  refresh_sandbox (false);
+}
+
+
 TEST (http, dev)
 {
 }
@@ -243,4 +243,58 @@ TEST (ipc, focus)
 }
 
 
+TEST (ipc, wait)
+{
+  refresh_sandbox (false);
+  Webserver_Request webserver_request;
+  webserver_request.session_logic ()->set_username ("gtest");
+  using namespace std::chrono_literals;
+
+  // Without a message, waiting for one times out.
+  {
+    const auto start = std::chrono::steady_clock::now ();
+    const database_ipc::Message message = database_ipc::wait_message (0, "gtest", "opennote", 200ms);
+    EXPECT_EQ (0, message.id);
+    EXPECT_GE (std::chrono::steady_clock::now () - start, 200ms);
+  }
+
+  // A message stored while waiting ends the wait straightaway.
+  {
+    std::thread opener ([&webserver_request] {
+      std::this_thread::sleep_for (100ms);
+      ipc_notes::open (webserver_request, 123);
+    });
+    const auto start = std::chrono::steady_clock::now ();
+    EXPECT_EQ (123, ipc_notes::wait (webserver_request, 10s));
+    EXPECT_LT (std::chrono::steady_clock::now () - start, 5s);
+    opener.join ();
+    ipc_notes::erase (webserver_request);
+    EXPECT_EQ (0, ipc_notes::get (webserver_request));
+  }
+
+  // A message for another user does not end the wait.
+  {
+    database_ipc::store_message ("other", "", "opennote", "456");
+    EXPECT_EQ (0, ipc_notes::wait (webserver_request, 100ms));
+  }
+
+  // A change of the focused passage ends the wait for it.
+  {
+    const int change = ipc_focus::get_change (webserver_request);
+    std::thread navigator ([&webserver_request] {
+      std::this_thread::sleep_for (100ms);
+      Webserver_Request request;
+      request.session_logic ()->set_username ("gtest");
+      ipc_focus::set_passage (request, 2, 3, 4);
+    });
+    const auto start = std::chrono::steady_clock::now ();
+    ipc_focus::wait_change (webserver_request, change, 10s);
+    EXPECT_LT (std::chrono::steady_clock::now () - start, 5s);
+    navigator.join ();
+    EXPECT_EQ (2, ipc_focus::get_book (webserver_request));
+    EXPECT_GT (ipc_focus::get_change (webserver_request), change);
+  }
+}
+
+
 #endif
@@ -61,8 +61,7 @@ TEST (database, logs_2)
   if (std::vector <std::string> result = database::logs::get (s);
       result.size () == 1) {
     s = result.at(0);
-    const std::string path = filter_url_create_path ({database::logs::folder (), s});
-    const std::string contents = filter_url_file_get_contents (path);
+    const std::string contents = database::logs::get_entry (s);
     EXPECT_EQ (50'006, contents.find ("This entry was too large and has been truncated: 60000 bytes"));
   } else {
     EXPECT_EQ (1, static_cast<int>(result.size ()));
@@ -89,5 +88,86 @@ TEST (database, logs_3)
 }
 
 
+TEST (database, logs_segments)
+{
+  refresh_sandbox (false);
+
+  // Entries stored one per file by older versions get imported into a segment.
+  const std::string legacy_key = std::to_string (filter::date::get_seconds_since_epoch () - 10) + "00000001";
+  filter_url_file_put_contents (filter_url_create_path ({database::logs::folder (), legacy_key}), "5 legacy entry");
+  database::logs::log ("new entry");
+  std::string last {};
+  std::vector <std::string> keys = database::logs::get (last);
+  EXPECT_EQ (2, static_cast<int>(keys.size ()));
+  EXPECT_EQ (legacy_key, keys.front());
+  EXPECT_EQ ("5 legacy entry", database::logs::get_entry (legacy_key));
+  EXPECT_EQ ("5 new entry", database::logs::get_entry (last));
+  EXPECT_FALSE (file_or_dir_exists (filter_url_create_path ({database::logs::folder (), legacy_key})));
+
+  // Keys are unique and ascending, also when logged in quick succession.
+  for (int i = 0; i < 100; i++)
+    database::logs::log ("entry " + std::to_string (i));
+  keys = database::logs::get (last);
+  EXPECT_EQ (102, static_cast<int>(keys.size ()));
+  EXPECT_TRUE (std::is_sorted (keys.cbegin (), keys.cend ()));
+  EXPECT_EQ (keys.cend (), std::adjacent_find (keys.cbegin (), keys.cend ()));
+
+  // Walk the journal with the next function.
+  std::string filename = "0";
+  int count = 0;
+  while (!database::logs::next (filename).empty ())
+    count++;
+  EXPECT_EQ (102, count);
+  EXPECT_EQ (last, filename);
+
+  // Rotation keeps the recent entries, now in one segment.
+  database::logs::rotate ();
+  keys = database::logs::get (last);
+  EXPECT_EQ (102, static_cast<int>(keys.size ()));
+  EXPECT_EQ ("5 entry 99", database::logs::get_entry (last));
+  const std::vector <std::string> files = filter_url_scandir (database::logs::folder ());
+  EXPECT_EQ (1, std::count_if (files.cbegin (), files.cend (), [] (const std::string& file) {
+    return filter_url_get_extension (file) == "log";
+  }));
+
+  // Removing the segments from outside is noticed.
+  for (const auto& file : filter_url_scandir (database::logs::folder ()))
+    filter_url_unlink (filter_url_create_path ({database::logs::folder (), file}));
+  keys = database::logs::get (last);
+  EXPECT_TRUE (keys.empty ());
+  database::logs::log ("after removal");
+  keys = database::logs::get (last);
+  EXPECT_EQ (1, static_cast<int>(keys.size ()));
+
+  // A segment started by another process, after the current segment got full, is picked up.
+  // A temporary segment left behind by an interrupted rotation gets removed.
+  {
+    const std::string directory = database::logs::folder ();
+    const std::string segment = filter_url_scandir (directory).back ();
+    const std::string full_key = std::to_string (std::stoll (last) + 1);
+    const std::string text (1'000'000, 'x');
+    filter_url_file_put_contents_append (filter_url_create_path ({directory, segment}), full_key + " " + std::to_string (text.size ()) + "\n" + text + "\n");
+    const std::string new_key = std::to_string (std::stoll (last) + 2);
+    const std::string new_segment = filter_url_create_path ({directory, new_key + ".log"});
+    filter_url_file_put_contents (new_segment, new_key + " 7\n5 other\n");
+    const std::string temporary = filter_url_create_path ({directory, "1.log.tmp"});
+    filter_url_file_put_contents (temporary, std::string());
+    keys = database::logs::get (last);
+    EXPECT_EQ (3, static_cast<int>(keys.size ()));
+    EXPECT_EQ (new_key, last);
+    EXPECT_EQ ("5 other", database::logs::get_entry (new_key));
+    EXPECT_EQ (text, database::logs::get_entry (full_key));
+    EXPECT_FALSE (file_or_dir_exists (temporary));
+    database::logs::log ("appended");
+    keys = database::logs::get (last);
+    EXPECT_EQ (4, static_cast<int>(keys.size ()));
+    EXPECT_EQ ("5 appended", database::logs::get_entry (last));
+    EXPECT_NE (filter_url_file_get_contents (new_segment).find ("5 appended"), std::string::npos);
+  }
+
+  refresh_sandbox (false);
+}
+
+
 #endif
 
@@ -95,5 +95,57 @@ TEST (database, login)
 }
 
 
+TEST (database, login_cache)
+{
+  refresh_sandbox (false);
+  database::login::create ();
+  
+  const std::string username = "unittest";
+  const std::string cookie = "abcdefghijklmnopqrstuvwxyz";
+  bool daily {true};
+
+  // A fresh login is not due for its daily touch.
+  database::login::set_tokens (username, "", "", "", cookie, true);
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_FALSE (daily);
+  EXPECT_TRUE (database::login::get_touch_enabled (cookie));
+
+  // A login last used long ago gets touched once, and the touch is written behind.
+  database::login::test_timestamp ();
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_TRUE (daily);
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_FALSE (daily);
+  database::login::clear_cache ();
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_TRUE (daily);
+  database::login::write_timestamps ();
+  database::login::clear_cache ();
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_FALSE (daily);
+  // The trim flushes a pending touch before it removes old logins.
+  database::login::test_timestamp ();
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_TRUE (daily);
+  database::login::trim ();
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_FALSE (daily);
+
+  // Removing or renaming tokens updates the cached logins.
+  database::login::remove_tokens (username);
+  EXPECT_EQ ("", database::login::get_username (cookie, daily));
+  EXPECT_FALSE (database::login::get_touch_enabled (cookie));
+  database::login::set_tokens (username, "", "", "", cookie, false);
+  EXPECT_EQ (username, database::login::get_username (cookie, daily));
+  EXPECT_FALSE (database::login::get_touch_enabled (cookie));
+  database::login::rename_tokens (username, "unittest2", cookie);
+  EXPECT_EQ ("unittest2", database::login::get_username (cookie, daily));
+  database::login::remove_tokens ("unittest2", cookie);
+  EXPECT_EQ ("", database::login::get_username (cookie, daily));
+  
+  refresh_sandbox (false);
+}
+
+
 #endif
 
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #pragma GCC diagnostic pop
 #include <unittests/utilities.h>
 #include <webserver/request.h>
+#include <email/send.h>
 
 
 TEST(database, mail)
@@ -262,4 +263,73 @@ TEST(filter, mail)
 }
 
 
+#ifdef HAVE_CLOUD
+
+
+TEST (email, smtp_session)
+{
+  refresh_sandbox (false);
+  smtp_stand_in server {};
+  email::smtp_settings settings {
+    .url = "smtp://127.0.0.1:" + std::to_string (server.port ()),
+    .username = std::string(),
+    .password = std::string(),
+    .from_mail = "bibledit@site.org",
+    .from_name = "Bibledit",
+    .use_tls = false
+  };
+
+  // A batch of emails goes over one connection.
+  {
+    email::smtp_session session (settings);
+    for (int i {0}; i < 5; i++) {
+      const std::string result = session.send ("user" + std::to_string (i) + "@site.org", "User", "Subject " + std::to_string (i), "Body");
+      EXPECT_EQ (std::string(), result);
+    }
+  }
+  EXPECT_EQ (1, server.connections);
+  std::vector <std::string> messages = server.messages ();
+  ASSERT_EQ (5, messages.size ());
+  for (size_t i {0}; i < messages.size (); i++) {
+    const std::string& message = messages.at (i);
+    EXPECT_NE (message.find ("Subject: Subject " + std::to_string (i) + "\n"), std::string::npos);
+    EXPECT_NE (message.find (R"(To: "User" <user)" + std::to_string (i) + "@site.org>"), std::string::npos);
+    EXPECT_NE (message.find (R"(From: "Bibledit" <bibledit@site.org>)"), std::string::npos);
+    EXPECT_NE (message.find ("<body>\nBody\n</body></html>"), std::string::npos);
+  }
+
+  // Each session makes its own connection, and an empty subject gets a default.
+  {
+    email::smtp_session session (settings);
+    EXPECT_EQ (std::string(), session.send ("user@site.org", "User", std::string(), "Body"));
+  }
+  EXPECT_EQ (2, server.connections);
+  messages = server.messages ();
+  ASSERT_EQ (6, messages.size ());
+  EXPECT_NE (messages.back ().find ("Subject: Bibledit\n"), std::string::npos);
+
+  // A server that hangs up after it received the email may have accepted it.
+  // So the email is not sent again.
+  {
+    server.hang_up_after_data = true;
+    email::smtp_session session (settings, 2);
+    EXPECT_FALSE (session.send ("user@site.org", "User", "Subject", "Body").empty ());
+    server.hang_up_after_data = false;
+  }
+  EXPECT_EQ (7, server.messages ().size ());
+
+  // A server that cannot be reached gives an error, also after trying again.
+  {
+    settings.url = "smtp://127.0.0.1:1";
+    email::smtp_session session (settings, 1);
+    EXPECT_FALSE (session.send ("user@site.org", "User", "Subject", "Body").empty ());
+    EXPECT_TRUE (session.unreachable ());
+  }
+  refresh_sandbox (false);
+}
+
+
+#endif
+
+
 #endif
@@ -26,11 +26,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #pragma GCC diagnostic pop
 #include <bb/logic.h>
 #include <changes/logic.h>
+#include <changes/modifications.h>
 #include <database/bibles.h>
 #include <database/modifications.h>
 #include <database/state.h>
+#include <database/users.h>
 #include <filter/date.h>
+#include <filter/roles.h>
 #include <unittests/utilities.h>
+#include <webserver/request.h>
 
 
 constexpr auto unittest0 = "unittest0";
@@ -638,4 +642,42 @@ TEST (database, modifications_notifications)
 }
 
 
+TEST (changes, modifications)
+{
+  refresh_sandbox (false);
+  Database_Users database_users;
+  database_users.create ();
+  database::modifications::create ();
+  Webserver_Request webserver_request;
+  for (const auto user : {unittest1, unittest2, unittest3}) {
+    database_users.add_user (user, user, roles::translator, std::string());
+    webserver_request.session_logic ()->set_username (user);
+    webserver_request.database_config_user ()->set_user_changes_notifications_online (true);
+  }
+  webserver_request.database_config_user ()->set_contributor_changes_notifications_online (true);
+  webserver_request.database_config_user ()->set_change_notifications_bibles ({"bible"});
+
+  // Two users make the same change in a verse, and a third user gets notified of those changes.
+  const std::string old_usfm {"\\c 1\n\\p\n\\v 1 Old text.\n\\v 2 Same text.\n"};
+  const std::string new_usfm {"\\c 1\n\\p\n\\v 1 New text.\n\\v 2 Same text.\n"};
+  database::modifications::recordUserSave (unittest1, "bible", 1, 1, 1, old_usfm, 2, new_usfm);
+  database::modifications::recordUserSave (unittest2, "bible", 1, 1, 3, old_usfm, 4, new_usfm);
+  changes_modifications ();
+
+  const auto modifications = [] (const std::string& user) {
+    std::vector <std::string> result {};
+    for (const int id : database::modifications::getNotificationIdentifiers (user, "bible")) {
+      result.push_back (database::modifications::getNotificationCategory (id) + " " + database::modifications::getNotificationPassage (id).verse ());
+      EXPECT_EQ (database::modifications::getNotificationModification (id),
+                 R"(1 <span style="text-decoration: line-through;"> Old </span> <span style="font-weight: bold;"> New </span> text.)");
+    }
+    return result;
+  };
+  EXPECT_EQ (std::vector <std::string>{std::string (changes_personal_category ()) + " 1"}, modifications (unittest1));
+  EXPECT_EQ (std::vector <std::string>{std::string (changes_personal_category ()) + " 1"}, modifications (unittest2));
+  EXPECT_EQ ((std::vector <std::string>{"unittest1 1", "unittest2 1"}), modifications (unittest3));
+  EXPECT_EQ (std::vector <std::string>{}, database::modifications::getUserUsernames ());
+}
+
+
 #endif
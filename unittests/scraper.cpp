@@ -753,4 +753,44 @@ TEST (scraper, bible_server)
 }
 
 
+
+// Concurrent requests for one web page share a single fetch,
+// and the page is then served from memory.
+TEST (scraper, web_cache)
+{
+  refresh_sandbox (false);
+  http_stand_in server (std::chrono::milliseconds (200));
+  const std::string url = server.url () + "/chapter";
+  std::vector <std::thread> threads {};
+  std::atomic <int> successes {0};
+  for (int i {0}; i < 6; i++) {
+    threads.emplace_back ([&url, &successes] () {
+      std::string error {};
+      if (resource_logic_web_or_cache_get (url, error) == "GET /chapter HTTP/1.1" && error.empty ())
+        successes++;
+    });
+  }
+  for (auto& thread : threads)
+    thread.join ();
+  EXPECT_EQ (6, successes);
+  EXPECT_EQ (1, server.requests);
+
+  for (int verse {0}; verse < 10; verse++) {
+    std::string error {};
+    EXPECT_EQ ("GET /chapter HTTP/1.1", resource_logic_web_or_cache_get (url, error));
+  }
+  EXPECT_EQ (1, server.requests);
+
+  // Without the page in memory, it comes from the file cache, or else from the network again.
+  resource_logic_web_cache_clear ();
+  std::string error {};
+  EXPECT_EQ ("GET /chapter HTTP/1.1", resource_logic_web_or_cache_get (url, error));
+#ifdef HAVE_CLOUD
+  EXPECT_EQ (1, server.requests);
+#else
+  EXPECT_EQ (2, server.requests);
+#endif
+}
+
+
 #endif
@@ -28,6 +28,44 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <database/state.h>
 #include <database/bibles.h>
 #include <search/logic.h>
+#include <search/rebibles.h>
+#include <database/config/general.h>
+#include <database/jobs.h>
+#include <database/logic.h>
+#include <database/config/bible.h>
+#include <demo/logic.h>
+#include <filter/text.h>
+#include <filter/url.h>
+#include <filter/usfm.h>
+
+
+// The number of allocations made through operator new, for the benchmark.
+// Counting them replaces operator new for the whole unit test executable,
+// so this is only done when building with -DCOUNT_ALLOCATIONS=ON.
+static std::atomic<size_t> allocation_count {0};
+
+
+#ifdef COUNT_ALLOCATIONS
+void* operator new (size_t size)
+{
+  allocation_count.fetch_add (1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc (size ? size : 1))
+    return pointer;
+  throw std::bad_alloc ();
+}
+
+
+void operator delete (void* pointer) noexcept
+{
+  std::free (pointer);
+}
+
+
+void operator delete (void* pointer, size_t) noexcept
+{
+  std::free (pointer);
+}
+#endif
 
 
 void test_search_setup ()
@@ -200,5 +238,143 @@ TEST (search, logic)
   }
 }
 
+// Reindexing the Bibles, resuming a forced reindex that was interrupted.
+TEST (search, reindex_bibles)
+{
+  refresh_sandbox (false);
+  test_search_setup ();
+  database_jobs::create ();
+  for (int chapter {1}; chapter <= 20; chapter++)
+    database::bibles::store_chapter ("phpunit", 1, chapter, "\\c " + std::to_string (chapter) + "\n\\p\n\\v 1 Verse.");
+  const auto index_files = [] () {
+    std::vector <std::string> files {};
+    for (const auto& bible : database::bibles::get_bibles ())
+      for (const int book : database::bibles::get_books (bible))
+        for (const int chapter : database::bibles::get_chapters (bible, book))
+          files.push_back (search_logic_chapter_file (bible, book, chapter));
+    return files;
+  };
+  const std::vector <std::string> files = index_files ();
+  EXPECT_EQ (23, files.size ());
+
+  // A forced reindex, with its progress in a job.
+  const int job_id = database_jobs::get_new_id ();
+  for (const auto& file : files)
+    filter_url_unlink (file);
+  database::config::general::set_index_bibles (true);
+  search_reindex_bibles (true, job_id);
+  for (const auto& file : files)
+    EXPECT_TRUE (file_or_dir_exists (file));
+  EXPECT_EQ ("100", database_jobs::get_percentage (job_id));
+  EXPECT_FALSE (database_jobs::get_result (job_id).empty ());
+  EXPECT_FALSE (database::config::general::get_index_bibles ());
+
+  // A forced reindex that was interrupted resumes with the chapters not yet done.
+  const std::string checkpoint = filter_url_create_root_path ({database_logic_databases (), "search_reindex_bibles.txt"});
+  std::string done {};
+  for (size_t i {0}; i < 10; i++)
+    done.append (files.at (i) + "\n");
+  filter_url_file_put_contents (checkpoint, done);
+  for (const auto& file : files)
+    filter_url_unlink (file);
+  database::config::general::set_index_bibles (true);
+  search_reindex_bibles (false);
+  for (size_t i {0}; i < files.size (); i++)
+    EXPECT_EQ (i >= 10, file_or_dir_exists (files.at (i)));
+  EXPECT_FALSE (file_or_dir_exists (checkpoint));
+
+  // A normal reindex indexes the chapters without an index.
+  database::config::general::set_index_bibles (true);
+  search_reindex_bibles (false);
+  for (const auto& file : files)
+    EXPECT_TRUE (file_or_dir_exists (file));
+
+  // When indexing is off, the job still gets a result, so its page stops waiting.
+  {
+    const int idle_job_id = database_jobs::get_new_id ();
+    search_reindex_bibles (true, idle_job_id);
+    EXPECT_FALSE (database_jobs::get_result (idle_job_id).empty ());
+  }
+
+  refresh_sandbox (false);
+}
+
+
+TEST (DISABLED_search, index_benchmark)
+{
+  // Index the whole sample Bible, and report the time it takes and the allocations it makes.
+  refresh_sandbox (false);
+  Database_State::create ();
+  // Create the sample Bible from the USFM files it is made of.
+  const std::string bible = demo_sample_bible_name ();
+  database::bibles::create_bible (bible);
+  const std::string directory = filter_url_create_root_path ({"demo"});
+  for (const auto& file : filter_url_scandir (directory)) {
+    if (filter_url_get_extension (file) != "usfm")
+      continue;
+    const std::string usfm = filter_url_file_get_contents (filter_url_create_path ({directory, file}));
+    for (const auto& data : filter::usfm::usfm_import (usfm, stylesv2::standard_sheet ())) {
+      if (data.m_book)
+        database::bibles::store_chapter (bible, data.m_book, data.m_chapter, data.m_data);
+    }
+  }
+  const std::string stylesheet = database::config::bible::get_export_stylesheet (bible);
+
+  const auto measure = [] (const std::string& label, const std::function<void()>& function) {
+    [[maybe_unused]] const size_t allocations = allocation_count.load ();
+    const auto start = std::chrono::steady_clock::now ();
+    function ();
+    const auto end = std::chrono::steady_clock::now ();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << std::fixed << std::setprecision(2) << seconds << " seconds ";
+#ifdef COUNT_ALLOCATIONS
+    std::cout << allocation_count.load () - allocations << " allocations ";
+#endif
+    std::cout << label << std::endl;
+  };
+
+  measure ("indexing the sample Bible", [&bible] {
+    for (const int book : database::bibles::get_books (bible)) {
+      for (const int chapter : database::bibles::get_chapters (bible, book)) {
+        search_logic_index_chapter (bible, book, chapter);
+      }
+    }
+  });
+
+  // Compare converting verse by verse with a new object per verse and with one object that gets reset.
+  std::vector <std::string> verses {};
+  for (const int book : database::bibles::get_books (bible)) {
+    for (const int chapter : database::bibles::get_chapters (bible, book)) {
+      const std::string usfm = database::bibles::get_chapter (bible, book, chapter);
+      const filter::usfm::ChapterVerses chapter_verses (usfm);
+      for (const int verse : filter::usfm::get_verse_numbers (usfm))
+        verses.push_back (chapter_verses.get_verse_text (verse));
+    }
+  }
+  measure ("converting verses with a new object per verse", [&] {
+    for (const auto& usfm : verses) {
+      Filter_Text filter_text = Filter_Text (bible);
+      filter_text.text_text = new Text_Text ();
+      filter_text.initializeHeadingsAndTextPerVerse (true);
+      filter_text.add_usfm_code (usfm);
+      filter_text.run (stylesheet);
+    }
+  });
+  measure ("converting verses with one object that gets reset", [&] {
+    Filter_Text filter_text = Filter_Text (bible);
+    for (const auto& usfm : verses) {
+      filter_text.reset ();
+      if (!filter_text.text_text)
+        filter_text.text_text = new Text_Text ();
+      filter_text.initializeHeadingsAndTextPerVerse (true);
+      filter_text.add_usfm_code (usfm);
+      filter_text.run (stylesheet);
+    }
+  });
+
+  refresh_sandbox (false);
+}
+
+
 #endif
 
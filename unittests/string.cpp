@@ -398,6 +398,28 @@ TEST(filter, string)
         EXPECT_EQ("אָבּגּדּהּ", filter::string::unicode_string_uppercase ("אָבּגּדּהּ"));
     }
 
+    {
+        // Positions count Unicode points also when the search starts at an offset.
+        EXPECT_EQ(4, static_cast<int>(filter::string::unicode_string_strpos ("αβγδαβγδ", "αβ", 1)));
+        EXPECT_EQ(6, static_cast<int>(filter::string::unicode_string_strpos ("αβγδαβγδ", "γδ", 3)));
+        EXPECT_EQ(-1, static_cast<int>(filter::string::unicode_string_strpos ("αβγδ", "α", 5)));
+        EXPECT_EQ(4, static_cast<int>(filter::string::unicode_string_strpos ("αβγδ", "")));
+        EXPECT_EQ(5, static_cast<int>(filter::string::unicode_string_strpos_case_insensitive ("ΘΕΟΣ Θεος", "θεο", 1)));
+        // Mixed ASCII and other text, and bytes that are no valid UTF-8.
+        EXPECT_EQ("abc θεοσ xyz", filter::string::unicode_string_casefold ("ABC ΘΕΟΣ XYZ"));
+        EXPECT_EQ("a\xff" "b", filter::string::unicode_string_casefold ("A\xff" "B"));
+        // Large texts get folded too.
+        std::string large {};
+        for (int i = 0; i < 10'000; i++) large.append ("Θεος ABC ");
+        const std::string folded = filter::string::unicode_string_casefold (large);
+        EXPECT_EQ(large.size (), folded.size ());
+        EXPECT_EQ("θεος abc θεος", folded.substr (0, 21));
+        EXPECT_EQ(89'991, static_cast<int>(filter::string::unicode_string_strpos_case_insensitive (large, "θεος abc", 89'990)));
+        // Replacing runs over the whole subject.
+        EXPECT_EQ("γ-γ-γ", filter::string::unicode_string_str_replace ("αβ", "γ", "αβ-αβ-αβ"));
+        EXPECT_EQ("αβαβ", filter::string::unicode_string_str_replace ("α", "αβ", "αα"));
+    }
+
     {
         EXPECT_EQ("ABCDEFG", filter::string::unicode_string_transliterate ("ABCDEFG"));
         EXPECT_EQ("Ιησου Χριστου", filter::string::unicode_string_transliterate ("Ἰησοῦ Χριστοῦ"));
@@ -361,7 +361,7 @@ TEST_F (styles, detail_check_markers)
 {
   constexpr const char* test_sheet {"testsheet"};
   database::styles::create_sheet (test_sheet);
-  auto* style = database::styles::get_marker_data (test_sheet, "add");
+  const auto style = database::styles::get_marker_data (test_sheet, "add");
   EXPECT_EQ ("add", style->marker);
   EXPECT_EQ (stylesv2::Category::words_characters, style->category);
 }
@@ -663,7 +663,8 @@ TEST_F (styles, get_styles)
   using namespace database::styles;
 
   // Default stylesheet should have the hard-coded default styles.
-  const std::list<stylesv2::Style>& default_styles = get_styles(stylesv2::standard_sheet ());
+  const auto default_styles_snapshot = get_styles(stylesv2::standard_sheet ());
+  const std::list<stylesv2::Style>& default_styles = *default_styles_snapshot;
   EXPECT_EQ (default_styles.size(), stylesv2::styles.size());
   
   // Do a spot-check on markers.
@@ -1110,7 +1111,8 @@ TEST_F (styles, get_styles_etc)
   
   // The standard stylesheet has the default number of styles.
   {
-    const std::list<stylesv2::Style>& styles = get_styles(stylesv2::standard_sheet());
+    const auto styles_snapshot = get_styles(stylesv2::standard_sheet());
+    const std::list<stylesv2::Style>& styles = *styles_snapshot;
     EXPECT_EQ (styles.size(), stylesv2::styles.size());
     const std::map <std::string, std::string> markers_names = get_markers_and_names (stylesv2::standard_sheet());
     EXPECT_EQ (markers_names.size(), stylesv2::styles.size());
@@ -1118,7 +1120,8 @@ TEST_F (styles, get_styles_etc)
 
   // A non-default stylesheet should be created on the fly if it does not exist, and return default styles.
   {
-    const std::list<stylesv2::Style>& styles = get_styles(sheet);
+    const auto styles_snapshot = get_styles(sheet);
+    const std::list<stylesv2::Style>& styles = *styles_snapshot;
     EXPECT_EQ (styles.size(), stylesv2::styles.size());
     const std::map <std::string, std::string> markers_names = get_markers_and_names (sheet);
     EXPECT_EQ (markers_names.size(), stylesv2::styles.size());
@@ -1130,7 +1133,8 @@ TEST_F (styles, get_styles_etc)
   // Add a style based on another. Check the increased styles count.
   {
     add_marker(sheet, marker, base);
-    const std::list<stylesv2::Style>& styles = get_styles(sheet);
+    const auto styles_snapshot = get_styles(sheet);
+    const std::list<stylesv2::Style>& styles = *styles_snapshot;
     EXPECT_EQ (styles.size(), stylesv2::styles.size() + 1);
     const std::map <std::string, std::string> markers_names = get_markers_and_names (sheet);
     EXPECT_EQ (markers_names.size(), stylesv2::styles.size() + 1);
@@ -1138,7 +1142,7 @@ TEST_F (styles, get_styles_etc)
   
   // Check getting the style data.
   {
-    const stylesv2::Style* style {get_marker_data(sheet, marker)};
+    const auto style {get_marker_data(sheet, marker)};
     EXPECT_EQ(marker, style->marker);
     EXPECT_EQ("Identification", style->name);
     EXPECT_EQ("File identification information (name of file, book name, language, last edited, date, etc.)", style->info);
@@ -1146,7 +1150,7 @@ TEST_F (styles, get_styles_etc)
 
   // Check that getting marker data for a style not in the stylesheet returns a null pointer.
   {
-    const stylesv2::Style* style {get_marker_data(sheet, "unknown")};
+    const auto style {get_marker_data(sheet, "unknown")};
     EXPECT_FALSE(style);
   }
   
@@ -1191,12 +1195,14 @@ TEST_F (styles, get_styles_etc)
   reset_marker(sheet, id_marker);
   add_marker(sheet, marker, "id");
   {
-    const std::list<stylesv2::Style>& styles = get_styles(sheet);
+    const auto styles_snapshot = get_styles(sheet);
+    const std::list<stylesv2::Style>& styles = *styles_snapshot;
     EXPECT_EQ (styles.size(), stylesv2::styles.size() + 1);
   }
   reset_marker(sheet, marker);
   {
-    const std::list<stylesv2::Style>& styles = get_styles(sheet);
+    const auto styles_snapshot = get_styles(sheet);
+    const std::list<stylesv2::Style>& styles = *styles_snapshot;
     EXPECT_EQ (styles.size(), stylesv2::styles.size());
   }
 }
@@ -1314,4 +1320,35 @@ TEST_F (styles, marker_starts_new_line_in_usfm)
 }
 
 
+TEST_F (styles, snapshots)
+{
+  using namespace database::styles;
+
+  constexpr const char* sheet {"sheet"};
+  create_sheet (sheet);
+
+  // A snapshot finds the styles by marker.
+  const std::shared_ptr<const snapshot> before {get_snapshot(sheet)};
+  EXPECT_EQ (before->styles().size(), stylesv2::styles.size());
+  ASSERT_TRUE (before->find("p"));
+  EXPECT_EQ (before->find("p")->marker, "p");
+  EXPECT_EQ (before->find("unknown"), nullptr);
+  EXPECT_EQ (get_snapshot(sheet), before);
+
+  // Saving a style publishes a new snapshot, and the one held before remains as it was.
+  stylesv2::Style style {*before->find("p")};
+  style.name = "Changed";
+  save_style(sheet, style);
+  const std::shared_ptr<const snapshot> after {get_snapshot(sheet)};
+  EXPECT_NE (after, before);
+  EXPECT_GT (after->version(), before->version());
+  EXPECT_EQ (after->find("p")->name, "Changed");
+  EXPECT_NE (before->find("p")->name, "Changed");
+  EXPECT_EQ (get_marker_data(sheet, "p").get(), after->find("p"));
+
+  // The standard sheet has one snapshot that never changes.
+  EXPECT_EQ (get_snapshot(stylesv2::standard_sheet()), get_snapshot(stylesv2::standard_sheet()));
+}
+
+
 #endif
@@ -1801,4 +1801,37 @@ TEST_F(filter_text, double_slash_to_soft_hyphen)
 }
 
 
+TEST_F(filter_text, reset)
+{
+    // Converting verses one after the other with one object that gets reset
+    // should give the same results as converting each verse with a new object.
+    const std::vector<std::string> verses {
+        R"(\s Heading)" "\n" R"(\p)" "\n" R"(\v 1 Verse \add one\add*.)",
+        R"(\v 2 Verse two\f + \fr 1.2 \ft Note\f*.)",
+        R"(\q1)" "\n" R"(\v 3 Verse three.)",
+    };
+    Filter_Text reused(bible);
+    for (const auto& usfm : verses) {
+        Filter_Text fresh(bible);
+        fresh.text_text = new Text_Text();
+        fresh.initializeHeadingsAndTextPerVerse(true);
+        fresh.add_usfm_code(usfm);
+        fresh.run(stylesv2::standard_sheet());
+
+        reused.reset();
+        if (!reused.text_text)
+            reused.text_text = new Text_Text();
+        reused.initializeHeadingsAndTextPerVerse(true);
+        reused.add_usfm_code(usfm);
+        reused.run(stylesv2::standard_sheet());
+
+        EXPECT_EQ(fresh.getVersesText(), reused.getVersesText());
+        EXPECT_EQ(fresh.verses_headings, reused.verses_headings);
+        EXPECT_EQ(fresh.text_text->get(), reused.text_text->get());
+        EXPECT_EQ(fresh.text_text->getnote(), reused.text_text->getnote());
+        EXPECT_EQ(fresh.notes_plain_text, reused.notes_plain_text);
+    }
+}
+
+
 #endif
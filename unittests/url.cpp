@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <filter/date.h>
 #include <chrono>
 #include <filesystem>
+#include <thread>
 
 
 class filter_url : public testing::Test {
@@ -142,6 +143,12 @@ TEST_F (filter_url, decode)
   EXPECT_EQ ("ᨀab\\d@a", filter_url_urldecode ("%E1%A8%80ab%5Cd%40a"));
   EXPECT_EQ ("\xFF", filter_url_urldecode ("%FF"));
   EXPECT_EQ ("\xFF", filter_url_urldecode ("%ff"));
+  // Incomplete or invalid sequences are left as they are.
+  EXPECT_EQ ("%zz%", filter_url_urldecode ("%zz%"));
+  EXPECT_EQ ("a%4", filter_url_urldecode ("a%4"));
+  EXPECT_EQ ("%A%", filter_url_urldecode ("%%41%"));
+  EXPECT_EQ ("%g1 ", filter_url_urldecode ("%g1%20"));
+  EXPECT_EQ (std::string(), filter_url_urldecode (std::string()));
 }
 
 
@@ -213,6 +220,53 @@ TEST_F (filter_url, get_post)
 }
 
 
+#ifdef HAVE_CLOUD
+
+
+TEST_F (filter_url, connection_reuse)
+{
+  http_stand_in server {};
+  std::string error {};
+
+  // Sequential GET and POST requests to the same host go over one connection.
+  for (int i {0}; i < 3; i++) {
+    const std::string path = "/get" + std::to_string (i);
+    EXPECT_EQ ("GET " + path + " HTTP/1.1", filter_url_http_get (server.url () + path, error, false));
+    EXPECT_EQ (std::string(), error);
+  }
+  const std::map <std::string, std::string> values = {std::pair ("a", "value1"), std::pair ("b", "value2")};
+  EXPECT_EQ ("POST /post HTTP/1.1a=value1&b=value2",
+             filter_url_http_post (server.url () + "/post", std::string(), values, error, false, false, {}));
+  EXPECT_EQ (std::string(), error);
+  EXPECT_EQ ("GET /missing HTTP/1.1http code 404", filter_url_http_get (server.url () + "/missing", error, false));
+  EXPECT_EQ (std::string(), error);
+  EXPECT_EQ ("GET /get HTTP/1.1", filter_url_http_get (server.url () + "/get", error, false));
+  EXPECT_EQ (6, server.requests);
+  EXPECT_EQ (1, server.connections);
+
+  // Concurrent requests each get a handle of their own, and they all succeed.
+  std::vector <std::thread> threads {};
+  std::atomic <int> successes {0};
+  for (int t {0}; t < 4; t++) {
+    threads.emplace_back ([&server, &successes, t] () {
+      for (int i {0}; i < 5; i++) {
+        std::string thread_error {};
+        const std::string path = "/thread" + std::to_string (t) + "/" + std::to_string (i);
+        if (filter_url_http_get (server.url () + path, thread_error, false) == "GET " + path + " HTTP/1.1")
+          successes++;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join ();
+  EXPECT_EQ (20, successes);
+  EXPECT_LE (server.connections, 5);
+}
+
+
+#endif
+
+
 TEST_F (filter_url, error_unknown_host)
 {
   // Test low-level http(s) client error for unknown host.
@@ -415,6 +469,47 @@ TEST_F (filter_url, scandir)
 }
 
 
+TEST_F (filter_url, scandir_shared)
+{
+  const std::string directory = filter_url_create_root_path ({filter_url_temp_dir (), "scandir_shared"});
+  filter_url_rmdir (directory);
+  filter_url_mkdir (directory);
+  filter_url_file_put_contents (filter_url_create_path ({directory, "1"}), "1");
+  const filter_url_scandir_statistics before = filter_url_scandir_metrics ();
+
+  // The listing equals the uncached one.
+  const auto files = filter_url_scandir_shared (directory);
+  EXPECT_EQ ((std::vector <std::string>{"1"}), *files);
+  EXPECT_EQ (before.misses + 1, filter_url_scandir_metrics ().misses);
+
+#ifdef __linux__
+  // Listing again gives the same shared listing from the cache.
+  EXPECT_EQ (files, filter_url_scandir_shared (directory));
+  EXPECT_EQ (before.hits + 1, filter_url_scandir_metrics ().hits);
+#endif
+
+  // Adding, renaming and removing files show up right away.
+  filter_url_file_put_contents (filter_url_create_path ({directory, "2"}), "2");
+  EXPECT_EQ ((std::vector <std::string>{"1", "2"}), *filter_url_scandir_shared (directory));
+  filter_url_rename (filter_url_create_path ({directory, "1"}), filter_url_create_path ({directory, "3"}));
+  EXPECT_EQ ((std::vector <std::string>{"2", "3"}), *filter_url_scandir_shared (directory));
+  filter_url_unlink (filter_url_create_path ({directory, "2"}));
+  EXPECT_EQ ((std::vector <std::string>{"3"}), *filter_url_scandir_shared (directory));
+
+  // The listing already given out does not change.
+  EXPECT_EQ ((std::vector <std::string>{"1"}), *files);
+
+  // A folder replaced by another one gets listed afresh.
+  filter_url_rmdir (directory);
+  EXPECT_TRUE (filter_url_scandir_shared (directory)->empty ());
+  filter_url_mkdir (directory);
+  filter_url_file_put_contents (filter_url_create_path ({directory, "4"}), "4");
+  EXPECT_EQ ((std::vector <std::string>{"4"}), *filter_url_scandir_shared (directory));
+
+  filter_url_rmdir (directory);
+}
+
+
 TEST_F (filter_url, file_modification_time)
 {
   // Test the file modification time.
@@ -494,4 +589,67 @@ TEST_F (filter_url, build_http_query)
 }
 
 
+TEST_F (filter_url, durable_writes)
+{
+  const std::string folder {filter_url_create_root_path ({filter_url_temp_dir (), "durable"})};
+  filter_url_rmdir (folder);
+  filter_url_mkdir (folder);
+  const filter_url_durable_statistics before = filter_url_durable_metrics ();
+
+  // Concurrent writers each write their own files.
+  constexpr int thread_count {8};
+  constexpr int file_count {25};
+  std::vector <std::thread> threads {};
+  for (int t {0}; t < thread_count; t++) {
+    threads.emplace_back ([&folder, t] () {
+      for (int f {0}; f < file_count; f++) {
+        const std::string filename = filter_url_create_path ({folder, std::to_string (t) + "_" + std::to_string (f)});
+        EXPECT_TRUE (filter_url_file_put_contents_durable (filename, std::to_string (t * f)));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join ();
+  for (int t {0}; t < thread_count; t++) {
+    for (int f {0}; f < file_count; f++) {
+      const std::string filename = filter_url_create_path ({folder, std::to_string (t) + "_" + std::to_string (f)});
+      EXPECT_EQ (std::to_string (t * f), filter_url_file_get_contents (filename));
+    }
+  }
+
+  // All writes were committed, in at most as many batches, and no temporary files were left behind.
+  // Each batch flushed its files and then the one folder.
+  const filter_url_durable_statistics after = filter_url_durable_metrics ();
+  EXPECT_EQ (static_cast<size_t>(thread_count * file_count), after.writes - before.writes);
+  EXPECT_LE (after.batches - before.batches, after.writes - before.writes);
+#ifndef HAVE_WINDOWS
+  EXPECT_EQ (after.syncs - before.syncs, (after.writes - before.writes) + (after.batches - before.batches));
+#endif
+  EXPECT_EQ (before.failures, after.failures);
+  EXPECT_EQ (static_cast<size_t>(thread_count * file_count), filter_url_scandir (folder).size ());
+
+  // Overwrite a file.
+  const std::string filename = filter_url_create_path ({folder, "0_0"});
+  EXPECT_TRUE (filter_url_file_put_contents_durable (filename, "new"));
+  EXPECT_EQ ("new", filter_url_file_get_contents (filename));
+
+  // The first durable write into a folder removes the temporary files a crash left there.
+  {
+    const std::string stale_folder = filter_url_create_path ({folder, "stale"});
+    filter_url_mkdir (stale_folder);
+    filter_url_file_put_contents (filter_url_create_path ({stale_folder, "1.durable99"}), "stale");
+    filter_url_file_put_contents (filter_url_create_path ({stale_folder, "1.durable12_3"}), "stale");
+    filter_url_file_put_contents (filter_url_create_path ({stale_folder, "2.durable"}), "keep");
+    EXPECT_TRUE (filter_url_file_put_contents_durable (filter_url_create_path ({stale_folder, "1"}), "1"));
+    EXPECT_EQ ((std::vector <std::string>{"1", "2.durable"}), filter_url_scandir (stale_folder));
+  }
+
+  // A write into a folder that does not exist fails.
+  EXPECT_FALSE (filter_url_file_put_contents_durable (filter_url_create_path ({folder, "missing", "file"}), "x"));
+  EXPECT_EQ (before.failures + 1, filter_url_durable_metrics ().failures);
+
+  filter_url_rmdir (folder);
+}
+
+
 #endif
@@ -1036,6 +1036,100 @@ TEST (usfm, get_markers_and_text)
 }
 
 
+// The earlier implementation of getting markers and text, which copied the remaining code per token.
+static std::vector <std::string> get_markers_and_text_reference (std::string code)
+{
+  std::vector <std::string> markers_and_text;
+  code = filter::string::replace ("\n\\", "\\", code);
+  code = filter::string::replace ("\n", " ", code);
+  code = filter::string::trim (code);
+  while (!code.empty ()) {
+    size_t pos = code.find ("\\");
+    if (pos == 0) {
+      std::vector <size_t> positions;
+      pos = code.find (" ");
+      if (pos != std::string::npos)
+        positions.push_back (pos + 1);
+      pos = code.find ("*");
+      if (pos != std::string::npos)
+        positions.push_back (pos + 1);
+      pos = code.find (R"(\)", 1);
+      if (pos != std::string::npos)
+        positions.push_back (pos);
+      positions.push_back (code.length());
+      sort (positions.begin (), positions.end());
+      pos = positions.at(0);
+      markers_and_text.push_back (code.substr (0, pos));
+      code = code.substr (pos);
+    } else {
+      pos = code.find (R"(\)");
+      if (pos == std::string::npos)
+        pos = code.length();
+      markers_and_text.push_back (code.substr (0, pos));
+      code = code.substr (pos);
+    }
+  }
+  return markers_and_text;
+}
+
+
+// Test that the single-pass tokenizer gives the same markers and text as the earlier implementation.
+TEST (usfm, get_markers_and_text_differential)
+{
+  const std::vector <std::string> fragments {
+    "", " ", "\n", "\n\n", "\\", "\\\\", "\\ ", "\\*", " \\id GEN \n", "text", "\t\\p\r",
+    "\\v 1\n\n\\v 2", "\\add*\\add*", "\\f + \\fr 1.1 \\ft Note\\f*", "a\nb\r\n\\c 1\r\n",
+    "\\w gracious|lemma=\"grace\"\\w*", "\\zmark\\*", "\\v 1 \\v 2\n \\p\n\n"
+  };
+  for (const auto& fragment : fragments) {
+    EXPECT_EQ (get_markers_and_text_reference (fragment), filter::usfm::get_markers_and_text (fragment)) << fragment;
+  }
+  const std::string directory = filter_url_create_root_path ({"unittests", "tests"});
+  int count {0};
+  for (const auto& file : filter_url_scandir (directory)) {
+    const std::string extension = filter::string::unicode_string_casefold (filter_url_get_extension (file));
+    if ((extension != "usfm") && (extension != "sfm"))
+      continue;
+    const std::string usfm = filter_url_file_get_contents (filter_url_create_path ({directory, file}));
+    EXPECT_EQ (get_markers_and_text_reference (usfm), filter::usfm::get_markers_and_text (usfm)) << file;
+    // Also with Windows line endings.
+    const std::string crlf = filter::string::replace ("\n", "\r\n", usfm);
+    EXPECT_EQ (get_markers_and_text_reference (crlf), filter::usfm::get_markers_and_text (crlf)) << file;
+    count++;
+  }
+  EXPECT_GT (count, 50);
+}
+
+
+// Test that the verse index of a chapter gives the same verse text as parsing the chapter per verse.
+TEST (usfm, chapter_verses)
+{
+  const std::vector <std::string> fragments {
+    "", "\n", "\n\n", "text", "\\c 1\n\\p\n", "\\v 1 One\n\\v 2 Two\n",
+    "\\c 1\n\\s Heading\n\\p\n\\v 1 One\n\\p Continued\n\\v 2-4 Range\n\\v 5,6 Sequence\n\\q\n\\v 1 Again\n",
+    "\\v 3 Three \\v 4 Four\n\\p\n\n\\v 5 Five", "\\v 1 One\\va 2\\va*\n\\vp 1b\\vp*"
+  };
+  std::vector <std::string> chapters (fragments);
+  const std::string directory = filter_url_create_root_path ({"unittests", "tests"});
+  for (const auto& file : filter_url_scandir (directory)) {
+    const std::string extension = filter::string::unicode_string_casefold (filter_url_get_extension (file));
+    if ((extension != "usfm") && (extension != "sfm"))
+      continue;
+    const std::string usfm = filter_url_file_get_contents (filter_url_create_path ({directory, file}));
+    for (const auto chapter : filter::usfm::get_chapter_numbers (usfm))
+      chapters.push_back (filter::usfm::get_chapter_text (usfm, chapter));
+  }
+  for (const auto& usfm : chapters) {
+    const filter::usfm::ChapterVerses chapter_verses (usfm);
+    std::vector <int> verses = filter::usfm::get_verse_numbers (usfm);
+    verses.push_back (1000);
+    for (const auto verse : verses) {
+      EXPECT_EQ (filter::usfm::get_verse_text (usfm, verse), chapter_verses.get_verse_text (verse)) << usfm;
+    }
+  }
+}
+
+
 // Test getting the markers from a fragment of USFM.
 TEST (usfm, get_marker)
 {
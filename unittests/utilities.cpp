@@ -18,9 +18,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 
 #include <unittests/utilities.h>
+#include <database/bibles.h>
+#include <database/ipc.h>
+#include <database/login.h>
+#include <database/styles.h>
 #include <filter/string.h>
 #include <filter/url.h>
 #include <filter/shell.h>
+#include <resource/logic.h>
 #include <webserver/request.h>
 
 
@@ -67,6 +72,11 @@ void refresh_sandbox (bool displayjournal, std::vector <std::string> allowed)
   // Clear caches in memory.
   Webserver_Request request;
   request.database_config_user()->clear_cache ();
+  database::login::clear_cache ();
+  database::styles::clear_snapshots ();
+  database_ipc::clear ();
+  database::bibles::clear_index ();
+  resource_logic_web_cache_clear ();
 }
 
 
@@ -85,3 +95,191 @@ int odf2txt (std::string odf, std::string txt)
   const std::string command = "python " + script_path + " " + std::move(odf) + " > " + std::move(txt) + " 2>&1";
   return system (command.c_str());
 }
+
+
+http_stand_in::http_stand_in (std::chrono::milliseconds delay) :
+m_delay (delay)
+{
+  m_listen_fd = socket (AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  address.sin_port = 0;
+  bind (m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof (address));
+  socklen_t length = sizeof (address);
+  getsockname (m_listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+  m_port = ntohs (address.sin_port);
+  listen (m_listen_fd, 16);
+  m_thread = std::thread (&http_stand_in::serve, this);
+}
+
+
+http_stand_in::~http_stand_in ()
+{
+  shutdown (m_listen_fd, SHUT_RDWR);
+  close (m_listen_fd);
+  m_thread.join ();
+  // The client keeps its connections open, so close them from this side.
+  for (const int fd : m_connection_fds)
+    shutdown (fd, SHUT_RDWR);
+  for (auto& thread : m_connection_threads)
+    thread.join ();
+  for (const int fd : m_connection_fds)
+    close (fd);
+}
+
+
+std::string http_stand_in::url () const
+{
+  return "http://127.0.0.1:" + std::to_string (m_port);
+}
+
+
+void http_stand_in::serve ()
+{
+  while (true) {
+    const int fd = accept (m_listen_fd, nullptr, nullptr);
+    if (fd < 0)
+      return;
+    connections++;
+    m_connection_fds.push_back (fd);
+    m_connection_threads.emplace_back (&http_stand_in::converse, this, fd);
+  }
+}
+
+
+void http_stand_in::converse (const int fd)
+{
+  std::string buffer {};
+  const auto receive = [fd, &buffer] () {
+    char data [1024];
+    const ssize_t count = recv (fd, data, sizeof (data), 0);
+    if (count <= 0)
+      return false;
+    buffer.append (data, static_cast<size_t>(count));
+    return true;
+  };
+  while (true) {
+    size_t end {};
+    while ((end = buffer.find ("\r\n\r\n")) == std::string::npos)
+      if (!receive ())
+        return;
+    const std::string header = buffer.substr (0, end);
+    buffer.erase (0, end + 4);
+    size_t content_length {0};
+    constexpr std::string_view content_length_is {"Content-Length: "};
+    if (const size_t pos = header.find (content_length_is); pos != std::string::npos)
+      content_length = std::stoul (header.substr (pos + content_length_is.size ()));
+    while (buffer.size () < content_length)
+      if (!receive ())
+        return;
+    const std::string body = header.substr (0, header.find ("\r\n")) + buffer.substr (0, content_length);
+    buffer.erase (0, content_length);
+    requests++;
+    std::this_thread::sleep_for (m_delay);
+    const bool missing {header.find (" /missing ") != std::string::npos};
+    const std::string response = std::string (missing ? "HTTP/1.1 404 Not Found" : "HTTP/1.1 200 OK") + "\r\n"
+    "Content-Length: " + std::to_string (body.size ()) + "\r\n"
+    "\r\n" + body;
+    send (fd, response.data (), response.size (), 0);
+  }
+}
+
+
+smtp_stand_in::smtp_stand_in ()
+{
+  m_listen_fd = socket (AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  address.sin_port = 0;
+  bind (m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof (address));
+  socklen_t length = sizeof (address);
+  getsockname (m_listen_fd, reinterpret_cast<sockaddr*>(&address), &length);
+  m_port = ntohs (address.sin_port);
+  listen (m_listen_fd, 5);
+  m_thread = std::thread (&smtp_stand_in::serve, this);
+}
+
+
+smtp_stand_in::~smtp_stand_in ()
+{
+  shutdown (m_listen_fd, SHUT_RDWR);
+  close (m_listen_fd);
+  m_thread.join ();
+}
+
+
+int smtp_stand_in::port () const
+{
+  return m_port;
+}
+
+
+// Returns the emails received so far.
+std::vector <std::string> smtp_stand_in::messages ()
+{
+  std::lock_guard lock (m_messages_mutex);
+  return m_messages;
+}
+
+
+void smtp_stand_in::serve ()
+{
+  while (true) {
+    const int fd = accept (m_listen_fd, nullptr, nullptr);
+    if (fd < 0)
+      return;
+    connections++;
+    converse (fd);
+    close (fd);
+  }
+}
+
+
+void smtp_stand_in::converse (const int fd)
+{
+  const auto reply = [fd] (const std::string& line) {
+    send (fd, line.data (), line.size (), 0);
+  };
+  std::string buffer {};
+  const auto read_line = [fd, &buffer] (std::string& line) {
+    size_t pos {};
+    while ((pos = buffer.find ("\r\n")) == std::string::npos) {
+      char data [1024];
+      const ssize_t count = recv (fd, data, sizeof (data), 0);
+      if (count <= 0)
+        return false;
+      buffer.append (data, static_cast<size_t>(count));
+    }
+    line = buffer.substr (0, pos);
+    buffer.erase (0, pos + 2);
+    return true;
+  };
+  reply ("220 localhost ESMTP\r\n");
+  std::string line {};
+  while (read_line (line)) {
+    const std::string command = line.substr (0, 4);
+    if (command == "EHLO")
+      reply ("250-localhost\r\n250 8BITMIME\r\n");
+    else if (command == "DATA") {
+      reply ("354 Go ahead\r\n");
+      std::string message {};
+      while (read_line (line) && (line != "."))
+        message.append (line + "\n");
+      {
+        std::lock_guard lock (m_messages_mutex);
+        m_messages.push_back (message);
+      }
+      if (hang_up_after_data)
+        return;
+      reply ("250 Queued\r\n");
+    }
+    else if (command == "QUIT") {
+      reply ("221 Bye\r\n");
+      return;
+    }
+    else
+      reply ("250 OK\r\n");
+  }
+}
@@ -24,3 +24,53 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 extern std::string testing_directory;
 void refresh_sandbox (bool displayjournal, std::vector <std::string> allowed = {});
 int odf2txt (std::string odf, std::string txt);
+
+
+// A minimal stand-in for an HTTP/1.1 server on the local host.
+// It answers each request with its request line and body, after an optional delay.
+// It counts the connections and the requests made to it.
+class http_stand_in final
+{
+public:
+  http_stand_in (std::chrono::milliseconds delay = std::chrono::milliseconds (0));
+  ~http_stand_in ();
+  http_stand_in (const http_stand_in&) = delete;
+  http_stand_in& operator= (const http_stand_in&) = delete;
+  std::string url () const;
+  std::atomic <int> connections {0};
+  std::atomic <int> requests {0};
+private:
+  std::chrono::milliseconds m_delay {};
+  int m_listen_fd {-1};
+  int m_port {0};
+  std::thread m_thread {};
+  std::vector <int> m_connection_fds {};
+  std::vector <std::thread> m_connection_threads {};
+  void serve ();
+  void converse (const int fd);
+};
+
+
+// A minimal stand-in for an SMTP server on the local host.
+// It accepts the emails it is given, and counts the connections made to it.
+class smtp_stand_in final
+{
+public:
+  smtp_stand_in ();
+  ~smtp_stand_in ();
+  smtp_stand_in (const smtp_stand_in&) = delete;
+  smtp_stand_in& operator= (const smtp_stand_in&) = delete;
+  int port () const;
+  std::vector <std::string> messages ();
+  std::atomic <int> connections {0};
+  // Whether to hang up after receiving an email, without confirming it.
+  std::atomic <bool> hang_up_after_data {false};
+private:
+  int m_listen_fd {-1};
+  int m_port {0};
+  std::thread m_thread {};
+  std::mutex m_messages_mutex {};
+  std::vector <std::string> m_messages {};
+  void serve ();
+  void converse (const int fd);
+};
@@ -25,13 +25,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 #include <database/logs.h>
 
 
-static void http_parse_post_multipart (std::string content, Webserver_Request& webserver_request);
-static void http_parse_post_standard (std::string content, Webserver_Request& webserver_request);
+static void http_parse_post_standard (const std::string& content, Webserver_Request& webserver_request);
 static std::vector<std::pair<std::string,std::string>> parse_application_x_www_form_urlencoded(const std::string& post);
+static void parse_key_value_pairs(std::string_view data, const auto& store);
 static std::vector<std::pair<std::string,std::string>> parse_text_plain(const std::string& post);
-static void parse_multipart_form_data(std::string post, std::vector<std::pair<std::string,std::string>>& result);
-static void remove_cr_lf_at_start(std::string& post);
-static void remove_cr_lf_at_end(std::string& post);
+static size_t skip_cr_lf_at_start(std::string_view post, size_t position);
+static size_t count_cr_lf_at_end(std::string_view post);
 
 
 // The http headers from a browser could look as follows:
@@ -84,16 +83,9 @@ bool http_parse_header (std::string header, Webserver_Request& webserver_request
         if (const size_t pos = query_data.find("#"); pos != std::string::npos) {
           query_data.erase(pos);
         }
-        std::vector<std::string> keys_values = filter::string::explode(std::move(query_data), '&');
-        for (const auto& fragment : keys_values) {
-          std::vector<std::string> key_value = filter::string::explode(fragment, '=');
-          // Handle situation that only the key is given.
-          if (key_value.size() == 1)
-            webserver_request.query[key_value.at(0)] = std::string();
-          // Handle normal situation: Both key and value are given.
-          if (key_value.size() == 2)
-            webserver_request.query[key_value.at(0)] = filter_url_urldecode(key_value.at(1));
-        }
+        parse_key_value_pairs(query_data, [&webserver_request](const std::string_view key, const std::string_view value) {
+          webserver_request.query.insert_or_assign(std::string(key), filter_url_urldecode(std::string(value)));
+        });
       }
     } catch (...) {
     }
@@ -161,7 +153,7 @@ bool http_parse_header (std::string header, Webserver_Request& webserver_request
 
 
 // Takes data POSTed from the browser, and parses it.
-void http_parse_post (std::string content, Webserver_Request& webserver_request)
+void http_parse_post (const std::string& content, Webserver_Request& webserver_request)
 {
   // If there's no content, there's nothing to parse: Done.
   if (content.empty ())
@@ -170,9 +162,11 @@ void http_parse_post (std::string content, Webserver_Request& webserver_request)
   // Parse multipart data in a special way, and other data in the standard way.
   const bool multipart = webserver_request.content_type.find ("multipart") != std::string::npos;
   if (multipart) {
-    http_parse_post_multipart (std::move(content), webserver_request);
+    Http_Post_Reader reader (webserver_request);
+    reader.feed (content.data (), content.size ());
+    reader.finish ();
   } else {
-    http_parse_post_standard (std::move(content), webserver_request);
+    http_parse_post_standard (content, webserver_request);
   }
 }
 
@@ -368,42 +362,8 @@ std::string http_parse_host (const std::string& line)
 }
 
 
-// Parser for POSTed multipart data. It splits the multiple parts up, and then runs the standard parser.
-static void http_parse_post_multipart (std::string content, Webserver_Request& webserver_request)
-{
-  // Get the boundary string from the content type.
-  // Example content type:
-  // multipart/form-data; boundary=----WebKitFormBoundarye9wsWKTf5zcLAGUn
-  // The boundary, as used in the posted body, starts with two extra hyphens.
-  const std::string content_type {webserver_request.content_type};
-  constexpr std::string_view boundary_is {"boundary="};
-  size_t pos = content_type.find(boundary_is);
-  if (pos == std::string::npos)
-    return;
-  const std::string boundary = "--" + content_type.substr(pos + boundary_is.size());
-  // Iterate over the posted body while it's longer than the boundary.
-  while (content.size() > boundary.size()) {
-    // The first boundary is expected to be located at position 0.
-    // If it's not there, stop parsing right away.
-    pos = content.find(boundary);
-    if (pos)
-      return;
-    // Remove the first boundary plus any following carriage return or line feed after that boundary.
-    content.erase(0, boundary.size());
-    remove_cr_lf_at_start(content);
-    // Find the boundary following the posted data fragment.
-    pos = content.find(boundary);
-    if (pos == std::string::npos)
-      return;
-    // Parse this chunk of data and then remove it.
-    http_parse_post_standard (content.substr(0, pos), webserver_request);
-    content.erase(0, pos);
-  }
-}
-
-
 // Takes data POSTed from the browser, and parses it.
-static void http_parse_post_standard (std::string content, Webserver_Request& webserver_request)
+static void http_parse_post_standard (const std::string& content, Webserver_Request& webserver_request)
 {
   // Read and parse the POST data.
   try {
@@ -415,10 +375,6 @@ static void http_parse_post_standard (std::string content, Webserver_Request& we
       webserver_request.post = parse_text_plain(content);
       return;
     }
-    if (webserver_request.content_type.find(multipart_form_data) != std::string::npos) {
-      parse_multipart_form_data(content, webserver_request.post);
-      return;
-    }
     throw std::runtime_error("Cannot parse content type " + webserver_request.content_type);
   }
   catch (const std::exception& exception) {
@@ -432,20 +388,10 @@ static std::vector<std::pair<std::string,std::string>> parse_application_x_www_f
   // Example input data: key1=value1&key2=value2
   
   std::vector<std::pair<std::string,std::string>> result;
-  
-  // First explode the data on the ampersand ( & ).
-  const std::vector<std::string> keys_values = filter::string::explode(post, '&');
-
-  // Next explode each fragment on the equal sign ( = ).
-  for (const auto& fragment : keys_values) {
-    const std::vector<std::string> key_value = filter::string::explode(fragment, '=');
-    // Handle situation that only the key is given.
-    if (key_value.size() == 1)
-      result.emplace_back(key_value.at(0), std::string());
-    // Handle normal situation: Both key and value are given.
-    if (key_value.size() == 2)
-      result.emplace_back(key_value.at(0), filter_url_urldecode(key_value.at(1)));
-  }
+  result.reserve(static_cast<size_t>(std::ranges::count(post, '&')) + 1);
+  parse_key_value_pairs(post, [&result](const std::string_view key, const std::string_view value) {
+    result.emplace_back(std::string(key), filter_url_urldecode(std::string(value)));
+  });
 
   return result;
 }
@@ -481,97 +427,304 @@ static std::vector<std::pair<std::string,std::string>> parse_text_plain(const st
 }
 
 
-void parse_multipart_form_data(std::string post, std::vector<std::pair<std::string,std::string>>& result)
+// Splits data like key1=value1&key2=value2 into its keys and values, without copying it,
+// and hands each key and its still encoded value to the store.
+// The results are the same as when exploding the data on the ampersand and next on the equal sign:
+// A fragment with only a key gets an empty value, and a fragment with more equal signs is skipped.
+static void parse_key_value_pairs(std::string_view data, const auto& store)
 {
-  //const bool urlencoded = content_type.find ("urlencoded") != std::string::npos;
+  while (!data.empty()) {
+    const size_t ampersand = data.find('&');
+    const std::string_view fragment = data.substr(0, ampersand);
+    data = (ampersand == std::string_view::npos) ? std::string_view() : data.substr(ampersand + 1);
+    const size_t equal_sign = fragment.find('=');
+    if (equal_sign == std::string_view::npos) {
+      if (!fragment.empty())
+        store(fragment, std::string_view());
+      continue;
+    }
+    std::string_view value = fragment.substr(equal_sign + 1);
+    if (const size_t pos = value.find('='); pos != std::string_view::npos) {
+      // An equal sign at the very end gets dropped, as exploding the data does.
+      if (pos + 1 != value.size())
+        continue;
+      value.remove_suffix(1);
+    }
+    store(fragment.substr(0, equal_sign), value);
+  }
+}
+
+
+// Returns the position after at most two carriage returns or line feeds at the position in the POSTed data.
+static size_t skip_cr_lf_at_start(std::string_view post, size_t position)
+{
+  for (int i{0}; i < 2; i++) {
+    if (position >= post.size())
+      break;
+    if ((post[position] == '\r') || (post[position] == '\n'))
+      position++;
+  }
+  return position;
+}
+
+
+// Returns the number of carriage returns or line feeds, at most two, that the POSTed data ends with.
+static size_t count_cr_lf_at_end(std::string_view post)
+{
+  size_t count {0};
+  for (int i{0}; i < 2; i++) {
+    if (count >= post.size())
+      break;
+    if (const char c = post[post.size() - count - 1]; (c == '\r') || (c == '\n'))
+      count++;
+  }
+  return count;
+}
 
+
+// The headers of a part of multipart data are expected within this many bytes.
+constexpr size_t multipart_header_window {65'536};
+
+
+Http_Post_Reader::Http_Post_Reader (Webserver_Request& webserver_request) :
+m_webserver_request (webserver_request)
+{
+  const std::string& content_type {webserver_request.content_type};
+  m_multipart = content_type.find ("multipart") != std::string::npos;
+  if (!m_multipart) {
+    // The Content-Length comes from the network, so limit what gets reserved.
+    constexpr int maximum_reserve {10'000'000};
+    if (webserver_request.content_length > 0)
+      m_buffer.reserve (static_cast<size_t>(std::min (webserver_request.content_length, maximum_reserve)));
+    return;
+  }
+  if (content_type.find (multipart_form_data) == std::string::npos) {
+    database::logs::log ("POST parsing error: Cannot parse content type " + content_type);
+    m_state = State::done;
+    return;
+  }
+  // Get the boundary string from the content type.
+  // Example content type:
+  // multipart/form-data; boundary=----WebKitFormBoundarye9wsWKTf5zcLAGUn
+  // The boundary, as used in the posted body, starts with two extra hyphens.
+  constexpr std::string_view boundary_is {"boundary="};
+  const size_t pos = content_type.find (boundary_is);
+  if (pos == std::string::npos) {
+    m_state = State::done;
+    return;
+  }
+  m_boundary = "--" + content_type.substr (pos + boundary_is.size ());
+}
+
+
+Http_Post_Reader::~Http_Post_Reader ()
+{
+  // Remove the temporary file of a value that was not completely received.
+  if (!m_path.empty ()) {
+    m_file.close ();
+    filter_url_unlink (m_path);
+  }
+}
+
+
+// Takes the next chunk of POSTed data.
+void Http_Post_Reader::feed (const char* data, const size_t size)
+{
+  if (m_state == State::done)
+    return;
+  if (m_multipart) {
+    m_buffer.erase (0, m_position);
+    m_position = 0;
+  }
+  m_buffer.append (data, size);
+  if (m_multipart)
+    parse (false);
+}
+
+
+// To be called after all POSTed data has been fed.
+void Http_Post_Reader::finish ()
+{
+  if (m_multipart) {
+    parse (true);
+    return;
+  }
+  if (!m_buffer.empty ())
+    http_parse_post_standard (m_buffer, m_webserver_request);
+}
+
+
+// Parses the multipart data received so far.
+// Each part is preceded by the boundary and contains headers followed by the value.
+// Data that could be the start of a boundary is kept till more comes in.
+void Http_Post_Reader::parse (const bool complete)
+{
+  while (m_state != State::done) {
+    const std::string_view rest = std::string_view (m_buffer).substr (m_position);
+    switch (m_state) {
+      case State::boundary:
+      {
+        // The boundary is expected at the start.
+        // If it's not there, stop parsing right away.
+        if (rest.size () <= m_boundary.size ()) {
+          if (complete)
+            m_state = State::done;
+          return;
+        }
+        if (!rest.starts_with (m_boundary)) {
+          m_state = State::done;
+          return;
+        }
+        m_position += m_boundary.size ();
+        m_state = State::header;
+        break;
+      }
+      case State::header:
+      {
+        // Parse the headers once the whole part is in, or else once enough is in to contain them.
+        const size_t pos = rest.find (m_boundary);
+        if (pos == std::string::npos) {
+          if (complete)
+            m_state = State::done;
+          if (complete || (rest.size () < multipart_header_window))
+            return;
+        }
+        try {
+          const bool whole_part {pos != std::string::npos};
+          m_position += parse_part_header (whole_part ? rest.substr (0, pos) : rest, whole_part);
+          m_state = State::value;
+        }
+        catch (const std::exception& exception) {
+          database::logs::log ("POST parsing error: " + std::string (exception.what ()));
+          m_state = State::skip;
+        }
+        break;
+      }
+      case State::value:
+      case State::skip:
+      {
+        const size_t pos = rest.find (m_boundary);
+        if (pos == std::string::npos) {
+          // A part that does not end in a boundary is incomplete, and gets discarded.
+          if (complete) {
+            m_state = State::done;
+            return;
+          }
+          // Keep enough to hold the start of a boundary plus the line ending before it.
+          if (const size_t keep = m_boundary.size () + 1; rest.size () > keep) {
+            if (m_state == State::value)
+              append_value (rest.substr (0, rest.size () - keep));
+            m_position += rest.size () - keep;
+          }
+          return;
+        }
+        if (m_state == State::value) {
+          // The value ends with a carriage return and line feed. Remove those.
+          const std::string_view value = rest.substr (0, pos);
+          append_value (value.substr (0, value.size () - count_cr_lf_at_end (value)));
+          store_value ();
+        }
+        m_position += pos;
+        m_state = State::boundary;
+        break;
+      }
+      case State::done:
+      default:
+        return;
+    }
+  }
+}
+
+
+// Parses the headers of a part of multipart data, and returns the position of its value.
+// The part is either complete, or else it is long enough to contain the headers.
+size_t Http_Post_Reader::parse_part_header (const std::string_view part, const bool complete)
+{
   // The first line looks similar to this:
   // Content-Disposition: form-data; name="data"; filename="file.txt"
-  // Remove it from the input data.
-  std::string content_disposition_line;
-  {
-    constexpr const std::string_view content_disposition {"Content-Disposition:"};
-    if (post.find(content_disposition) != 0)
-      throw std::runtime_error (std::string(content_disposition) + " not found right at the start of the POSTed data");
-    const size_t pos = post.find_first_of("\r\n");
-    content_disposition_line = post.substr(0, pos);
-    post.erase(0, pos);
-    remove_cr_lf_at_start(post);
+  size_t position = skip_cr_lf_at_start (part, 0);
+  constexpr const std::string_view content_disposition {"Content-Disposition:"};
+  if (!part.substr (position).starts_with (content_disposition))
+    throw std::runtime_error (std::string(content_disposition) + " not found right at the start of the POSTed data");
+  size_t pos = part.find_first_of ("\r\n", position);
+  if (pos == std::string::npos) {
+    if (!complete)
+      throw std::runtime_error ("The headers of the POSTed data are too long");
+    pos = part.size ();
   }
+  const std::string content_disposition_line {part.substr (position, pos - position)};
+  position = skip_cr_lf_at_start (part, pos);
 
   // Special case: Extract the filename in case of a file upload.
   {
     constexpr const std::string_view filename_is {"filename="};
-    std::string line {content_disposition_line};
-    if (line.find (filename_is) != std::string::npos) {
-      const size_t pos = line.find (filename_is);
-      if (pos != std::string::npos) {
-        line = line.substr (pos + filename_is.size() + 1);
-        line = filter::string::trim (line);
+    if (const size_t pos1 = content_disposition_line.find (filename_is); pos1 != std::string::npos) {
+      std::string line = content_disposition_line.substr (pos1 + filename_is.size() + 1);
+      line = filter::string::trim (line);
+      if (!line.empty ())
         line.pop_back ();
-        result.emplace_back("filename", line);
-      }
+      m_webserver_request.post.emplace_back ("filename", line);
     }
   }
 
   // Standard case: Extract the name, that is the "key" of the posted data.
-  std::string name {content_disposition_line};
+  m_name = content_disposition_line;
   constexpr const std::string_view name_is {"name="};
-  if (const size_t pos1 = name.find (name_is); pos1 != std::string::npos) {
-    name.erase(0, pos1 + name_is.size());
-    if (const size_t pos2 = name.find(R"(")"); pos2 != std::string::npos) {
-      name.erase(0, pos2 + 1);
-      if (const size_t pos3 = name.find(R"(")"); pos3 != std::string::npos) {
-        name.erase(pos3);
+  if (const size_t pos1 = m_name.find (name_is); pos1 != std::string::npos) {
+    m_name.erase(0, pos1 + name_is.size());
+    if (const size_t pos2 = m_name.find(R"(")"); pos2 != std::string::npos) {
+      m_name.erase(0, pos2 + 1);
+      if (const size_t pos3 = m_name.find(R"(")"); pos3 != std::string::npos) {
+        m_name.erase(pos3);
       }
     }
   }
-  
-  // The next, now first, line looks similar to this:
+
+  // The next line looks similar to this:
   // Content-Type: text/plain
   // It may be there, it also may be omitted.
-  // Remove it from the input data if it's there.
-  std::string content_type_line;
-  {
-    constexpr const std::string_view content_type {"Content-Type:"};
-    if (post.find(content_type) == 0) {
-      if (const size_t pos1 = post.find_first_of("\r\n"); pos1 != std::string::npos) {
-        content_type_line = post.substr(0, pos1);
-        post.erase(0, pos1);
-        remove_cr_lf_at_start(post);
-      }
-    }
+  constexpr const std::string_view content_type {"Content-Type:"};
+  if (part.substr (position).starts_with (content_type)) {
+    pos = part.find_first_of ("\r\n", position);
+    if (pos != std::string::npos)
+      position = skip_cr_lf_at_start (part, pos);
+    else if (!complete)
+      throw std::runtime_error ("The headers of the POSTed data are too long");
   }
 
-  // Having removed the initial headers,
-  // now remove the cr and lf that is between those headers and the posted payload.
-  remove_cr_lf_at_start(post);
-
-  // The posted data ends with cr lf. Remove those two.
-  remove_cr_lf_at_end(post);
-
-  // Store the data.
-  result.emplace_back(name, post);
+  // Skip the carriage return and line feed between the headers and the posted value.
+  return skip_cr_lf_at_start (part, position);
 }
 
 
-static void remove_cr_lf_at_start(std::string& post)
+// Adds data to the value being received.
+// Once the value gets large, it goes to a temporary file.
+void Http_Post_Reader::append_value (const std::string_view data)
 {
-  for (int i{0}; i < 2; i++) {
-    if (post.empty())
-      continue;
-    if (post.find_first_of("\r\n") == 0)
-      post.erase(0, 1);
+  if (m_path.empty () && (m_value.size () + data.size () > config_globals_post_spill_threshold)) {
+    m_path = filter_url_tempfile ();
+    m_file.open (m_path, std::ios::binary | std::ios::trunc);
+    m_file.write (m_value.data (), static_cast<std::streamsize>(m_value.size ()));
+    std::string ().swap (m_value);
   }
+  if (m_path.empty ())
+    m_value.append (data);
+  else
+    m_file.write (data.data (), static_cast<std::streamsize>(data.size ()));
 }
 
 
-static void remove_cr_lf_at_end(std::string& post)
+// Stores the name and value of the part that was received.
+void Http_Post_Reader::store_value ()
 {
-  for (int i{0}; i < 2; i++) {
-    if (post.empty())
-      continue;
-    if (const size_t pos = post.find_last_of("\r\n"); pos == post.size()-1)
-      post.erase(pos, 1);
+  auto& post = m_webserver_request.post;
+  if (m_path.empty ()) {
+    post.emplace_back (m_name, std::move (m_value));
+  } else {
+    m_file.close ();
+    post.emplace_back (m_name, std::string ());
+    m_webserver_request.post_files [post.size () - 1] = m_path;
+    m_path.clear ();
   }
+  m_value.clear ();
 }
@@ -28,7 +28,43 @@ constexpr const char* text_plain {"text/plain"};
 constexpr const char* multipart_form_data {"multipart/form-data"};
 
 bool http_parse_header (std::string header, Webserver_Request& webserver_request);
-void http_parse_post (std::string content, Webserver_Request& webserver_request);
+void http_parse_post (const std::string& content, Webserver_Request& webserver_request);
 void http_assemble_response (Webserver_Request& webserver_request);
 void http_stream_file (Webserver_Request& webserver_request, bool enable_cache);
 std::string http_parse_host (const std::string & line);
+
+
+// Takes the body of a POST request in chunks as it comes in from the network, and parses it.
+// Multipart form data is parsed while it comes in, so the body as a whole is never held in memory.
+// The value of a part larger than config_globals_post_spill_threshold goes to a temporary file.
+class Http_Post_Reader final
+{
+public:
+  explicit Http_Post_Reader (Webserver_Request& webserver_request);
+  ~Http_Post_Reader ();
+  Http_Post_Reader (const Http_Post_Reader&) = delete;
+  Http_Post_Reader& operator= (const Http_Post_Reader&) = delete;
+  Http_Post_Reader (Http_Post_Reader&&) = delete;
+  Http_Post_Reader& operator= (Http_Post_Reader&&) = delete;
+  void feed (const char* data, size_t size);
+  void finish ();
+private:
+  enum class State { boundary, header, value, skip, done };
+  Webserver_Request& m_webserver_request;
+  bool m_multipart {false};
+  std::string m_boundary {};
+  // The received data not yet parsed starts at the position in the buffer.
+  std::string m_buffer {};
+  size_t m_position {0};
+  State m_state {State::boundary};
+  // The name and value of the part being received.
+  std::string m_name {};
+  std::string m_value {};
+  // The temporary file the value goes to once it gets large.
+  std::string m_path {};
+  std::ofstream m_file {};
+  void parse (bool complete);
+  size_t parse_part_header (std::string_view part, bool complete);
+  void append_value (std::string_view data);
+  void store_value ();
+};
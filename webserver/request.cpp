@@ -18,6 +18,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 
 #include <webserver/request.h>
+#include <filter/url.h>
 
 
 Webserver_Request::~Webserver_Request()
@@ -25,24 +26,74 @@ Webserver_Request::~Webserver_Request()
     delete session_logic_instance;
     delete database_config_user_instance;
     delete database_users_instance;
+    for (const auto& [index, path] : post_files)
+        filter_url_unlink(path);
 }
 
 
-int Webserver_Request::post_count(const std::string& key) const
+// Returns the value of the query key, or nothing if the key was not given.
+// Unlike the [] operator on the query, this does not insert the key.
+std::string_view Webserver_Request::query_get(const std::string_view key) const
+{
+    if (const auto iter = query.find(key); iter != query.cend())
+        return iter->second;
+    return {};
+}
+
+
+// The POSTed values are few, in the order as given, and keys may be repeated.
+// A linear search through them is as fast as any index.
+int Webserver_Request::post_count(const std::string_view key) const
 {
     return static_cast<int>(std::ranges::count(post, key, &std::pair<std::string,std::string>::first));
 }
 
 
-std::string Webserver_Request::post_get(const std::string& key) const
+std::string Webserver_Request::post_get(const std::string_view key) const
 {
-    for (const auto& [first, value] : post)
-        if (key == first)
-            return value;
+    for (size_t i = 0; i < post.size(); i++)
+    {
+        if (key != post[i].first)
+            continue;
+        if (const auto iter = post_files.find(i); iter != post_files.cend())
+            return filter_url_file_get_contents(iter->second);
+        return post[i].second;
+    }
     return {};
 }
 
 
+// Saves the value POSTed under the key to the file at the path.
+// Returns whether there was any data to save.
+bool Webserver_Request::post_save(const std::string_view key, const std::string& path)
+{
+    for (size_t i = 0; i < post.size(); i++)
+        if (key == post[i].first)
+            return post_save(i, path);
+    return false;
+}
+
+
+// Saves the value POSTed at the index to the file at the path.
+// A value stored in a temporary file is moved rather than copied through memory.
+// Returns whether there was any data to save.
+bool Webserver_Request::post_save(const size_t index, const std::string& path)
+{
+    if (index >= post.size())
+        return false;
+    if (const auto iter = post_files.find(index); iter != post_files.cend())
+    {
+        filter_url_rename(iter->second, path);
+        post_files.erase(iter);
+        return true;
+    }
+    if (post[index].second.empty())
+        return false;
+    filter_url_file_put_contents(path, post[index].second);
+    return true;
+}
+
+
 // Returns a pointer to a live Session_Logic object.
 Session_Logic* Webserver_Request::session_logic()
 {
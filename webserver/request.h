@@ -46,7 +46,9 @@ public:
     // Whether it is a POST request.
     bool is_post{false};
     // The query from the browser, e.g. foo=bar&baz=qux, neatly arranged into a map.
-    std::map<std::string, std::string> query{};
+    // The map compares transparently, so it can be searched without constructing a key string.
+    std::map<std::string, std::string, std::less<>> query{};
+    [[nodiscard]] std::string_view query_get(std::string_view key) const;
     // The browser's user agent, e.g. Mozilla/x.0 (X11; Linux) ...
     std::string user_agent{"Browser/1.0"};
     // The browser's or client's Accept-Language header.
@@ -59,9 +61,14 @@ public:
     int content_length{0};
     // The raw POSTed data from the browser.
     std::vector<std::pair<std::string, std::string>> post{};
+    // The values of POSTed parts too large to keep in memory are in temporary files.
+    // This maps the index in the "post" container to the path of the file.
+    std::map<size_t, std::string> post_files{};
     // Convenience functions on post.
-    [[nodiscard]] int post_count(const std::string& key) const;
-    [[nodiscard]] std::string post_get(const std::string& key) const;
+    [[nodiscard]] int post_count(std::string_view key) const;
+    [[nodiscard]] std::string post_get(std::string_view key) const;
+    bool post_save(std::string_view key, const std::string& path);
+    bool post_save(size_t index, const std::string& path);
     // Header as received from the browser.
     std::string if_none_match{};
     // Extra header to be sent back to the browser.
@@ -210,7 +210,8 @@ static void webserver_process_request (const int conn_fd, const std::string clie
                 // In the case of a POST request, more data follows: The POST request itself.
                 // The length of that data is indicated in the header's Content-Length line.
                 // Read that data, and parse it.
-                std::string post_data{};
+                // The data is parsed while it comes in.
+                Http_Post_Reader post_reader(request);
                 if (request.is_post)
                 {
                     bool done_reading{false};
@@ -218,10 +219,8 @@ static void webserver_process_request (const int conn_fd, const std::string clie
                     do
                     {
                         bytes_read = static_cast<int>(recv(conn_fd, buffer, buffer_size, 0));
-                        for (int i = 0; i < bytes_read; i++)
-                        {
-                            post_data += buffer[i];
-                        }
+                        if (bytes_read > 0)
+                            post_reader.feed(buffer, static_cast<size_t>(bytes_read));
                         // EOF indicates reading is ready.
                         // An error also indicates that reading is ready.
                         if (bytes_read <= 0) done_reading = true;
@@ -236,7 +235,7 @@ static void webserver_process_request (const int conn_fd, const std::string clie
 
                 if (connection_healthy)
                 {
-                    http_parse_post(post_data, request);
+                    post_reader.finish();
 
                     // Assemble response.
                     bootstrap_index(request);
@@ -704,32 +703,33 @@ static void secure_webserver_process_request(mbedtls_ssl_config* conf, mbedtls_n
                 // In the case of a POST request, more data follows:
                 // The POST request itself.
                 // The length of that data is indicated in the header's Content-Length line.
-                // Read that data.
-                std::string post_data{};
+                // Read that data in blocks, and parse it while it comes in.
+                Http_Post_Reader post_reader(request);
                 bool done_reading = false;
                 int total_bytes_read = 0;
                 while (connection_healthy && !done_reading)
                 {
-                    unsigned char buffer[1] = {};
-                    ret = mbedtls_ssl_read(&ssl, buffer, 1);
+                    constexpr int buffer_size{16384};
+                    unsigned char buffer[buffer_size] = {};
+                    const size_t bytes_to_read = static_cast<size_t>(std::clamp(request.content_length - total_bytes_read, 1, buffer_size));
+                    ret = mbedtls_ssl_read(&ssl, buffer, bytes_to_read);
                     if (ret == MBEDTLS_ERR_SSL_WANT_READ) continue;
                     if (ret == MBEDTLS_ERR_SSL_WANT_WRITE) continue;
                     if (ret == 0) done_reading = true; // 0: EOF
                     if (ret < 0) connection_healthy = false;
                     if (connection_healthy && !done_reading)
                     {
-                        char c = static_cast<char>(buffer[0]);
-                        post_data += c;
-                        total_bytes_read++;
+                        post_reader.feed(reinterpret_cast<const char*>(buffer), static_cast<size_t>(ret));
+                        total_bytes_read += ret;
                     }
                     // "Content-Length" bytes read: Done.
                     if (total_bytes_read >= request.content_length) done_reading = true;
                 }
                 if (total_bytes_read < request.content_length) connection_healthy = false;
-                // Parse the POSTed data.
+                // Finish parsing the POSTed data.
                 if (connection_healthy)
                 {
-                    http_parse_post(post_data, request);
+                    post_reader.finish();
                 }
             }
 
@@ -1112,6 +1112,7 @@ void start_thread_pool(const std::size_t num_threads)
         return;
     // Flag to run.
     run_pool = true;
+    config_globals_webserver_threads = num_threads;
     // Creating worker threads.
     for (size_t i = 0; i < num_threads; ++i) {
         thread_pool.emplace_back([] {
@@ -1166,6 +1167,7 @@ void stop_thread_pool()
     });
     // Clear them so they are no longer available on a possible subsequent shutdown.
     thread_pool.clear();
+    config_globals_webserver_threads = 0;
 }
 
 